@@ -0,0 +1,949 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <new>
+
+#include "mico/tokens.h"
+#include "mico/lexer.h"
+#include "mico/objects.h"
+#include "mico/parser.h"
+#include "mico/ast/cache.h"
+#include "mico/state.h"
+#include "mico/environment.h"
+#include "mico/charset/encoding.h"
+#include "mico/modules/vec.h"
+#include "mico/modules/matrix.h"
+#include "mico/modules/array.h"
+
+/// Component level microbenchmarks.
+/// Every case has a fixed ("pinned") number of iterations and is repeated
+/// `runs` times. The median run is reported, so the numbers are comparable
+/// between commits on the same machine.
+///
+///     mico_bench [-r runs] [-s scale] [filter]
+///
+
+namespace {
+
+    /// allocation counters for the "bytes per element" section
+    std::size_t g_alloc_bytes = 0;
+    std::size_t g_alloc_count = 0;
+
+    struct alloc_header {
+        std::size_t size;
+        std::size_t pad;
+    };
+
+    void *counted_alloc( std::size_t size )
+    {
+        void *ptr = std::malloc( size + sizeof(alloc_header) );
+        if( !ptr ) {
+            throw std::bad_alloc( );
+        }
+        auto hdr = static_cast<alloc_header *>(ptr);
+        hdr->size = size;
+        g_alloc_bytes += size;
+        g_alloc_count++;
+        return hdr + 1;
+    }
+
+    void counted_free( void *ptr )
+    {
+        if( ptr ) {
+            auto hdr = static_cast<alloc_header *>(ptr) - 1;
+            g_alloc_bytes -= hdr->size;
+            g_alloc_count--;
+            std::free( hdr );
+        }
+    }
+}
+
+void *operator new( std::size_t size )
+{
+    return counted_alloc( size );
+}
+
+void *operator new[ ]( std::size_t size )
+{
+    return counted_alloc( size );
+}
+
+void operator delete( void *ptr ) noexcept
+{
+    counted_free( ptr );
+}
+
+void operator delete[ ]( void *ptr ) noexcept
+{
+    counted_free( ptr );
+}
+
+void operator delete( void *ptr, std::size_t ) noexcept
+{
+    counted_free( ptr );
+}
+
+void operator delete[ ]( void *ptr, std::size_t ) noexcept
+{
+    counted_free( ptr );
+}
+
+using namespace mico;
+
+namespace bench {
+
+    using clock_type = std::chrono::steady_clock;
+
+    /// keeps the optimizer away from results
+    static volatile std::size_t sink = 0;
+
+    struct config {
+        std::size_t runs   = 7;
+        std::size_t scale  = 1;
+        std::string filter;
+    };
+
+    struct result {
+        double      median = 0; /// seconds per run
+        double      min    = 0;
+        std::size_t iters  = 0;
+    };
+
+    template <typename CallT>
+    result measure( const config &cfg, std::size_t iters, CallT call )
+    {
+        std::vector<double> times;
+        times.reserve( cfg.runs );
+
+        call( iters ); /// warmup
+        for( std::size_t i = 0; i < cfg.runs; ++i ) {
+            auto start = clock_type::now( );
+            call( iters );
+            auto stop = clock_type::now( );
+            std::chrono::duration<double> d = stop - start;
+            times.push_back( d.count( ) );
+        }
+        std::sort( times.begin( ), times.end( ) );
+
+        result res;
+        res.median = times[times.size( ) / 2];
+        res.min    = times.front( );
+        res.iters  = iters;
+        return res;
+    }
+
+    bool selected( const config &cfg, const std::string &name )
+    {
+        return cfg.filter.empty( )
+            || (name.find( cfg.filter ) != std::string::npos);
+    }
+
+    void report( const std::string &name, const result &res,
+                 double units_per_iter, const char *unit )
+    {
+        auto per_op = res.median / static_cast<double>(res.iters);
+        auto rate   = units_per_iter / per_op;
+        std::cout << std::left  << std::setw( 36 ) << name
+                  << std::right << std::setw( 10 ) << res.iters
+                  << std::setw( 14 ) << std::fixed << std::setprecision( 1 )
+                  << per_op * 1e9 << " ns/iter"
+                  << std::setw( 16 ) << std::setprecision( 2 )
+                  << rate << " " << unit
+                  << std::setw( 12 ) << std::setprecision( 1 )
+                  << (res.median - res.min) / res.median * 100.0 << "% spread"
+                  << "\n";
+    }
+
+    template <typename CallT>
+    void run( const config &cfg, const std::string &name,
+              std::size_t iters, double units_per_iter, const char *unit,
+              CallT call )
+    {
+        if( selected( cfg, name ) ) {
+            auto res = measure( cfg, iters * cfg.scale, call );
+            report( name, res, units_per_iter, unit );
+        }
+    }
+
+    std::string make_source( std::size_t min_size )
+    {
+        static const std::string chunk =
+            "let fib = fn( n ) {\n"
+            "    let impl = fn( a, b, c ) {\n"
+            "        if( c > 0 ) { impl( b, a + b, c - 1 ) } else { a }\n"
+            "    }\n"
+            "    impl( 0, 1, n )\n"
+            "}\n"
+            "// comment line with some text\n"
+            "var table = mut { \"x\": 0x1F, \"y\": 0b1010, 3: 0.5e-3 }\n"
+            "let arr = [1, 2, 3, 4, 5, \"string \\\"escaped\\\"\", 'c']\n"
+            "for k, v in arr { table[k] = v * 2 }\n"
+            "let s = r\"raw string\" + r\"more\"\n"
+            "let cond = if( len(arr) >= 5 && !false ) { arr[1..3] } "
+            "elif( true ) { 0 } else { -1 }\n";
+
+        std::string res;
+        res.reserve( min_size + chunk.size( ) );
+        while( res.size( ) < min_size ) {
+            res += chunk;
+        }
+        return res;
+    }
+
+    std::size_t count_nodes( ast::node *n )
+    {
+        std::size_t res = 1;
+        n->mutate( [&res]( ast::node *child ) {
+            if( child ) {
+                res += count_nodes( child );
+            }
+            return ast::node::uptr( );
+        } );
+        return res;
+    }
+
+    void bench_lexer( const config &cfg )
+    {
+        auto src = make_source( 1 << 20 );
+        double mb = static_cast<double>(src.size( )) / (1024.0 * 1024.0);
+        run( cfg, "lexer.make 1MiB", 2, mb, "MB/s",
+             [&src]( std::size_t n ) {
+                while( n-- ) {
+                    auto lex = lexer::make( src );
+                    sink += std::distance( lex.begin( ), lex.end( ) );
+                }
+            } );
+
+        auto small = make_source( 256 );
+        double smb = static_cast<double>(small.size( )) / (1024.0 * 1024.0);
+        run( cfg, "lexer.make small", 2000, smb, "MB/s",
+             [&small]( std::size_t n ) {
+                while( n-- ) {
+                    auto lex = lexer::make( small );
+                    sink += std::distance( lex.begin( ), lex.end( ) );
+                }
+            } );
+
+        /// what the repl does with every line
+        const std::string line = "let x = fn( a, b ) { a + b }( 1, 2 );\n";
+        run( cfg, "lexer.make line", 100000, 1, "lines/s",
+             [&line]( std::size_t n ) {
+                while( n-- ) {
+                    auto lex = lexer::make( line );
+                    sink += std::distance( lex.begin( ), lex.end( ) );
+                }
+            } );
+
+        std::string text;
+        while( text.size( ) < (1 << 20) ) {
+            text += "// generated: the comment is longer than the code itself\n"
+                    "let message_identifier = \"some rather long string "
+                    "literal with an \\\"escape\\\" inside\"\n";
+        }
+        double tmb = static_cast<double>(text.size( )) / (1024.0 * 1024.0);
+        run( cfg, "lexer.make text 1MiB", 2, tmb, "MB/s",
+             [&text]( std::size_t n ) {
+                while( n-- ) {
+                    auto lex = lexer::make( text );
+                    sink += std::distance( lex.begin( ), lex.end( ) );
+                }
+            } );
+
+        auto all = lexer::make( src );
+        auto tokens = static_cast<double>(std::distance( all.begin( ),
+                                                         all.end( ) ));
+        run( cfg, "lexer.stream 1MiB", 2, tokens, "tokens/s",
+             [&src]( std::size_t n ) {
+                while( n-- ) {
+                    lexer::stream<const char *> stm( src.data( ),
+                                                     src.data( ) + src.size( ) );
+                    lexer::token_info ti;
+                    while( stm.next( ti ) ) {
+                        sink += ti.ident.literal.size( );
+                    }
+                }
+            } );
+    }
+
+    void bench_parser( const config &cfg )
+    {
+        auto src = make_source( 256 * 1024 );
+        auto prog = parser::parse( src );
+        if( !prog.errors( ).empty( ) ) {
+            std::cerr << "parser bench: " << prog.errors( )[0] << "\n";
+            return;
+        }
+        auto nodes = static_cast<double>(count_nodes( &prog ));
+
+        run( cfg, "parser.parse 256KiB", 2, nodes, "nodes/s",
+             [&src]( std::size_t n ) {
+                while( n-- ) {
+                    auto p = parser::parse( src );
+                    sink += p.states( ).size( );
+                }
+            } );
+
+        /// function bodies are only brace matched
+        run( cfg, "parser.parse lazy 256KiB", 2, nodes, "nodes/s",
+             [&src]( std::size_t n ) {
+                while( n-- ) {
+                    auto p = parser::parse( src.data( ),
+                                            src.data( ) + src.size( ), true );
+                    sink += p.states( ).size( );
+                }
+            } );
+
+        const std::string line = "let x = fn( a, b ) { a + b }( 1, 2 );\n";
+        run( cfg, "parser.parse line", 100000, 1, "lines/s",
+             [&line]( std::size_t n ) {
+                while( n-- ) {
+                    auto p = parser::parse( line );
+                    sink += p.states( ).size( );
+                }
+            } );
+
+        auto parsed = parser::parse( line );
+        ast::cache::writer img;
+        img.put_list( parsed.states( ) );
+        run( cfg, "ast.cache read line", 100000, 1, "lines/s",
+             [&img]( std::size_t n ) {
+                auto &data = img.data( );
+                while( n-- ) {
+                    ast::node_list states;
+                    ast::cache::reader r( data.data( ),
+                                          data.data( ) + data.size( ) );
+                    r.get_list( states );
+                    sink += states.size( );
+                }
+            } );
+
+#if !defined(DISABLE_MACRO) || !DISABLE_MACRO
+        std::string calls =
+            "let inc = macro( x ) { x + 1 }\n"
+            "let sq  = macro( x ) { inc( x ) * inc( x ) }\n"
+            "let pick = macro( c, a, b ) { if( c ) { sq( a ) } "
+            "else { fn( v ) { v + b } } }\n";
+        for( int i = 0; i < 1000; ++i ) {
+            calls += "let v" + std::to_string( i % 10 ) + " = pick( x > "
+                   + std::to_string( i % 4 ) + ", y, z );\n";
+        }
+        auto unexpanded = parser::parse( calls );
+        macro::processor::eval_call no_eval = []( ast::node * ) {
+            return objects::null::make( );
+        };
+        run( cfg, "macro.process 1k calls", 20, 1000, "calls/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    ast::program p;
+                    for( auto &st: unexpanded.states( ) ) {
+                        p.states( ).emplace_back( st->clone( ) );
+                    }
+                    macro::processor::process( &p, p.errors( ), no_eval );
+                    sink += p.states( ).size( );
+                }
+            } );
+#endif
+    }
+
+    void bench_environment( const config &cfg )
+    {
+        static const std::size_t depths[ ] = { 1, 4, 16, 64 };
+        static const std::size_t names = 32;
+
+        state st;
+        std::vector<symbol> idents;
+        for( std::size_t i = 0; i < names; ++i ) {
+            idents.push_back( "variable_" + std::to_string( i ) );
+        }
+
+        for( auto depth: depths ) {
+            auto root = environment::make( st.env( ) );
+            for( auto &id: idents ) {
+                root->set( id, objects::integer::make( 1 ) );
+            }
+            std::vector<environment::sptr> chain { root };
+            for( std::size_t d = 1; d < depth; ++d ) {
+                chain.push_back( environment::make( chain.back( ) ) );
+            }
+            auto leaf = chain.back( );
+            auto suf = " depth " + std::to_string( depth );
+
+            run( cfg, "environment.get" + suf, 100000, 1.0, "ops/s",
+                 [&]( std::size_t n ) {
+                    for( std::size_t i = 0; i < n; ++i ) {
+                        auto v = leaf->get( idents[i % names] );
+                        sink += v ? 1 : 0;
+                    }
+                } );
+
+            auto val = objects::integer::make( 2 );
+            run( cfg, "environment.set" + suf, 100000, 1.0, "ops/s",
+                 [&]( std::size_t n ) {
+                    for( std::size_t i = 0; i < n; ++i ) {
+                        leaf->set( idents[i % names], val );
+                    }
+                } );
+        }
+    }
+
+    std::vector<objects::sptr> make_int_keys( std::size_t count,
+                                              std::size_t step = 7 )
+    {
+        std::vector<objects::sptr> res;
+        for( std::size_t i = 0; i < count; ++i ) {
+            res.push_back( objects::integer::make( i * step ) );
+        }
+        return res;
+    }
+
+    std::vector<objects::sptr> make_str_keys( std::size_t count,
+                                              std::size_t pad = 0 )
+    {
+        std::vector<objects::sptr> res;
+        for( std::size_t i = 0; i < count; ++i ) {
+            file_string k = std::string( pad, '_' ) + "key_"
+                          + std::to_string( i );
+            res.push_back( objects::string::make( k ) );
+        }
+        return res;
+    }
+
+    /// immutable arrays of 8 integers
+    std::vector<objects::sptr> make_arr_keys( environment::sptr env,
+                                              std::size_t count )
+    {
+        std::vector<objects::sptr> res;
+        for( std::size_t i = 0; i < count; ++i ) {
+            auto a = objects::array::make( env );
+            for( std::size_t j = 0; j < 8; ++j ) {
+                a->push( env.get( ), objects::integer::make( i * 8 + j ) );
+            }
+            res.push_back( a );
+        }
+        return res;
+    }
+
+    void bench_table( const config &cfg, const std::string &kind,
+                      const std::vector<objects::sptr> &keys )
+    {
+        state st;
+        auto env  = st.env( );
+        auto val  = objects::integer::make( 1 );
+        auto size = static_cast<double>(keys.size( ));
+
+        run( cfg, "table.insert " + kind, 20, size, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    auto t = objects::table::make( env );
+                    for( auto &k: keys ) {
+                        t->set( env.get( ), k, val );
+                    }
+                    sink += t->size( );
+                }
+            } );
+
+        auto t = objects::table::make( env );
+        for( auto &k: keys ) {
+            t->set( env.get( ), k, val );
+        }
+        run( cfg, "table.lookup " + kind, 20, size, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    for( auto &k: keys ) {
+                        sink += t->at( k ) ? 1 : 0;
+                    }
+                }
+            } );
+
+        /// `t = t + {k: v}` on an immutable table; shares the old entries
+        run( cfg, "table.merge " + kind, 20, size, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    objects::sptr m = objects::table::make( env );
+                    for( auto &k: keys ) {
+                        auto one = objects::table::make( env );
+                        one->set( env.get( ), k, val );
+                        m = objects::cast_table( m.get( ) )
+                               ->merge( env.get( ), one.get( ) );
+                    }
+                    sink += m->size( );
+                }
+            } );
+
+        auto tree = std::static_pointer_cast<objects::table>( t->clone( ) );
+        tree->tree( );
+        run( cfg, "table.lookup tree " + kind, 20, size, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    for( auto &k: keys ) {
+                        sink += tree->at( k ) ? 1 : 0;
+                    }
+                }
+            } );
+    }
+
+    void bench_containers( const config &cfg )
+    {
+        static const std::size_t count = 10000;
+
+        bench_table( cfg, "int",    make_int_keys( count ) );
+        bench_table( cfg, "dense int", make_int_keys( count, 1 ) );
+        bench_table( cfg, "string", make_str_keys( count ) );
+        bench_table( cfg, "long string", make_str_keys( count, 256 ) );
+
+        state st;
+        auto env = st.env( );
+        bench_table( cfg, "array", make_arr_keys( env, count ) );
+        auto val = objects::integer::make( 1 );
+
+        run( cfg, "array.push", 20, count, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    auto a = objects::array::make( env );
+                    for( std::size_t i = 0; i < count; ++i ) {
+                        a->push( env.get( ), val );
+                    }
+                    sink += a->size( );
+                }
+            } );
+
+        auto arr = objects::array::make( env );
+        for( std::size_t i = 0; i < count; ++i ) {
+            arr->push( env.get( ), objects::integer::make( i ) );
+        }
+        run( cfg, "array.index", 20, count, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    for( std::size_t i = 0; i < count; ++i ) {
+                        auto id = static_cast<std::int64_t>(i);
+                        sink += arr->at( id ) ? 1 : 0;
+                    }
+                }
+            } );
+
+        /// a clone shares the elements; the first write copies them
+        run( cfg, "array.clone", 200, 1, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += arr->clone( ) ? 1 : 0;
+                }
+            } );
+        arr->set_mutable( true );
+        run( cfg, "array.clone+write", 20, count, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    auto c = arr->clone( );
+                    sink += objects::cast_array( c.get( ) )->at( 0 ) ? 1 : 0;
+                }
+            } );
+        arr->set_mutable( false );
+
+        /// `a = a + [x]` on an immutable array; shares the old elements
+        run( cfg, "array.concat append", 20, count, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    objects::sptr a = objects::array::make( env );
+                    for( std::size_t i = 0; i < count; ++i ) {
+                        auto one = objects::array::make( env );
+                        one->push( env.get( ), val );
+                        a = objects::cast_array( a.get( ) )
+                               ->concat( one.get( ) );
+                    }
+                    sink += a->size( );
+                }
+            } );
+
+        /// every value is released right away and its block is reused
+        run( cfg, "integer.make", 20, count, "ops/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    for( std::size_t i = 0; i < count; ++i ) {
+                        sink += objects::integer::make( i )->value( ) & 1;
+                    }
+                }
+            } );
+    }
+
+    void bench_strings( const config &cfg )
+    {
+        /// the buffer is hashed as string::hash does it; the string
+        /// object keeps its hash, so it would be hashed only once
+        static const std::size_t lens[ ] = { 8, 64, 4096 };
+        for( auto len: lens ) {
+            mico::string val( len, U'ж' );
+            auto bytes = len * sizeof(mico::string::value_type);
+            auto chars = static_cast<double>(len);
+            run( cfg, "string.hash " + std::to_string( len ),
+                 200000 / len + 10, chars, "chars/s",
+                 [&]( std::size_t n ) {
+                    while( n-- ) {
+                        sink += objects::wyhash::get( val.data( ), bytes,
+                                                      n );
+                    }
+                } );
+        }
+
+        /// ASCII characters are shared objects; nothing is allocated
+        auto text = objects::string::make(
+                        mico::string( 4096, U'a' ) + mico::string( 4096, U'ж' ) );
+        run( cfg, "string.at_obj ascii", 100, 4096, "chars/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    for( std::int64_t i = 0; i < 4096; ++i ) {
+                        sink += text->at_obj( i ) ? 1 : 0;
+                    }
+                }
+            } );
+        run( cfg, "string.at_obj other", 100, 4096, "chars/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    for( std::int64_t i = 4096; i < 8192; ++i ) {
+                        sink += text->at_obj( i ) ? 1 : 0;
+                    }
+                }
+            } );
+
+        std::string utf8;
+        while( utf8.size( ) < (1 << 20) ) {
+            utf8 += "ascii text, кирилица, 中國, 🐒 ";
+        }
+        auto mb = static_cast<double>(utf8.size( )) / (1024.0 * 1024.0);
+        auto internal = charset::encoding::from_file( utf8 );
+
+        run( cfg, "encoding.from_file 1MiB", 4, mb, "MB/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += charset::encoding::from_file( utf8 ).size( );
+                }
+            } );
+        run( cfg, "encoding.to_file 1MiB", 4, mb, "MB/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += charset::encoding::to_file( internal ).size( );
+                }
+            } );
+    }
+
+    /// vec kernels against a loop over the element objects
+    void bench_vec( const config &cfg )
+    {
+        static const std::size_t count = 100000;
+        using vec = modules::vec;
+
+        state st;
+        auto env = st.env( );
+        auto ints   = objects::array::make( env );
+        auto floats = objects::array::make( env );
+        for( std::size_t i = 0; i < count; ++i ) {
+            ints->push( env.get( ), objects::integer::make( i ) );
+            floats->push( env.get( ), objects::floating::make( i * 0.5 ) );
+        }
+
+        run( cfg, "vec.sum loop int", 20, count, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    std::int64_t res = 0;
+                    ints->for_each( [&]( const objects::sptr &v ) {
+                        res += objects::cast_int( v.get( ) )->value( );
+                    } );
+                    sink += static_cast<std::size_t>(res);
+                }
+            } );
+
+        objects::slist one { ints };
+        run( cfg, "vec.sum int", 200, count, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += vec::sum { }( one, env ) ? 1 : 0;
+                }
+            } );
+
+        objects::slist two { floats, floats };
+        run( cfg, "vec.dot float", 200, count, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += vec::dot { }( two, env ) ? 1 : 0;
+                }
+            } );
+
+        objects::slist scaled { floats, objects::floating::make( 2.0 ) };
+        vec::arith<vec::K::mul_op> mul( "mul" );
+        run( cfg, "vec.mul float", 200, count, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += mul( scaled, env ) ? 1 : 0;
+                }
+            } );
+
+        objects::slist limit { ints, objects::integer::make( count / 2 ) };
+        vec::compare<vec::K::gt_op> gt( "gt" );
+        run( cfg, "vec.gt int", 200, count, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += gt( limit, env ) ? 1 : 0;
+                }
+            } );
+    }
+
+    void bench_sort( const config &cfg )
+    {
+        static const std::size_t count = 1000000;
+        using array = modules::array;
+
+        state st;
+        auto env = st.env( );
+        auto ints    = objects::array::make( env );
+        auto floats  = objects::array::make( env );
+        auto strings = objects::array::make( env );
+        std::uint64_t seed = 0x9E3779B97F4A7C15ull;
+        for( std::size_t i = 0; i < count; ++i ) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            auto val = static_cast<std::int64_t>(seed >> 16);
+            ints->push( env.get( ), objects::integer::make( val ) );
+            floats->push( env.get( ),
+                          objects::floating::make( val * 0.001 ) );
+            if( i < count / 10 ) {
+                auto str = std::to_string( val );
+                strings->push( env.get( ), objects::string::make(
+                            mico::string( str.begin( ), str.end( ) ) ) );
+            }
+        }
+
+        objects::slist pi { ints };
+        run( cfg, "array.sort int", 5, count, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += array::sort { }( pi, env ) ? 1 : 0;
+                }
+            } );
+
+        objects::slist pf { floats };
+        run( cfg, "array.sort float", 5, count, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += array::sort { }( pf, env ) ? 1 : 0;
+                }
+            } );
+
+        objects::slist ps { strings };
+        run( cfg, "array.sort string", 5, count / 10, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    sink += array::sort { }( ps, env ) ? 1 : 0;
+                }
+            } );
+    }
+
+    void bench_matrix( const config &cfg )
+    {
+        static const std::size_t side = 256;
+        using K = modules::vec_kernels;
+
+        auto a = objects::matrix::make( side, side );
+        auto b = objects::matrix::make( side, side );
+        auto c = objects::matrix::make( side, side );
+        auto pa = a->mutable_data( );
+        auto pb = b->mutable_data( );
+        for( std::size_t i = 0; i < side * side; ++i ) {
+            pa[i] = static_cast<double>(i % 17) * 0.5;
+            pb[i] = static_cast<double>(i % 13) - 6.0;
+        }
+        auto pc = c->mutable_data( );
+        const double madds = static_cast<double>(side * side * side);
+
+        run( cfg, "matrix.mul naive", 2, madds, "madd/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    for( std::size_t i = 0; i < side; ++i ) {
+                        for( std::size_t j = 0; j < side; ++j ) {
+                            double res = 0;
+                            for( std::size_t p = 0; p < side; ++p ) {
+                                res += pa[i * side + p] * pb[p * side + j];
+                            }
+                            pc[i * side + j] = res;
+                        }
+                    }
+                    sink += static_cast<std::size_t>(pc[side + 1]);
+                }
+            } );
+
+        run( cfg, "matrix.mul blocked", 10, madds, "madd/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    K::matmul( pa, pb, pc, side, side, side );
+                    sink += static_cast<std::size_t>(pc[side + 1]);
+                }
+            } );
+
+        run( cfg, "matrix.transpose", 200, side * side, "elems/s",
+             [&]( std::size_t n ) {
+                while( n-- ) {
+                    K::transpose( pa, pc, side, side );
+                    sink += static_cast<std::size_t>(pc[1]);
+                }
+            } );
+    }
+
+    template <typename CallT>
+    void footprint( const config &cfg, const std::string &name,
+                    std::size_t count, CallT call )
+    {
+        if( !selected( cfg, name ) ) {
+            return;
+        }
+        auto bytes  = g_alloc_bytes;
+        auto blocks = g_alloc_count;
+        auto holder = call( count );
+        auto used   = static_cast<double>(g_alloc_bytes - bytes);
+        auto allocs = static_cast<double>(g_alloc_count - blocks);
+        auto n      = static_cast<double>(count);
+        std::cout << std::left  << std::setw( 36 ) << name
+                  << std::right << std::setw( 10 ) << count
+                  << std::setw( 14 ) << std::fixed << std::setprecision( 1 )
+                  << used / n << " bytes/elem"
+                  << std::setw( 10 ) << std::setprecision( 2 )
+                  << allocs / n << " allocs/elem\n";
+        sink += holder ? 1 : 0;
+    }
+
+    void bench_footprint( const config &cfg )
+    {
+        static const std::size_t count = 100000;
+
+        state st;
+        auto env = st.env( );
+
+        footprint( cfg, "bytes array<int>", count,
+                   [&]( std::size_t n ) {
+                        auto a = objects::array::make( env );
+                        for( std::size_t i = 0; i < n; ++i ) {
+                            a->push( env.get( ), objects::integer::make( i ) );
+                        }
+                        return objects::sptr( a );
+                   } );
+
+        footprint( cfg, "bytes array<float>", count,
+                   [&]( std::size_t n ) {
+                        auto a = objects::array::make( env );
+                        for( std::size_t i = 0; i < n; ++i ) {
+                            a->push( env.get( ),
+                                     objects::floating::make( i * 0.5 ) );
+                        }
+                        return objects::sptr( a );
+                   } );
+
+        footprint( cfg, "bytes array<mixed>", count,
+                   [&]( std::size_t n ) {
+                        auto a = objects::array::make( env );
+                        for( std::size_t i = 0; i < n; ++i ) {
+                            objects::sptr val;
+                            if( i % 2 ) {
+                                val = objects::integer::make( i );
+                            } else {
+                                val = objects::floating::make( i );
+                            }
+                            a->push( env.get( ), val );
+                        }
+                        return objects::sptr( a );
+                   } );
+
+        footprint( cfg, "bytes table<int,int>", count,
+                   [&]( std::size_t n ) {
+                        auto t = objects::table::make( env );
+                        for( std::size_t i = 0; i < n; ++i ) {
+                            auto v = objects::integer::make( i );
+                            t->set( env.get( ), v, v );
+                        }
+                        return objects::sptr( t );
+                   } );
+
+        footprint( cfg, "bytes table<string,int>", count,
+                   [&]( std::size_t n ) {
+                        auto t = objects::table::make( env );
+                        for( std::size_t i = 0; i < n; ++i ) {
+                            file_string k = "key_" + std::to_string( i );
+                            t->set( env.get( ), objects::string::make( k ),
+                                    objects::integer::make( i ) );
+                        }
+                        return objects::sptr( t );
+                   } );
+
+        /// the keys are shared, as the literals of a script are not
+        std::vector<objects::sptr> fields {
+            objects::string::make( file_string( "x" ) ),
+            objects::string::make( file_string( "y" ) ),
+            objects::string::make( file_string( "z" ) ),
+        };
+        footprint( cfg, "bytes record{x,y,z}", count / 10,
+                   [&]( std::size_t n ) {
+                        auto res = objects::array::make( env );
+                        for( std::size_t i = 0; i < n; ++i ) {
+                            auto t = objects::table::make( env );
+                            for( auto &f: fields ) {
+                                t->set( env.get( ), f,
+                                        objects::integer::make( i ) );
+                            }
+                            res->push( env.get( ), t );
+                        }
+                        return objects::sptr( res );
+                   } );
+
+        footprint( cfg, "bytes string", count,
+                   [&]( std::size_t n ) {
+                        return objects::sptr(
+                              objects::string::make( mico::string( n, U'a' ) ) );
+                   } );
+
+        footprint( cfg, "bytes rstring", count,
+                   [&]( std::size_t n ) {
+                        return objects::sptr(
+                              objects::rstring::make( std::string( n, 'a' ) ) );
+                   } );
+    }
+
+    config parse_args( int argc, char *argv[ ] )
+    {
+        config res;
+        for( int i = 1; i < argc; ++i ) {
+            std::string arg = argv[i];
+            if( (arg == "-r") && (i + 1 < argc) ) {
+                res.runs = std::max( 1, std::atoi( argv[++i] ) );
+            } else if( (arg == "-s") && (i + 1 < argc) ) {
+                res.scale = std::max( 1, std::atoi( argv[++i] ) );
+            } else {
+                res.filter = arg;
+            }
+        }
+        return res;
+    }
+}
+
+int main( int argc, char *argv[ ] )
+{
+    try {
+        auto cfg = bench::parse_args( argc, argv );
+        std::cout << "runs: " << cfg.runs << " scale: " << cfg.scale
+                  << " (median of runs)\n";
+
+        bench::bench_lexer( cfg );
+        bench::bench_parser( cfg );
+        bench::bench_environment( cfg );
+        bench::bench_containers( cfg );
+        bench::bench_strings( cfg );
+        bench::bench_vec( cfg );
+        bench::bench_matrix( cfg );
+        bench::bench_sort( cfg );
+        bench::bench_footprint( cfg );
+
+    } catch ( const std::exception &ex ) {
+        std::cerr << "Something wrong: " << ex.what( ) << "\n";
+        return 10;
+    }
+    return 0;
+}
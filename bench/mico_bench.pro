@@ -0,0 +1,13 @@
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += mico_bench.cpp
+
+INCLUDEPATH += ../etool/include \
+               ../include
+
+DEFINES += CHECK_CASTS=1
+DEFINES += DISABLE_SWITCH_WARNINGS=1
+DEFINES += DISABLE_MACRO=0
@@ -307,6 +307,7 @@ namespace mico { namespace ast {
         program(            )       = default;
         program( program && )       = default;
         program( const program & )  = default;
+        program &operator = ( program && ) = default;
 
         const node_list &states( ) const
         {
@@ -0,0 +1,812 @@
+#ifndef MICO_AST_CACHE_H
+#define MICO_AST_CACHE_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <unordered_map>
+#include <stdexcept>
+
+#include "mico/ast.h"
+#include "mico/statements.h"
+#include "mico/expressions.h"
+#include "mico/symbols.h"
+#include "mico/parser.h"
+#include "mico/mapped_file.h"
+#include "mico/objects/hash.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace mico { namespace ast {
+
+    /// Binary image of a ready to run program (after macro expansion).
+    /// The file is keyed by the source hash, the source size and the
+    /// interpreter build (see `version`); any mismatch or damage makes `load` fail and
+    /// the caller just parses the source again.
+    struct cache {
+
+        using hash_type = std::uint64_t;
+
+        /// bump on every change of the layout below
+        static const unsigned format = 3;
+
+        /// The format and the build of the interpreter: a hash of its
+        /// own binary, so any change of the parser or of the macro
+        /// expansion makes old caches useless. A build can give its own
+        /// id with -DMICO_BUILD_ID="..." instead. Empty if there is no
+        /// way to know the build; then there is no cache at all
+        static
+        const std::string &version( )
+        {
+            static const std::string ver = make_version( );
+            return ver;
+        }
+
+        static
+        bool enabled( )
+        {
+            return !version( ).empty( );
+        }
+
+        /// FNV-1a
+        static
+        hash_type hash( const char *begin, const char *end )
+        {
+            hash_type res = 14695981039346656037ULL;
+            for( ; begin != end; ++begin ) {
+                res ^= static_cast<std::uint8_t>(*begin);
+                res *= 1099511628211ULL;
+            }
+            return res;
+        }
+
+        /// `script`c next to the script
+        static
+        std::string path_for( const std::string &script )
+        {
+            return script + "c";
+        }
+
+        class writer {
+
+        public:
+
+            writer( ) = default;
+
+            /// without positions the output is a key of the tree shape
+            explicit
+            writer( bool positions )
+                :positions_(positions)
+            { }
+
+            const std::string &data( ) const
+            {
+                return buf_;
+            }
+
+            void put_byte( std::uint8_t val )
+            {
+                buf_.push_back( static_cast<char>(val) );
+            }
+
+            void put_uint( std::uint64_t val )
+            {
+                while( val >= 0x80 ) {
+                    put_byte( static_cast<std::uint8_t>(val | 0x80) );
+                    val >>= 7;
+                }
+                put_byte( static_cast<std::uint8_t>(val) );
+            }
+
+            void put_int( std::int64_t val )
+            {
+                auto u = static_cast<std::uint64_t>(val);
+                put_uint( (u << 1) ^ (val < 0 ? ~std::uint64_t(0) : 0) );
+            }
+
+            void put_fixed( std::uint64_t val )
+            {
+                for( int i = 0; i < 8; ++i ) {
+                    put_byte( static_cast<std::uint8_t>(val >> (i * 8)) );
+                }
+            }
+
+            void put_string( const std::string &val )
+            {
+                put_uint( val.size( ) );
+                buf_.append( val );
+            }
+
+            /// every name is written once, later uses are its number
+            void put_name( const std::string &val )
+            {
+                auto f = names_.find( val );
+                if( f != names_.end( ) ) {
+                    put_uint( f->second + 1 );
+                    return;
+                }
+                put_uint( 0 );
+                put_string( val );
+                names_.emplace( val, names_.size( ) );
+            }
+
+            /// lines go as a difference with the previous node
+            void put_pos( const tokens::position &val )
+            {
+                if( !positions_ ) {
+                    return;
+                }
+                put_int( static_cast<std::int64_t>(val.line)
+                       - static_cast<std::int64_t>(last_.line) );
+                put_uint( val.pos );
+                last_ = val;
+            }
+
+            bool put_list( const node_list &val )
+            {
+                put_uint( val.size( ) );
+                for( auto &n: val ) {
+                    if( !put( n.get( ) ) ) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            /// a function body that is not parsed yet
+            void put_tokens( const expressions::lazy_body::token_list &val )
+            {
+                put_uint( val.size( ) );
+                for( auto &t: val ) {
+                    put_uint( static_cast<std::uint64_t>(t.ident.name) );
+                    if( t.ident.name == tokens::type::IDENT ) {
+                        put_name( t.ident.literal );
+                    } else {
+                        put_string( t.ident.literal );
+                    }
+                    put_pos( t.where );
+                }
+            }
+
+            /// false if the tree has a node that can not be stored
+            bool put( const node *n );
+
+        private:
+            std::string                                     buf_;
+            std::unordered_map<std::string, std::uint64_t>  names_;
+            tokens::position                                last_;
+            bool                                            positions_ = true;
+        };
+
+        class reader {
+
+        public:
+
+            reader( const char *begin, const char *end )
+                :cur_(begin)
+                ,end_(end)
+            { }
+
+            bool eof( ) const
+            {
+                return cur_ == end_;
+            }
+
+            const char *position( ) const
+            {
+                return cur_;
+            }
+
+            std::uint64_t left( ) const
+            {
+                return static_cast<std::uint64_t>(end_ - cur_);
+            }
+
+            std::uint8_t get_byte( )
+            {
+                if( cur_ == end_ ) {
+                    throw std::runtime_error( "ast cache: unexpected end" );
+                }
+                return static_cast<std::uint8_t>(*cur_++);
+            }
+
+            std::uint64_t get_uint( )
+            {
+                std::uint64_t res = 0;
+                for( unsigned shift = 0; shift < 64; shift += 7 ) {
+                    auto b = get_byte( );
+                    res |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+                    if( !(b & 0x80) ) {
+                        return res;
+                    }
+                }
+                throw std::runtime_error( "ast cache: bad number" );
+            }
+
+            std::int64_t get_int( )
+            {
+                auto u = get_uint( );
+                return static_cast<std::int64_t>((u >> 1) ^ (~(u & 1) + 1));
+            }
+
+            std::uint64_t get_fixed( )
+            {
+                std::uint64_t res = 0;
+                for( int i = 0; i < 8; ++i ) {
+                    res |= static_cast<std::uint64_t>(get_byte( )) << (i * 8);
+                }
+                return res;
+            }
+
+            std::string get_string( )
+            {
+                auto len = get_uint( );
+                if( len > left( ) ) {
+                    throw std::runtime_error( "ast cache: bad string" );
+                }
+                std::string res( cur_, cur_ + len );
+                cur_ += len;
+                return res;
+            }
+
+            symbol get_name( )
+            {
+                auto id = get_uint( );
+                if( id == 0 ) {
+                    names_.emplace_back( get_string( ) );
+                    return names_.back( );
+                }
+                if( id > names_.size( ) ) {
+                    throw std::runtime_error( "ast cache: bad name" );
+                }
+                return names_[id - 1];
+            }
+
+            tokens::position get_pos( )
+            {
+                auto line = static_cast<std::int64_t>(last_.line) + get_int( );
+                last_.line = static_cast<std::size_t>(line);
+                last_.pos  = static_cast<std::size_t>(get_uint( ));
+                return last_;
+            }
+
+            void get_list( node_list &res )
+            {
+                auto count = get_uint( );
+                for( std::uint64_t i = 0; i < count; ++i ) {
+                    res.emplace_back( get( ) );
+                }
+            }
+
+            void get_tokens( expressions::lazy_body::token_list &res )
+            {
+                auto count = get_uint( );
+                for( std::uint64_t i = 0; i < count; ++i ) {
+                    auto tt = static_cast<tokens::type>(get_uint( ));
+                    tokens::info next;
+                    if( tt == tokens::type::IDENT ) {
+                        auto name = get_name( );
+                        next = tokens::info( tt, name.name( ) );
+                        next.ident.sym = name;
+                    } else {
+                        next = tokens::info( tt, get_string( ) );
+                    }
+                    next.where = get_pos( );
+                    res.emplace_back( std::move(next) );
+                }
+            }
+
+            node::uptr get( );
+
+            expression::uptr get_expr( )
+            {
+                auto n = get( );
+                return n ? expression::cast( n ) : expression::uptr( );
+            }
+
+            expressions::list::uptr get_params( )
+            {
+                auto n = get( );
+                if( !n ) {
+                    return expressions::list::uptr( );
+                }
+                return ast::cast<expressions::list>( n );
+            }
+
+        private:
+            const char         *cur_;
+            const char         *end_;
+            std::vector<symbol> names_;
+            tokens::position    last_;
+        };
+
+        static
+        bool save( const std::string &path, const program &prog,
+                   const char *src_begin, const char *src_end )
+        {
+            writer body;
+            if( !body.put_list( prog.states( ) ) ) {
+                return false;
+            }
+
+            writer head;
+            head.put_string( magic( ) );
+            head.put_string( version( ) );
+            head.put_uint( static_cast<std::uint64_t>(src_end - src_begin) );
+            head.put_fixed( hash( src_begin, src_end ) );
+            auto &bytes = body.data( );
+            head.put_uint( bytes.size( ) );
+            head.put_fixed( hash( bytes.data( ),
+                                  bytes.data( ) + bytes.size( ) ) );
+
+            /// write aside and rename, so a parallel run never sees a half
+            auto tmp = path + ".tmp" + std::to_string( process_id( ) );
+            {
+                std::ofstream f(tmp, std::ofstream::binary);
+                if( !f.is_open( ) ) {
+                    return false;
+                }
+                f.write( head.data( ).data( ), head.data( ).size( ) );
+                f.write( bytes.data( ), bytes.size( ) );
+                if( !f ) {
+                    std::remove( tmp.c_str( ) );
+                    return false;
+                }
+            }
+            if( std::rename( tmp.c_str( ), path.c_str( ) ) != 0 ) {
+                std::remove( tmp.c_str( ) );
+                return false;
+            }
+            return true;
+        }
+
+        static
+        bool load( const std::string &path, program *prog,
+                   const char *src_begin, const char *src_end )
+        {
+            mapped_file data(path);
+            if( !data.is_open( ) || !data.size( ) ) {
+                return false;
+            }
+            try {
+                reader r(data.begin( ), data.end( ));
+                if( r.get_string( ) != magic( )
+                 || r.get_string( ) != version( )
+                 || r.get_uint( ) != static_cast<std::uint64_t>(src_end
+                                                              - src_begin)
+                 || r.get_fixed( ) != hash( src_begin, src_end ) ) {
+                    return false;
+                }
+                auto size = r.get_uint( );
+                auto sum  = r.get_fixed( );
+                if( size != r.left( )
+                 || hash( r.position( ), data.end( ) ) != sum ) {
+                    return false;
+                }
+                node_list states;
+                r.get_list( states );
+                if( !r.eof( ) ) {
+                    return false;
+                }
+                prog->states( ).swap( states );
+                return true;
+            } catch( const std::exception & ) {
+                return false;
+            }
+        }
+
+    private:
+
+        static
+        std::string make_version( )
+        {
+            std::string res = std::string( "mico-ast-" )
+                             + std::to_string( format ) + "-";
+#if defined(MICO_BUILD_ID)
+            return res + MICO_BUILD_ID;
+#elif defined(__linux__)
+            mapped_file self("/proc/self/exe");
+            if( !self.is_open( ) || !self.size( ) ) {
+                return std::string( );
+            }
+            auto bin = objects::wyhash::get( self.begin( ), self.size( ),
+                                             self.size( ) );
+            return res + std::to_string( bin );
+#else
+            return std::string( );
+#endif
+        }
+
+        static
+        const char *magic( )
+        {
+            return "MICOAST";
+        }
+
+        static
+        long process_id( )
+        {
+#if defined(__unix__) || defined(__APPLE__)
+            return static_cast<long>(::getpid( ));
+#else
+            return 0;
+#endif
+        }
+    };
+
+    inline
+    bool cache::writer::put( const node *n )
+    {
+        namespace E = ast::expressions;
+        namespace S = ast::statements;
+
+        /// 0 is NONE in ast::type; null pointers get their own mark
+        static const std::uint8_t null_mark = 0xFF;
+
+        if( !n ) {
+            put_byte( null_mark );
+            return true;
+        }
+
+        put_byte( static_cast<std::uint8_t>(n->get_type( )) );
+        put_pos( n->pos( ) );
+
+        switch( n->get_type( ) ) {
+        case type::NONE:
+        case type::BREAK:
+        case type::CONTINUE:
+            return true;
+        case type::PROGRAM:
+            return put_list( static_cast<const program *>(n)->states( ) );
+        case type::IDENT:
+            put_name( static_cast<const E::ident *>(n)->sym( ).name( ) );
+            return true;
+        case type::LET: {
+            auto v = static_cast<const S::let *>(n);
+            put_byte( v->mut( ) ? 1 : 0 );
+            return put( v->ident( ).get( ) ) && put( v->value( ).get( ) );
+        }
+        case type::EXPR:
+            return put( static_cast<const S::expr *>(n)->value( ).get( ) );
+        case type::RETURN:
+            return put( static_cast<const S::ret *>(n)->value( ) );
+        case type::PREFIX: {
+            auto v = static_cast<const E::prefix *>(n);
+            put_uint( static_cast<std::uint64_t>(v->token( )) );
+            return put( v->value( ).get( ) );
+        }
+        case type::INFIX: {
+            auto v = static_cast<const E::infix *>(n);
+            put_uint( static_cast<std::uint64_t>(v->token( )) );
+            return put( v->left( ).get( ) ) && put( v->right( ).get( ) );
+        }
+        case type::STRING: {
+            auto v = static_cast<const E::string *>(n);
+            put_byte( v->is_raw( ) ? 1 : 0 );
+            put_string( v->value( ) );
+            return true;
+        }
+        case type::CHARACTER:
+            put_uint( static_cast<std::uint64_t>(
+                      static_cast<const E::character *>(n)->value( ) ) );
+            return true;
+        case type::INTEGER:
+            put_int( static_cast<const E::integer *>(n)->value( ) );
+            return true;
+        case type::FLOAT: {
+            double val = static_cast<const E::floating *>(n)->value( );
+            std::uint64_t bits = 0;
+            std::memcpy( &bits, &val, sizeof(bits) );
+            put_fixed( bits );
+            return true;
+        }
+        case type::BOOLEAN:
+            put_byte( static_cast<const E::boolean *>(n)->value( ) ? 1 : 0 );
+            return true;
+        case type::INFIN:
+            put_byte( static_cast<const E::infinite *>(n)->is_negative( )
+                      ? 1 : 0 );
+            return true;
+        case type::ARRAY:
+            return put_list( static_cast<const E::array *>(n)->value( ) );
+        case type::LIST: {
+            auto v = static_cast<const E::list *>(n);
+            put_byte( static_cast<std::uint8_t>(v->get_role( )) );
+            return put_list( v->value( ) );
+        }
+        case type::TABLE: {
+            auto v = static_cast<const E::table *>(n);
+            put_uint( v->value( ).size( ) );
+            for( auto &p: v->value( ) ) {
+                if( !put( p.first.get( ) ) || !put( p.second.get( ) ) ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case type::CALL: {
+            auto v = static_cast<const E::call *>(n);
+            return put( v->func( ).get( ) ) && put( v->params( ).get( ) );
+        }
+        case type::INDEX: {
+            auto v = static_cast<const E::index *>(n);
+            return put( v->value( ).get( ) ) && put( v->param( ).get( ) );
+        }
+        case type::IFELSE: {
+            auto v = static_cast<const E::ifelse *>(n);
+            put_byte( v->is_unless( ) ? 1 : 0 );
+            put_uint( v->ifs( ).size( ) );
+            for( auto &i: v->ifs( ) ) {
+                if( !put( i.cond.get( ) ) || !put( i.body.get( ) ) ) {
+                    return false;
+                }
+            }
+            return put( v->alt( ).get( ) );
+        }
+        case type::ELIPSIS:
+            return put( static_cast<const E::elipsis *>(n)->value( ).get( ) );
+        case type::FN: {
+            auto v = static_cast<const E::function *>(n);
+            put_uint( v->inits( ).size( ) );
+            for( auto &i: v->inits( ) ) {
+                put_name( i.first );
+                if( !put( i.second.get( ) ) ) {
+                    return false;
+                }
+            }
+            if( !put( v->params( ).get( ) ) ) {
+                return false;
+            }
+            put_byte( v->is_lazy( ) ? 1 : 0 );
+            if( v->is_lazy( ) ) {
+                put_tokens( v->lazy( )->tokens );
+                return true;
+            }
+            return put( v->body( ).get( ) );
+        }
+        case type::FORIN: {
+            auto v = static_cast<const E::forin *>(n);
+            return put( v->idents( ).get( ) ) && put( v->expres( ).get( ) )
+                && put( v->body( ).get( ) );
+        }
+        case type::MODULE: {
+            auto v = static_cast<const E::mod *>(n);
+            if( !put( v->name( ).get( ) ) || !put_list( v->parents( ) ) ) {
+                return false;
+            }
+            return put( v->body( ).get( ) );
+        }
+        case type::MOD_MUT:
+            return put( static_cast<const E::mod_mut *>(n)->value( ).get( ) );
+        case type::MOD_CONST:
+            return put( static_cast<const E::mod_const *>(n)
+                        ->value( ).get( ) );
+        case type::REGISTRY:
+            /// holds a pointer to a live object
+            return false;
+
+#if !defined(DISABLE_MACRO) || !DISABLE_MACRO
+        case type::QUOTE:
+            return put( static_cast<const E::quote *>(n)->value( ).get( ) );
+        case type::UNQUOTE:
+            return put( static_cast<const E::unquote *>(n)->value( ).get( ) );
+        case type::MACRO: {
+            auto v = static_cast<const E::macro *>(n);
+            return put( v->params( ).get( ) ) && put( v->body( ).get( ) );
+        }
+        case type::BUILTIN_MACRO:
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    inline
+    node::uptr cache::reader::get( )
+    {
+        namespace E = ast::expressions;
+        namespace S = ast::statements;
+
+        auto tag = get_byte( );
+        if( tag == 0xFF ) {
+            return node::uptr( );
+        }
+
+        auto pos = get_pos( );
+
+        node::uptr res;
+
+        switch( static_cast<type>(tag) ) {
+        case type::NONE:
+            res = E::null::make( );
+            break;
+        case type::BREAK:
+            res = S::break_expr::make( );
+            break;
+        case type::CONTINUE:
+            res = S::cont_expr::make( );
+            break;
+        case type::PROGRAM: {
+            program::uptr v(new program);
+            get_list( v->states( ) );
+            res = std::move(v);
+            break;
+        }
+        case type::IDENT:
+            res = E::ident::make( get_name( ) );
+            break;
+        case type::LET: {
+            bool mut = get_byte( ) != 0;
+            auto id  = get( );
+            auto val = get( );
+            res.reset( new S::let( std::move(id), std::move(val), mut ) );
+            break;
+        }
+        case type::EXPR:
+            res = S::expr::make( get_expr( ) );
+            break;
+        case type::RETURN:
+            res = S::ret::make( get( ) );
+            break;
+        case type::PREFIX: {
+            auto tt  = static_cast<tokens::type>(get_uint( ));
+            res.reset( new E::prefix( tt, get( ) ) );
+            break;
+        }
+        case type::INFIX: {
+            auto tt = static_cast<tokens::type>(get_uint( ));
+            auto v  = E::infix::make( tt, get( ) );
+            v->set_right( get( ) );
+            res = std::move(v);
+            break;
+        }
+        case type::STRING: {
+            bool raw = get_byte( ) != 0;
+            res.reset( new E::string( get_string( ), raw ) );
+            break;
+        }
+        case type::CHARACTER:
+            res = E::character::make(
+                     static_cast<E::character::value_type>(get_uint( )) );
+            break;
+        case type::INTEGER:
+            res = E::integer::make( get_int( ) );
+            break;
+        case type::FLOAT: {
+            auto bits = get_fixed( );
+            double val = 0;
+            std::memcpy( &val, &bits, sizeof(val) );
+            res = E::floating::make( val );
+            break;
+        }
+        case type::BOOLEAN:
+            res = E::boolean::make( get_byte( ) != 0 );
+            break;
+        case type::INFIN:
+            res = E::infinite::make( get_byte( ) != 0 );
+            break;
+        case type::ARRAY: {
+            E::array::uptr v(new E::array);
+            get_list( v->value( ) );
+            res = std::move(v);
+            break;
+        }
+        case type::LIST: {
+            auto role = static_cast<E::list::role>(get_byte( ));
+            E::list::uptr v(new E::list(role));
+            get_list( v->value( ) );
+            res = std::move(v);
+            break;
+        }
+        case type::TABLE: {
+            E::table::uptr v(new E::table);
+            auto count = get_uint( );
+            for( std::uint64_t i = 0; i < count; ++i ) {
+                auto key = get( );
+                auto val = get( );
+                v->value( ).emplace_back( std::move(key), std::move(val) );
+            }
+            res = std::move(v);
+            break;
+        }
+        case type::CALL: {
+            E::call::uptr v(new E::call(get( )));
+            v->set_params( get_params( ) );
+            res = std::move(v);
+            break;
+        }
+        case type::INDEX: {
+            auto left = get( );
+            res = E::index::make( std::move(left), get( ) );
+            break;
+        }
+        case type::IFELSE: {
+            auto v = E::ifelse::make( get_byte( ) != 0 );
+            auto count = get_uint( );
+            for( std::uint64_t i = 0; i < count; ++i ) {
+                E::ifelse::node next;
+                next.cond = get_expr( );
+                next.body = get_expr( );
+                v->ifs( ).emplace_back( std::move(next) );
+            }
+            v->alt( ) = get_expr( );
+            res = std::move(v);
+            break;
+        }
+        case type::ELIPSIS:
+            res = E::elipsis::make( get( ) );
+            break;
+        case type::FN: {
+            E::function::uptr v(new E::function);
+            auto count = get_uint( );
+            for( std::uint64_t i = 0; i < count; ++i ) {
+                auto name = get_name( );
+                v->inits( ).emplace( name.name( ), get( ) );
+            }
+            v->set_params( get_params( ) );
+            if( get_byte( ) ) {
+                auto lazy = std::make_shared<E::lazy_body>( );
+                get_tokens( lazy->tokens );
+                lazy->parse = &parser::parse_lazy;
+                v->set_lazy( std::move(lazy) );
+            } else {
+                v->set_body( get( ) );
+            }
+            res = std::move(v);
+            break;
+        }
+        case type::FORIN: {
+            auto v = E::forin::make( );
+            v->set_idents( get_params( ) );
+            v->set_expres( get_params( ) );
+            v->set_body( get_params( ) );
+            res = std::move(v);
+            break;
+        }
+        case type::MODULE: {
+            auto name = get( );
+            auto parents = E::list::make_params( );
+            get_list( parents->value( ) );
+            E::mod::uptr v(new E::mod(std::move(name), std::move(parents)));
+            v->set_body( get( ) );
+            res = std::move(v);
+            break;
+        }
+        case type::MOD_MUT:
+            res = E::mod_mut::make( get( ) );
+            break;
+        case type::MOD_CONST:
+            res = E::mod_const::make( get( ) );
+            break;
+
+#if !defined(DISABLE_MACRO) || !DISABLE_MACRO
+        case type::QUOTE:
+            res = E::quote::make( get( ) );
+            break;
+        case type::UNQUOTE:
+            res = E::unquote::make( get( ) );
+            break;
+        case type::MACRO: {
+            E::macro::uptr v(new E::macro);
+            v->set_params( get_params( ) );
+            v->set_body( get( ) );
+            res = std::move(v);
+            break;
+        }
+#endif
+        default:
+            throw std::runtime_error( "ast cache: bad node" );
+        }
+
+        res->set_pos( pos );
+        return res;
+    }
+
+}}
+
+#endif // AST_CACHE_H
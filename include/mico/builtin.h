@@ -13,6 +13,10 @@
 #include "mico/modules/debug.h"
 #include "mico/modules/string.h"
 #include "mico/modules/gc.h"
+#include "mico/modules/time.h"
+#include "mico/modules/vec.h"
+#include "mico/modules/matrix.h"
+#include "mico/modules/array.h"
 
 namespace mico {
 
@@ -37,19 +41,22 @@ namespace mico {
                 return integer::make( s->value( ).size( ));
             } else if( dat->get_type( ) == objects::type::ARRAY ) {
                 auto s = objects::cast_array(dat.get( ));
-                return integer::make( s->value( ).size( ));
+                return integer::make( s->size( ));
             } else if( dat->get_type( ) == objects::type::RSTRING ) {
                 auto s = objects::cast_rstring(dat.get( ));
                 return integer::make( s->value( ).size( ));
             } else if( dat->get_type( ) == objects::type::TABLE ) {
                 auto s = objects::cast_table(dat.get( ));
-                return integer::make( s->value( ).size( ));
+                return integer::make( s->size( ));
             } else if( dat->get_type( ) == objects::type::SSLICE ) {
                 auto s = objects::cast_sslice(dat.get( ));
                 return integer::make( s->size( ) );
             } else if( dat->get_type( ) == objects::type::ASLICE ) {
                 auto s = objects::cast_aslice(dat.get( ));
                 return integer::make( s->size( ) );
+            } else if( dat->get_type( ) == objects::type::MATRIX ) {
+                auto s = objects::cast_matrix(dat.get( ));
+                return integer::make( s->size( ) );
             }
             return error::make( tokens::position( line, 0),
                                 "Invalid parameter for 'len'");
@@ -233,9 +240,13 @@ namespace mico {
             env->set_const( "__macro", common::make( env, macro_show(env) ) );
 
             modules::io::load( env );
-            modules::debug::load( env );
+            modules::debug::load( env, ev );
             modules::string::load( env );
             modules::gc::load( env );
+            modules::time::load( env, ev );
+            modules::vec::load( env );
+            modules::matrix::load( env );
+            modules::array::load( env, ev );
 
 #if !defined(DISABLE_MACRO) || !DISABLE_MACRO
             st.macros( ).set_built( "__str",
@@ -0,0 +1,102 @@
+#ifndef MICO_BUILTIN_CALLER_H
+#define MICO_BUILTIN_CALLER_H
+
+#include <functional>
+
+#include "mico/ast.h"
+#include "mico/statements.h"
+#include "mico/expressions.h"
+#include "mico/objects.h"
+#include "mico/state.h"
+#include "mico/environment.h"
+
+namespace mico { namespace builtin {
+
+    /// Calls a callable object (function or builtin) from native code.
+    /// The object and its parameters are placed to the state registry
+    /// and are called via `fn(params...)` node. Registry values are removed
+    /// when the caller dies
+    class caller {
+
+    public:
+
+        using eval_call = std::function<objects::sptr(ast::node *)>;
+
+        caller( eval_call ev, environment::sptr env,
+                objects::sptr fun, const objects::slist &params )
+            :ev_(std::move(ev))
+            ,env_(env)
+            ,slots_(params.size( ) + 1)
+        {
+            namespace E = ast::expressions;
+            namespace S = ast::statements;
+
+            auto &st( env->get_state( ) );
+            st.add_registry_value( slot_id( 0 ), fun );
+            auto call = E::call::uptr( new E::call( make_reg( 0 ) ) );
+
+            for( std::size_t i = 0; i < params.size( ); ++i ) {
+                st.add_registry_value( slot_id( i + 1 ), params[i] );
+                call->param_list( ).emplace_back( make_reg( i + 1 ) );
+            }
+            ast::node::uptr expr( std::move( call ) );
+            prog_.push_state( S::expr::make( ast::expression::cast( expr ) ) );
+        }
+
+        ~caller( )
+        {
+            if( auto e = env_.lock( ) ) {
+                for( std::size_t i = 0; i < slots_.size( ); ++i ) {
+                    e->get_state( ).del_registry_value( slot_id( i ) );
+                }
+            }
+        }
+
+        caller( const caller & ) = delete;
+        caller &operator = ( const caller & ) = delete;
+
+        objects::sptr operator ( )( )
+        {
+            return ev_( &prog_ );
+        }
+
+        /// replaces the parameter `id` for the next calls
+        void set_param( std::size_t id, objects::sptr val )
+        {
+            if( auto e = env_.lock( ) ) {
+                e->get_state( ).add_registry_value( slot_id( id + 1 ),
+                                                    std::move(val) );
+            }
+        }
+
+        static
+        bool is_callable( const objects::sptr &obj )
+        {
+            return (obj->get_type( ) == objects::type::FUNCTION)
+                || (obj->get_type( ) == objects::type::BUILTIN)
+                 ;
+        }
+
+    private:
+
+        /// addresses of the slots are unique while the caller lives
+        std::uintptr_t slot_id( std::size_t id ) const
+        {
+            return reinterpret_cast<std::uintptr_t>(&slots_[id]);
+        }
+
+        ast::node::uptr make_reg( std::size_t id ) const
+        {
+            using reg_type = ast::expressions::registry;
+            return ast::node::uptr( new reg_type( slot_id( id ) ) );
+        }
+
+        eval_call           ev_;
+        environment::wptr   env_;
+        std::vector<char>   slots_;
+        ast::program        prog_;
+    };
+
+}}
+
+#endif // CALLER_H
@@ -0,0 +1,363 @@
+#ifndef MICO_CHARSET_SCAN_H
+#define MICO_CHARSET_SCAN_H
+
+#include <string>
+#include <cstdint>
+#include <iterator>
+
+#if (!defined(DISABLE_SIMD) || !DISABLE_SIMD) && defined(__GNUC__) \
+    && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#include <immintrin.h>
+#define MICO_SCAN_X86 1
+#else
+#define MICO_SCAN_X86 0
+#endif
+
+namespace mico { namespace charset {
+
+    /// Byte scanners for the lexer hot loops.
+    /// Every call returns the first position that stops the scan
+    /// (or `end`), exactly as the byte by byte loop would do.
+    /// Contiguous char ranges go to SSE2/AVX2 versions picked once at
+    /// runtime; everything else uses the scalar loops.
+    struct scan {
+
+        /// '\n' or '\r'
+        template <typename ItrT>
+        static
+        ItrT newline( ItrT begin, ItrT end )
+        {
+            return call( begin, end, impl::get( ).newline, &scalar_newline );
+        }
+
+        /// `quote`, '\\' or '\n'
+        template <typename ItrT>
+        static
+        ItrT string_stop( ItrT begin, ItrT end, char quote )
+        {
+            if( begin == end ) {
+                return end;
+            }
+            auto ptr = raw<ItrT>::get( begin );
+            if( ptr ) {
+                auto len = std::distance( begin, end );
+                auto res = impl::get( ).string_stop( ptr, ptr + len, quote );
+                return std::next( begin, res - ptr );
+            }
+            for( ; begin != end; ++begin ) {
+                if( *begin == quote || *begin == '\\' || *begin == '\n' ) {
+                    break;
+                }
+            }
+            return begin;
+        }
+
+        /// the first byte that is not `idents::is_ident`
+        template <typename ItrT>
+        static
+        ItrT ident_end( ItrT begin, ItrT end )
+        {
+            return call( begin, end, impl::get( ).ident_end,
+                         &scalar_ident_end );
+        }
+
+        static
+        const char *name( )
+        {
+            return impl::get( ).name;
+        }
+
+    private:
+
+        using find_call   = const char *(*)( const char *, const char * );
+        using string_call = const char *(*)( const char *, const char *,
+                                             char );
+
+        /// pointer access for the contiguous iterators
+        template <typename ItrT>
+        struct raw {
+            static const char *get( ItrT ) { return nullptr; }
+        };
+
+        template <typename ItrT, typename ScalarT>
+        static
+        ItrT call( ItrT begin, ItrT end, find_call fast, ScalarT scalar )
+        {
+            if( begin == end ) {
+                return end;
+            }
+            auto ptr = raw<ItrT>::get( begin );
+            if( ptr ) {
+                auto len = std::distance( begin, end );
+                return std::next( begin, fast( ptr, ptr + len ) - ptr );
+            }
+            for( ; begin != end; ++begin ) {
+                if( scalar( *begin ) ) {
+                    break;
+                }
+            }
+            return begin;
+        }
+
+        static
+        bool scalar_newline( char c )
+        {
+            return (c == '\n') || (c == '\r');
+        }
+
+        static
+        bool scalar_ident_end( char c )
+        {
+            return !( (('0' <= c) && (c <= '9'))
+                   || (('a' <= c) && (c <= 'z'))
+                   || (('A' <= c) && (c <= 'Z'))
+                   || (c == '_')
+                   || (static_cast<std::uint8_t>(c) > 127) );
+        }
+
+        static
+        const char *scalar_find_newline( const char *b, const char *e )
+        {
+            while( b != e && !scalar_newline( *b ) ) {
+                ++b;
+            }
+            return b;
+        }
+
+        static
+        const char *scalar_find_ident_end( const char *b, const char *e )
+        {
+            while( b != e && !scalar_ident_end( *b ) ) {
+                ++b;
+            }
+            return b;
+        }
+
+        static
+        const char *scalar_string_stop( const char *b, const char *e, char q )
+        {
+            while( b != e && *b != q && *b != '\\' && *b != '\n' ) {
+                ++b;
+            }
+            return b;
+        }
+
+#if MICO_SCAN_X86
+
+        static
+        int first_bit( unsigned mask )
+        {
+            return __builtin_ctz( mask );
+        }
+
+        /// bytes that can be a part of an ident
+        static
+        __m128i ident_mask_sse2( __m128i v )
+        {
+            const __m128i lower = _mm_or_si128( v, _mm_set1_epi8( 0x20 ) );
+            const __m128i alpha = _mm_and_si128(
+                          _mm_cmpgt_epi8( lower, _mm_set1_epi8( 'a' - 1 ) ),
+                          _mm_cmplt_epi8( lower, _mm_set1_epi8( 'z' + 1 ) ) );
+            const __m128i digit = _mm_and_si128(
+                          _mm_cmpgt_epi8( v, _mm_set1_epi8( '0' - 1 ) ),
+                          _mm_cmplt_epi8( v, _mm_set1_epi8( '9' + 1 ) ) );
+            const __m128i under = _mm_cmpeq_epi8( v, _mm_set1_epi8( '_' ) );
+            const __m128i high  = _mm_cmplt_epi8( v, _mm_setzero_si128( ) );
+            return _mm_or_si128( _mm_or_si128( alpha, digit ),
+                                 _mm_or_si128( under, high ) );
+        }
+
+        static
+        const char *sse2_newline( const char *b, const char *e )
+        {
+            const __m128i nl = _mm_set1_epi8( '\n' );
+            const __m128i cr = _mm_set1_epi8( '\r' );
+            for( ; e - b >= 16; b += 16 ) {
+                __m128i v = _mm_loadu_si128(
+                                reinterpret_cast<const __m128i *>(b) );
+                unsigned m = static_cast<unsigned>( _mm_movemask_epi8(
+                                _mm_or_si128( _mm_cmpeq_epi8( v, nl ),
+                                              _mm_cmpeq_epi8( v, cr ) ) ) );
+                if( m ) {
+                    return b + first_bit( m );
+                }
+            }
+            return scalar_find_newline( b, e );
+        }
+
+        static
+        const char *sse2_string_stop( const char *b, const char *e, char q )
+        {
+            const __m128i qv = _mm_set1_epi8( q );
+            const __m128i bs = _mm_set1_epi8( '\\' );
+            const __m128i nl = _mm_set1_epi8( '\n' );
+            for( ; e - b >= 16; b += 16 ) {
+                __m128i v = _mm_loadu_si128(
+                                reinterpret_cast<const __m128i *>(b) );
+                __m128i r = _mm_or_si128( _mm_cmpeq_epi8( v, qv ),
+                            _mm_or_si128( _mm_cmpeq_epi8( v, bs ),
+                                          _mm_cmpeq_epi8( v, nl ) ) );
+                unsigned m = static_cast<unsigned>( _mm_movemask_epi8( r ) );
+                if( m ) {
+                    return b + first_bit( m );
+                }
+            }
+            return scalar_string_stop( b, e, q );
+        }
+
+        static
+        const char *sse2_ident_end( const char *b, const char *e )
+        {
+            for( ; e - b >= 16; b += 16 ) {
+                __m128i v = _mm_loadu_si128(
+                                reinterpret_cast<const __m128i *>(b) );
+                unsigned m = static_cast<unsigned>(
+                                _mm_movemask_epi8( ident_mask_sse2( v ) ) );
+                m = ~m & 0xFFFF;
+                if( m ) {
+                    return b + first_bit( m );
+                }
+            }
+            return scalar_find_ident_end( b, e );
+        }
+
+        __attribute__((target("avx2")))
+        static
+        const char *avx2_newline( const char *b, const char *e )
+        {
+            const __m256i nl = _mm256_set1_epi8( '\n' );
+            const __m256i cr = _mm256_set1_epi8( '\r' );
+            for( ; e - b >= 32; b += 32 ) {
+                __m256i v = _mm256_loadu_si256(
+                                reinterpret_cast<const __m256i *>(b) );
+                unsigned m = static_cast<unsigned>( _mm256_movemask_epi8(
+                                _mm256_or_si256( _mm256_cmpeq_epi8( v, nl ),
+                                                 _mm256_cmpeq_epi8( v, cr ) ) ) );
+                if( m ) {
+                    return b + first_bit( m );
+                }
+            }
+            return sse2_newline( b, e );
+        }
+
+        __attribute__((target("avx2")))
+        static
+        const char *avx2_string_stop( const char *b, const char *e, char q )
+        {
+            const __m256i qv = _mm256_set1_epi8( q );
+            const __m256i bs = _mm256_set1_epi8( '\\' );
+            const __m256i nl = _mm256_set1_epi8( '\n' );
+            for( ; e - b >= 32; b += 32 ) {
+                __m256i v = _mm256_loadu_si256(
+                                reinterpret_cast<const __m256i *>(b) );
+                __m256i r = _mm256_or_si256( _mm256_cmpeq_epi8( v, qv ),
+                            _mm256_or_si256( _mm256_cmpeq_epi8( v, bs ),
+                                             _mm256_cmpeq_epi8( v, nl ) ) );
+                unsigned m = static_cast<unsigned>(
+                                _mm256_movemask_epi8( r ) );
+                if( m ) {
+                    return b + first_bit( m );
+                }
+            }
+            return sse2_string_stop( b, e, q );
+        }
+
+        __attribute__((target("avx2")))
+        static
+        const char *avx2_ident_end( const char *b, const char *e )
+        {
+            const __m256i lo_a  = _mm256_set1_epi8( 'a' - 1 );
+            const __m256i hi_z  = _mm256_set1_epi8( 'z' + 1 );
+            const __m256i lo_0  = _mm256_set1_epi8( '0' - 1 );
+            const __m256i hi_9  = _mm256_set1_epi8( '9' + 1 );
+            const __m256i under = _mm256_set1_epi8( '_' );
+            const __m256i case_ = _mm256_set1_epi8( 0x20 );
+            const __m256i zero  = _mm256_setzero_si256( );
+            for( ; e - b >= 32; b += 32 ) {
+                __m256i v = _mm256_loadu_si256(
+                                reinterpret_cast<const __m256i *>(b) );
+                __m256i l = _mm256_or_si256( v, case_ );
+                __m256i alpha = _mm256_and_si256(
+                                    _mm256_cmpgt_epi8( l, lo_a ),
+                                    _mm256_cmpgt_epi8( hi_z, l ) );
+                __m256i digit = _mm256_and_si256(
+                                    _mm256_cmpgt_epi8( v, lo_0 ),
+                                    _mm256_cmpgt_epi8( hi_9, v ) );
+                __m256i r = _mm256_or_si256(
+                                _mm256_or_si256( alpha, digit ),
+                                _mm256_or_si256( _mm256_cmpeq_epi8( v, under ),
+                                                 _mm256_cmpgt_epi8( zero, v ) ) );
+                unsigned m = ~static_cast<unsigned>(
+                                _mm256_movemask_epi8( r ) );
+                if( m ) {
+                    return b + first_bit( m );
+                }
+            }
+            return sse2_ident_end( b, e );
+        }
+#endif
+
+        struct impl {
+
+            find_call   newline;
+            string_call string_stop;
+            find_call   ident_end;
+            const char *name;
+
+            static
+            const impl &get( )
+            {
+                static const impl inst = select( );
+                return inst;
+            }
+
+            static
+            impl select( )
+            {
+#if MICO_SCAN_X86
+                __builtin_cpu_init( );
+                if( __builtin_cpu_supports( "avx2" ) ) {
+                    return impl { &avx2_newline, &avx2_string_stop,
+                                  &avx2_ident_end, "avx2" };
+                }
+                return impl { &sse2_newline, &sse2_string_stop,
+                              &sse2_ident_end, "sse2" };
+#else
+                return impl { &scalar_find_newline, &scalar_string_stop,
+                              &scalar_find_ident_end, "scalar" };
+#endif
+            }
+        };
+    };
+
+    template <>
+    struct scan::raw<const char *> {
+        static const char *get( const char *p ) { return p; }
+    };
+
+    template <>
+    struct scan::raw<char *> {
+        static const char *get( char *p ) { return p; }
+    };
+
+    template <>
+    struct scan::raw<std::string::const_iterator> {
+        static const char *get( std::string::const_iterator p )
+        {
+            return &*p;
+        }
+    };
+
+    template <>
+    struct scan::raw<std::string::iterator> {
+        static const char *get( std::string::iterator p )
+        {
+            return &*p;
+        }
+    };
+
+}}
+
+#undef MICO_SCAN_X86
+
+#endif // SCAN_H
@@ -10,6 +10,7 @@
 
 #include "mico/objects/base.h"
 #include "mico/objects/reference.h"
+#include "mico/symbols.h"
 
 #include "etool/console/colors.h"
 
@@ -34,7 +35,7 @@ namespace mico {
         using object_wptr   = std::weak_ptr<objects::base>;
         using children_type = std::set<sptr>;
         using obj_reference = objects::impl<objects::type::REFERENCE>;
-        using data_map      = std::map<std::string, obj_reference::sptr>;
+        using data_map      = std::map<symbol, obj_reference::sptr>;
         using data_set      = std::set<obj_reference::sptr>;
         using parent_list   = std::list<wptr>;
 
@@ -278,7 +279,7 @@ namespace mico {
             marked_--;
         }
 
-        sptr find_contains( const std::string &name )
+        sptr find_contains( const symbol &name )
         {
             auto cur = this;
             sptr parent = shared_from_this( );
@@ -299,13 +300,13 @@ namespace mico {
             parents_.push_back( par );
         }
 
-        void set( const std::string &name, object_sptr val )
+        void set( const symbol &name, object_sptr val )
         {
             auto ref = obj_reference::make_var( this, val );
             data_[name] = ref;
         }
 
-        void set_const( const std::string &name, object_sptr val )
+        void set_const( const symbol &name, object_sptr val )
         {
             auto ref = obj_reference::make_const( this, val );
             data_[name] = ref;
@@ -316,7 +317,7 @@ namespace mico {
             hide_.insert( obj_reference::make_var( this, val ) );
         }
 
-        object_sptr get_here( const std::string &name )
+        object_sptr get_here( const symbol &name )
         {
             auto f = data_.find( name );
             if( f != data_.end( ) ) {
@@ -327,7 +328,7 @@ namespace mico {
             return nullptr;
         }
 
-        object_sptr get_parent( const std::string &name, bool here_only )
+        object_sptr get_parent( const symbol &name, bool here_only )
         {
             auto b = parents_.rbegin( );
             auto e = parents_.rend( );
@@ -349,7 +350,7 @@ namespace mico {
             return nullptr;
         }
 
-        object_sptr get_parents_only( const std::string &name )
+        object_sptr get_parents_only( const symbol &name )
         {
             if( auto v = get_here( name ) ) {
                 return v;
@@ -357,7 +358,7 @@ namespace mico {
             return get_parent( name, true );
         }
 
-        object_sptr get( const std::string &name )
+        object_sptr get( const symbol &name )
         {
             auto cur = this;
             object_sptr res;
@@ -22,7 +22,7 @@ namespace mico { namespace eval { namespace operations {
             auto tt = ref.unref( );
 
             if( pref->token( ) == tokens::type::ASTERISK ) {
-                return int_type::make( tt->value( ).size( ) );
+                return int_type::make( tt->size( ) );
             }
             return error_type::make( pref->pos( ),   "Prefix operator '",
                                      pref->token( ), "' is not defined for"
@@ -30,20 +30,12 @@ namespace mico { namespace eval { namespace operations {
         }
 
         static
-        objects::sptr eval_array( environment::sptr env,
+        objects::sptr eval_array( environment::sptr /*env*/,
                                   objects::sptr lft, objects::sptr rght )
         {
             auto ltable = objects::cast_array(lft);
             auto rtable = objects::cast_array(rght);
-
-            auto res = ltable->clone( );
-            auto restabe = objects::cast_array(res);
-
-            for( auto &v: rtable->value( ) ) {
-                restabe->push( env.get( ), v->value( ) );
-            }
-
-            return res;
+            return ltable->concat( rtable.get( ) );
         }
 
         static
@@ -54,9 +46,11 @@ namespace mico { namespace eval { namespace operations {
             return common::eval_ival_index<objects::array>(idx, str, id);
         }
 
+        /// `target` is set for the left side of an assignment
         static
         objects::sptr eval_index( index *idx, objects::sptr obj,
-                                  eval_call ev, environment::sptr env  )
+                                  eval_call ev, environment::sptr env,
+                                  bool target = false )
         {
             common::reference<objects::type::ARRAY> ref(obj);
             auto arr = ref.shared_unref( );
@@ -77,7 +71,8 @@ namespace mico { namespace eval { namespace operations {
 
             std::int64_t index = common::to_index( id );
 
-            if( auto res = arr->at( index ) ) {
+            if( auto res = target ? objects::array::ref_at( arr, index )
+                                  : arr->at( index ) ) {
                 return res;
             }
 
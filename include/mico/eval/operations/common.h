@@ -192,8 +192,7 @@ namespace mico { namespace eval { namespace operations {
                                      environment::sptr /*env*/  )
         {
             auto tbl = objects::cast_table( rght.get( ) );
-            auto f = tbl->value( ).find( lft );
-            return objects::boolean::make(f != tbl->value( ).end( ));
+            return objects::boolean::make( tbl->find( lft ) != nullptr );
         }
 
         static
@@ -204,8 +203,8 @@ namespace mico { namespace eval { namespace operations {
             using OB = objects::boolean;
             auto arr = objects::cast_array( rght.get( ) );
 
-            for( auto &a: arr->value( ) ) {
-                auto &val(a->value( ));
+            for( std::size_t id = 0; id < arr->size( ); ++id ) {
+                auto val(arr->element( id ));
                 if( val->get_type( ) == objects::type::FLOAT ) {
 
                     if( auto o = objects::numeric::to_float(lft) ) {
@@ -355,7 +354,7 @@ namespace mico { namespace eval { namespace operations {
 
                 if( is_ident( p ) ) {
                     auto n = static_cast<ast::expressions::ident *>(p.get( ));
-                    new_env->set( n->value( ), obj );
+                    new_env->set( n->sym( ), obj );
                 } else {
                     return error_type::make( inf->pos( ),
                                              "Invalid argument ", 1,
@@ -370,7 +369,8 @@ namespace mico { namespace eval { namespace operations {
                                              "Invalid parameter type.",
                                              p->get_type( ));
                 }
-                call_env->set( p->str( ), obj );
+                auto n = static_cast<ast::expressions::ident *>(p.get( ));
+                call_env->set( n->sym( ), obj );
             }
             return objects::tail_call::make( call, call_env );
         }
@@ -103,6 +103,10 @@ namespace mico { namespace eval { namespace operations {
                 auto rval = objects::cast_bool(right.get( ))->value( );
                 return eval_float( inf, val, rval ? 1.0 : 0.0);
             }
+            case objects::type::MATRIX: {
+                using OP_matrix = operation<objects::type::MATRIX>;
+                return OP_matrix::eval_scalar( inf, type_value, val, right );
+            }
             default:
                 return common::common_infix( inf, obj, right, env );
             }
@@ -4,6 +4,7 @@
 #include "mico/eval/operation.h"
 #include "mico/tokens.h"
 #include "mico/eval/operations/common.h"
+#include "mico/eval/operations/matrix.h"
 
 #include "mico/objects/interval.h"
 #include "mico/ast.h"
@@ -213,6 +214,12 @@ namespace mico { namespace eval { namespace operations {
                 auto rval = objects::cast_bool(right.get( ))->value( );
                 return eval_int(inf, val, rval ? 1 : 0);
             }
+            case objects::type::MATRIX: {
+                using OP_matrix = operation<objects::type::MATRIX>;
+                return OP_matrix::eval_scalar( inf, type_value,
+                                               static_cast<double>(val),
+                                               right );
+            }
             default:
                 return common::common_infix( inf, obj, right, env );
             }
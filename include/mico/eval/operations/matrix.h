@@ -0,0 +1,314 @@
+#ifndef MICO_EVAL_MATRIX_H
+#define MICO_EVAL_MATRIX_H
+
+#include <algorithm>
+#include "mico/tokens.h"
+#include "mico/eval/operations/common.h"
+#include "mico/objects/matrix.h"
+#include "mico/modules/vec/kernels.h"
+
+namespace mico { namespace eval { namespace operations {
+
+    template <>
+    struct operation<objects::type::MATRIX> {
+
+        using error_type  = objects::impl<objects::type::FAILURE>;
+        using matrix      = objects::matrix;
+        using float_type  = matrix::float_type;
+        using K           = modules::vec_kernels;
+        using prefix      = ast::expressions::prefix;
+        using infix       = ast::expressions::infix;
+        using index       = ast::expressions::index;
+
+        /// a new matrix with `a` op `b` for every element; `as` and `bs`
+        /// mark a number instead of a matrix
+        template <typename Op>
+        static
+        objects::sptr apply( std::size_t rows, std::size_t cols,
+                             const float_type *a, bool as,
+                             const float_type *b, bool bs )
+        {
+            auto res = matrix::make( rows, cols );
+            K::binary<Op>( a, as, b, bs, res->mutable_data( ), rows * cols );
+            return res;
+        }
+
+        static
+        bool has_zero( const matrix *mat )
+        {
+            auto end = mat->data( ) + mat->rows( ) * mat->cols( );
+            return std::find( mat->data( ), end, 0.0 ) != end;
+        }
+
+        static
+        objects::sptr eval_prefix( prefix *pref, objects::sptr obj )
+        {
+            common::reference<objects::type::MATRIX> ref(obj);
+            auto mat = ref.unref( );
+
+            if( pref->token( ) == tokens::type::MINUS ) {
+                float_type zero = 0;
+                return apply<K::sub_op>( mat->rows( ), mat->cols( ),
+                                         &zero, true, mat->data( ), false );
+            }
+            return error_type::make( pref->pos( ),   "Prefix operator '",
+                                     pref->token( ), "' is not defined for"
+                                                     " matrices");
+        }
+
+        /// [beg, end) of `id`: a number is one index, an interval is
+        /// a range as for the arrays. False if it is out of [0, count]
+        static
+        bool to_range( const objects::sptr &id, std::size_t count,
+                       std::size_t &beg, std::size_t &end, bool &single )
+        {
+            single = common::is_numeric( id );
+            if( single ) {
+                beg = matrix::fix_id( common::to_index( id ), count );
+                end = beg + 1;
+                return beg != matrix::npos;
+            } else if( id->get_type( ) != objects::type::INTERVAL ) {
+                return false;
+            }
+
+            auto ival = objects::cast_ival( id.get( ) );
+            if( !common::is_numeric( ival->domain( ) ) ) {
+                return false;
+            }
+            auto siz   = static_cast<std::int64_t>(count);
+            auto start = common::to_index( ival->begin( ) );
+            auto stop  = common::to_index( ival->end( ) );
+            start = start < 0 ? siz + start + 1 : start;
+            stop  = stop  < 0 ? siz + stop  + 1 : stop;
+            if( start < 0 || start > stop || stop > siz ) {
+                return false;
+            }
+            beg = static_cast<std::size_t>(start);
+            end = static_cast<std::size_t>(stop);
+            return true;
+        }
+
+        /// `m[rows, cols]`: a number, a packed array of a part of a row
+        /// or of a column, or a matrix
+        static
+        objects::sptr make_part( const matrix::sptr &mat, environment::sptr env,
+                                 std::size_t r0, std::size_t r1, bool row,
+                                 std::size_t c0, std::size_t c1, bool col,
+                                 bool target )
+        {
+            if( row && col ) {
+                return matrix::cell( mat, r0, c0, target );
+            } else if( row || col ) {
+                auto res = std::make_shared<objects::packed>(
+                                                    objects::type::FLOAT );
+                auto &vals( res->floats( ) );
+                for( auto r = r0; r < r1; ++r ) {
+                    for( auto c = c0; c < c1; ++c ) {
+                        vals.push_back( mat->at( r, c ) );
+                    }
+                }
+                return std::make_shared<objects::array>( env, res );
+            }
+            auto res = matrix::make( r1 - r0, c1 - c0 );
+            auto out = res->mutable_data( );
+            for( auto r = r0; r < r1; ++r ) {
+                auto from = mat->data( ) + r * mat->cols( );
+                out = std::copy( from + c0, from + c1, out );
+            }
+            return res;
+        }
+
+        /// `m[i]` is a row, `m[a..b]` is a matrix of rows,
+        /// `m[i, j]` is an element; `i` and `j` can be intervals too.
+        /// `target` is set for the left side of an assignment
+        static
+        objects::sptr eval_index( index *idx, objects::sptr obj,
+                                  eval_call ev, environment::sptr env,
+                                  bool target = false )
+        {
+            common::reference<objects::type::MATRIX> ref(obj);
+            auto mat = ref.shared_unref( );
+
+            objects::sptr id = ev( idx->param( ).get( ), env );
+            if( id->get_type( ) == objects::type::FAILURE ) {
+                return id;
+            }
+
+            objects::sptr rid = id;
+            objects::sptr cid;
+            if( id->get_type( ) == objects::type::ARRAY ) {
+                auto pair = objects::cast_array( id.get( ) );
+                if( pair->size( ) != 2 ) {
+                    return error_type::make( idx->param( )->pos( ),
+                                             idx->param( ).get( ),
+                                 " is not a valid index for the matrix" );
+                }
+                rid = pair->element( 0 );
+                cid = pair->element( 1 );
+            }
+
+            std::size_t r0 = 0;
+            std::size_t r1 = 0;
+            std::size_t c0 = 0;
+            std::size_t c1 = mat->cols( );
+            bool row = false;
+            bool col = false;
+            if( !to_range( rid, mat->rows( ), r0, r1, row ) ||
+                (cid && !to_range( cid, mat->cols( ), c0, c1, col )) )
+            {
+                return error_type::make( idx->param( )->pos( ),
+                                         idx->param( ).get( ),
+                              " is not a valid index for the matrix" );
+            }
+            return make_part( mat, env, r0, r1, row, c0, c1, col, target );
+        }
+
+        static
+        objects::sptr eval_matrix( infix *inf, const matrix *lft,
+                                   const matrix *rgh )
+        {
+            auto tt = inf->token( );
+            if( tt == tokens::type::ASTERISK ) {
+                if( lft->cols( ) != rgh->rows( ) ) {
+                    return error_type::make( inf->pos( ),
+                                "Matrices ", lft->rows( ), "x", lft->cols( ),
+                                " and ", rgh->rows( ), "x", rgh->cols( ),
+                                " cannot be multiplied" );
+                }
+                auto res = matrix::try_make( lft->rows( ), rgh->cols( ) );
+                if( !res ) {
+                    return error_type::make( inf->pos( ),
+                                "Matrix ", lft->rows( ), "x", rgh->cols( ),
+                                " is too big" );
+                }
+                K::matmul( lft->data( ), rgh->data( ), res->mutable_data( ),
+                           lft->rows( ), lft->cols( ), rgh->cols( ) );
+                return res;
+            }
+
+            if( lft->rows( ) != rgh->rows( ) || lft->cols( ) != rgh->cols( ) ) {
+                return error_type::make( inf->pos( ),
+                                "Matrices ", lft->rows( ), "x", lft->cols( ),
+                                " and ", rgh->rows( ), "x", rgh->cols( ),
+                                " have different sizes" );
+            }
+            switch( tt ) {
+            case tokens::type::PLUS:
+                return apply<K::add_op>( lft->rows( ), lft->cols( ),
+                                         lft->data( ), false,
+                                         rgh->data( ), false );
+            case tokens::type::MINUS:
+                return apply<K::sub_op>( lft->rows( ), lft->cols( ),
+                                         lft->data( ), false,
+                                         rgh->data( ), false );
+            default:
+                break;
+            }
+            return nullptr;
+        }
+
+        /// a number and a matrix in any order
+        static
+        objects::sptr eval_number( infix *inf, const matrix *mat,
+                                   float_type val, bool number_left )
+        {
+            auto rows = mat->rows( );
+            auto cols = mat->cols( );
+            auto a    = number_left ? &val : mat->data( );
+            auto b    = number_left ? mat->data( ) : &val;
+            switch( inf->token( ) ) {
+            case tokens::type::PLUS:
+                return apply<K::add_op>( rows, cols, a, number_left,
+                                         b, !number_left );
+            case tokens::type::MINUS:
+                return apply<K::sub_op>( rows, cols, a, number_left,
+                                         b, !number_left );
+            case tokens::type::ASTERISK:
+                return apply<K::mul_op>( rows, cols, a, number_left,
+                                         b, !number_left );
+            case tokens::type::SLASH:
+                if( number_left ? has_zero( mat ) : val == 0 ) {
+                    return error_type::make( inf->pos( ),
+                                             "Division by zero. '/'" );
+                }
+                return apply<K::div_op>( rows, cols, a, number_left,
+                                         b, !number_left );
+            default:
+                break;
+            }
+            return nullptr;
+        }
+
+        /// `lft` op `mat` for a number of type `ltype` on the left side
+        static
+        objects::sptr eval_scalar( infix *inf, objects::type ltype,
+                                   float_type lft, objects::sptr mat )
+        {
+            auto res = eval_number( inf, objects::cast_matrix( mat.get( ) ),
+                                    lft, true );
+            if( res ) {
+                return res;
+            }
+            return error_type::make(inf->pos( ), "Infix operation ",
+                                    ltype, " '",
+                                    inf->token( ), "' ",
+                                    mat->get_type( ),
+                                    " is not defined");
+        }
+
+        static
+        objects::sptr eval_infix( infix *inf, objects::sptr obj,
+                                  eval_call ev, environment::sptr env  )
+        {
+            common::reference<objects::type::MATRIX> ref(obj);
+            obj = ref.shared_unref( );
+            auto mat = objects::cast_matrix( obj.get( ) );
+
+            objects::sptr right = ev( inf->right( ).get( ), env );
+            if( right->get_type( ) == objects::type::FAILURE ) {
+                return right;
+            }
+
+            if( (inf->token( ) == tokens::type::EQ) ||
+                (inf->token( ) == tokens::type::NOT_EQ) ) {
+                return common::eval_equal( inf, obj, right );
+            }
+
+            objects::sptr res;
+            switch( right->get_type( ) ) {
+            case objects::type::MATRIX:
+                res = eval_matrix( inf, mat,
+                                   objects::cast_matrix( right.get( ) ) );
+                break;
+            case objects::type::INTEGER: {
+                auto val = objects::cast_int( right.get( ) )->value( );
+                res = eval_number( inf, mat, static_cast<float_type>(val),
+                                   false );
+                break;
+            }
+            case objects::type::FLOAT: {
+                auto val = objects::cast_float( right.get( ) )->value( );
+                res = eval_number( inf, mat, val, false );
+                break;
+            }
+            default:
+                return common::common_infix( inf, obj, right, env );
+            }
+            if( res ) {
+                return res;
+            }
+
+            return error_type::make(inf->pos( ), "Infix operation ",
+                                    obj->get_type( )," '",
+                                    inf->token( ), "' ",
+                                    right->get_type( ),
+                                    " is not defined");
+        }
+
+    };
+
+    using matrix = operation<objects::type::MATRIX>;
+
+}}}
+
+#endif // MATRIX_H
@@ -35,15 +35,16 @@ namespace mico { namespace eval { namespace operations {
             using call_type = ast::expressions::call;
             auto call = ast::cast<call_type>( inf->right( ).get( ) );
             if( call->func( )->get_type( ) == ast::type::IDENT ) {
-                auto id = call->func( )->str( );
+                auto id = ast::cast<ast::expressions::ident>( call->func( )
+                                                                  .get( ) );
 
-                if( auto call = mod->get( id ) ) {
+                if( auto call = mod->get( id->sym( ) ) ) {
                     auto n = inf->right( ).get( );
                     auto call_node = ast::cast<ast::expressions::call>(n);
                     return ev( call_node, call, env );
                 } else {
                     return common::error_type::make( inf->right( )->pos( ),
-                                "Identifier not found '", id, "'");
+                                "Identifier not found '", id->str( ), "'");
                 }
             }
 
@@ -62,13 +63,14 @@ namespace mico { namespace eval { namespace operations {
             if( inf->token( ) == tokens::type::DOT ) {
                 if( inf->right( )->get_type( ) == ast::type::IDENT ) {
 
-                    auto id = inf->right( )->str( );
+                    auto id = ast::cast<ast::expressions::ident>( inf->right( )
+                                                                  .get( ) );
 
-                    if( auto val = mod->get( id ) ) {
+                    if( auto val = mod->get( id->sym( ) ) ) {
                         return val;
                     } else {
                         return common::error_type::make( inf->right( )->pos( ),
-                                    "Identifier not found '", id, "'");
+                                    "Identifier not found '", id->str( ), "'");
                     }
 
                 } else if( inf->right( )->get_type( ) == ast::type::CALL ) {
@@ -26,9 +26,11 @@ namespace mico { namespace eval { namespace operations {
             return common::eval_ival_index<object_type>(idx, str, id);
         }
 
+        /// `target` is set for the left side of an assignment
         static
         objects::sptr eval_index( index *idx, objects::sptr obj,
-                                  eval_call ev, environment::sptr env  )
+                                  eval_call ev, environment::sptr env,
+                                  bool target = false )
         {
             common::reference<TN> ref(obj);
             auto str = ref.shared_unref( );
@@ -51,7 +53,7 @@ namespace mico { namespace eval { namespace operations {
             std::int64_t index = common::to_index( id );
 
             if( str->valid_id( index ) ) {
-                return str->at( index );
+                return target ? str->ref_at( index ) : str->at( index );
             } else {
                 return error_type::make(
                             idx->param( )->pos( ), idx->param( ).get( ),
@@ -80,9 +82,10 @@ namespace mico { namespace eval { namespace operations {
 
         static
         objects::sptr eval_index( index *idx, objects::sptr obj,
-                                  eval_call ev, environment::sptr env  )
+                                  eval_call ev, environment::sptr env,
+                                  bool target = false )
         {
-            return parent_type::eval_index( idx, obj, ev, env );
+            return parent_type::eval_index( idx, obj, ev, env, target );
         }
     };
 
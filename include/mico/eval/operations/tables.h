@@ -25,7 +25,7 @@ namespace mico { namespace eval { namespace operations {
             auto tt = ref.unref( );
 
             if( pref->token( ) == tokens::type::ASTERISK ) {
-                return int_type::make( tt->value( ).size( ) );
+                return int_type::make( tt->size( ) );
             }
             return error_type::make( pref->pos( ),   "Prefix operator '",
                                      pref->token( ), "' is not defined for"
@@ -38,31 +38,55 @@ namespace mico { namespace eval { namespace operations {
         {
             auto ltable = objects::cast_table(lft);
             auto rtable = objects::cast_table(rght);
+            return ltable->merge( env.get( ), rtable.get( ) );
+        }
 
-            auto res = ltable->clone( );
-            auto restabe = objects::cast_table(res);
-
-            for( auto &v: rtable->value( ) ) {
-                restabe->insert( env.get( ), v.first, v.second->value( ) );
-            }
-
-            return res;
+        /// a string literal; the key is the same on every pass
+        static
+        bool is_const_key( index *idx )
+        {
+            using str_expr = ast::expressions::string;
+            auto &param( idx->param( ) );
+            return param->get_type( ) == ast::type::STRING
+                && !static_cast<str_expr *>(param.get( ))->is_raw( );
         }
 
+        /// `target` is set for the left side of an assignment
         static
         objects::sptr eval_index( index *idx, objects::sptr obj,
-                                  eval_call ev, environment::sptr env  )
+                                  eval_call ev, environment::sptr env,
+                                  bool target = false )
         {
             common::reference<objects::type::TABLE> ref(obj);
             auto tab = ref.shared_unref( );
 
+            /// `t["x"]` on a record of the shape seen here before
+            auto &site( idx->site( ) );
+            auto shape = target ? nullptr : tab->record_shape( ).get( );
+            if( shape && shape == site.shape.get( ) ) {
+                if( auto res = tab->at_field( site.slot ) ) {
+                    return res;
+                }
+            }
+
             objects::sptr id = ev( idx->param( ).get( ), env );
 
             if( common::is_fail( id ) ) {
                 return id;
             }
 
-            if( auto res = tab->at( id ) ) {
+            if( shape && is_const_key( idx ) ) {
+                auto slot = tab->field_slot( id );
+                if( slot != objects::table::value_type::shape_type::npos ) {
+                    site.shape = tab->record_shape( );
+                    site.slot  = slot;
+                    if( auto res = tab->at_field( slot ) ) {
+                        return res;
+                    }
+                }
+            }
+
+            if( auto res = target ? tab->ref_at( id ) : tab->at( id ) ) {
                 return res;
             }
 
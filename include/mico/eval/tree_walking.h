@@ -10,6 +10,7 @@
 #include "mico/statements.h"
 #include "mico/tokens.h"
 #include "mico/state.h"
+#include "mico/parser.h"
 #include "mico/eval/operations/integer.h"
 #include "mico/eval/operations/boolean.h"
 #include "mico/eval/operations/float.h"
@@ -22,6 +23,7 @@
 #include "mico/eval/operations/slices.h"
 #include "mico/eval/operations/infinite.h"
 #include "mico/eval/operations/character.h"
+#include "mico/eval/operations/matrix.h"
 
 #include "mico/charset/encoding.h"
 
@@ -195,7 +197,7 @@ namespace mico { namespace eval {
         objects::integer::sptr eval_int( ast::node *n )
         {
             auto state = ast::cast<ast::expressions::integer>(n);
-            return std::make_shared<objects::integer>( state->value( ) );
+            return objects::integer::make( state->value( ) );
         }
 
         objects::sptr extract_return( objects::sptr obj )
@@ -211,7 +213,7 @@ namespace mico { namespace eval {
         objects::sptr eval_float( ast::node *n )
         {
             auto state = ast::cast<ast::expressions::floating>(n);
-            return std::make_shared<objects::floating>( state->value( ) );
+            return objects::floating::make( state->value( ) );
         }
 
         objects::sptr eval_string( ast::node *n )
@@ -250,6 +252,7 @@ namespace mico { namespace eval {
             using OP_func  = OP<objects::type::FUNCTION>;
             using OP_inf   = OP<objects::type::INF_OBJ>;
             using OP_char  = OP<objects::type::CHARACTER>;
+            using OP_mat   = OP<objects::type::MATRIX>;
 
             objects::type opertype = oper->get_type( );
             if( opertype == objects::type::REFERENCE ) {
@@ -275,6 +278,8 @@ namespace mico { namespace eval {
                 return OP_array::eval_prefix(expr, oper);
             case objects::type::INF_OBJ:
                 return OP_inf::eval_prefix(expr, oper);
+            case objects::type::MATRIX:
+                return OP_mat::eval_prefix(expr, oper);
             case objects::type::BUILTIN:
             case objects::type::FUNCTION:
                 return OP_func::eval_prefix(expr, oper);
@@ -333,13 +338,23 @@ namespace mico { namespace eval {
         objects::sptr eval_assign( ast::expressions::infix *inf,
                                    environment::sptr env )
         {
-            auto lft = eval_impl_tail( inf->left( ).get( ), env );
+            auto target = inf->left( ).get( );
+            auto lft = target->get_type( ) == ast::type::INDEX
+                     ? eval_index( target, env, true )
+                     : eval_impl_tail( target, env );
             if( lft->get_type( ) == objects::type::REFERENCE ) {
                 auto cont = objects::cast_ref(lft.get( ));
                 auto rght = unref(eval_impl_tail(inf->right( ).get( ),
                                                  env ) );
                 if( is_fail( rght ) ) {
                     return rght;
+                } else if( cont->stale( ) ) {
+                    return error( inf, "Stale left value for ASSIGN ",
+                                  inf->left( ).get( ),
+                                  "; the element was moved or removed" );
+                } else if( !cont->accepts( rght.get( ) ) ) {
+                    return error( inf, "Invalid value ", rght->get_type( ),
+                                  " for ASSIGN ", inf->left( ).get( ) );
                 }
                 cont->set_value(env.get( ), rght->clone( ));
                 return cont->value( );
@@ -394,6 +409,7 @@ namespace mico { namespace eval {
             using OP_mod   = OP<objects::type::MODULE>;
             using OP_inf   = OP<objects::type::INF_OBJ>;
             using OP_char  = OP<objects::type::CHARACTER>;
+            using OP_mat   = OP<objects::type::MATRIX>;
 
             objects::sptr res;
             switch( opertype ) {
@@ -424,6 +440,9 @@ namespace mico { namespace eval {
             case objects::type::INF_OBJ:
                 res = OP_inf::eval_infix( inf, left, inf_call_unref, env);
                 break;
+            case objects::type::MATRIX:
+                res = OP_mat::eval_infix( inf, left, inf_call_unref, env);
+                break;
             case objects::type::MODULE:
                 res = OP_mod::eval_infix( inf, left, func_call, env);
                 break;
@@ -468,17 +487,16 @@ namespace mico { namespace eval {
                         auto v = unref( eval_impl_tail(
                                         call->param_at(id++).get( ), env ) );
 
-                        new_env->set( n->value( ), v );
+                        new_env->set( n->sym( ), v );
 
                     } else if( p->get_type( ) == ast::type::ELIPSIS ) {
                         auto eli = ast::cast<elipsis>( p.get( ) );
 
-                        auto name = std::string( );
+                        static const symbol default_name( "__args" );
+                        auto name = default_name;
                         if( eli->is_ident( ) ) {
                             auto id = ast::cast<ident>( eli->value( ).get( ) );
-                            name = id->value( );
-                        } else {
-                            name = "__args";
+                            name = id->sym( );
                         }
 
                         for( ; id<call->param_list( ).size( ); id++ ) {
@@ -531,8 +549,7 @@ namespace mico { namespace eval {
             if( !new_env ) {
                 return error( call, "Bad parameter for 'call'" );
             }
-            return std::make_shared<objects::tail_call>( fun, std::move(params),
-                                                         new_env );
+            return objects::tail_call::make( fun, std::move(params), new_env );
         }
 
         static
@@ -559,7 +576,7 @@ namespace mico { namespace eval {
                     auto fun = objects::cast_func(call->value( ).get( ));
                     environment::scoped s( call->env( ) );
                     fun->env( )->get_state( ).GC( fun->env( ) );
-                    obj = eval_impl( fun->body( ), call->env( ) );
+                    obj = eval_body( fun, call->env( ) );
                 } else if( call_type == objects::type::BUILTIN ) {
                     auto fun = objects::cast_builtin(call->value( ).get( ));
                     fun->env( )->get_state( ).GC( fun->env( ) );
@@ -582,7 +599,7 @@ namespace mico { namespace eval {
                     auto fun = objects::cast_func(call->value( ).get( ));
                     environment::scoped s( call->env( ) );
                     fun->env( )->get_state( ).GC( fun->env( ) );
-                    obj_src = eval_impl( fun->body( ), call->env( ) );
+                    obj_src = eval_body( fun, call->env( ) );
                 } else if( call_type == objects::type::BUILTIN ) {
                     auto fun = objects::cast_builtin(call->value( ).get( ));
                     obj_src = fun->call( call->params( ), call->env( ) );
@@ -915,7 +932,8 @@ namespace mico { namespace eval {
                 return error(n, "Bad identifier '", expr->ident( )->str( ),
                              "' for let statement");
             }
-            auto id   = expr->ident( )->str( );
+            auto id   = ast::cast<ast::expressions::ident>( expr->ident( ).get( ) )
+                       ->sym( );
             auto val  = eval_impl_tail( expr->value( ).get( ), env );
             if( is_fail( val ) ) {
                 return val;
@@ -998,7 +1016,7 @@ namespace mico { namespace eval {
         {
             auto expr = ast::cast<ast::statements::ret>( n );
             auto val  = eval_impl( expr->value( ), env );
-            return std::make_shared<objects::retutn_obj>(val);
+            return objects::retutn_obj::make( val );
         }
 
         objects::sptr eval_break( ast::node * /*n*/, environment::sptr /*env*/ )
@@ -1021,7 +1039,7 @@ namespace mico { namespace eval {
         {
 
             auto expr = ast::cast<ast::expressions::ident>( n );
-            auto val = env->get( expr->value( ) );
+            auto val = env->get( expr->sym( ) );
             if( !val ) {
                 return error( n, "Identifier not found '", n->str( ), "'" );
             } else {
@@ -1029,6 +1047,21 @@ namespace mico { namespace eval {
             }
         }
 
+        /// the body of a pre-parsed function is parsed on the first call
+        objects::sptr eval_body( objects::function *fun,
+                                 environment::sptr env )
+        {
+            if( !fun->body( ) ) {
+                auto &lazy = *fun->lazy( );
+                if( !parser::parse_lazy( lazy ) ) {
+                    return objects::error::make( lazy.tokens.front( ).where,
+                                                 lazy.errors.front( ) );
+                }
+                fun->set_body( lazy.body );
+            }
+            return eval_impl( fun->body( ), env );
+        }
+
         objects::sptr eval_function( ast::node *n, environment::sptr env )
         {
             auto func = ast::cast<ast::expressions::function>( n );
@@ -1038,8 +1071,13 @@ namespace mico { namespace eval {
             }
             auto fff  = objects::function::make( make_env(env),
                                                  func->params( )->clone_me( ),
-                                                 func->body( )->clone( ),
+                                                 func->is_lazy( )
+                                                 ? nullptr
+                                                 : func->body( )->clone( ),
                                                  init_size );
+            if( func->is_lazy( ) ) {
+                fff->set_lazy( func->lazy( ) );
+            }
 
             for( auto &next: func->inits( ) ) {
                 auto res = unref(eval_impl_tail( next.second.get( ), env ) );
@@ -1051,7 +1089,10 @@ namespace mico { namespace eval {
             return fff;
         }
 
-        objects::sptr eval_index( ast::node *n, environment::sptr env )
+        /// `target` is set for the left side of an assignment:
+        /// the elements of mutable containers come as references
+        objects::sptr eval_index( ast::node *n, environment::sptr env,
+                                  bool target = false )
         {
             auto idx = ast::cast<ast::expressions::index>(n);
 
@@ -1072,22 +1113,29 @@ namespace mico { namespace eval {
             using OP_sslice  = operations::operation<objects::type::SSLICE>;
             using OP_rslice  = operations::operation<objects::type::RSLICE>;
             using OP_aslice  = operations::operation<objects::type::ASLICE>;
+            using OP_matrix  = operations::operation<objects::type::MATRIX>;
 
             switch ( val->get_type( ) ) {
             case objects::type::ARRAY:
-                return OP_array::eval_index( idx, val, idx_call, env );
+                return OP_array::eval_index( idx, val, idx_call, env,
+                                             target );
             case objects::type::STRING:
                 return OP_string::eval_index( idx, val, idx_call, env );
             case objects::type::RSTRING:
                 return OP_rstring::eval_index( idx, val, idx_call, env );
             case objects::type::TABLE:
-                return OP_table::eval_index( idx, val, idx_call, env );
+                return OP_table::eval_index( idx, val, idx_call, env,
+                                             target );
             case objects::type::SSLICE:
                 return OP_sslice::eval_index( idx, val, idx_call, env );
             case objects::type::RSLICE:
                 return OP_rslice::eval_index( idx, val, idx_call, env );
             case objects::type::ASLICE:
-                return OP_aslice::eval_index( idx, val, idx_call, env );
+                return OP_aslice::eval_index( idx, val, idx_call, env,
+                                              target );
+            case objects::type::MATRIX:
+                return OP_matrix::eval_index( idx, val, idx_call, env,
+                                              target );
             }
 
             return objects::error::make( n->pos( ),
@@ -1140,7 +1188,7 @@ namespace mico { namespace eval {
                         if( ptype == ast::type::IDENT ) {
                             auto n = static_cast<ident_type *>(p.get( ));
                             auto v = unref(eval_impl_tail( c.get( ),env ) );
-                            new_env->set(n->value( ), v);
+                            new_env->set(n->sym( ), v);
                         } else {
                             return error(call, "Invalid argument ", i,
                                          p->str( ) );
@@ -1217,7 +1265,7 @@ namespace mico { namespace eval {
                     return get_null( );
                 }
 
-                auto res = eval_impl( vfun->body( ), s.env( ) );
+                auto res = eval_body( vfun, s.env( ) );
                 while( is_return( res ) ) {
                     auto r = objects::cast_return(res.get( ));
                     res = eval_tail( r->value( ) );
@@ -1277,9 +1325,26 @@ namespace mico { namespace eval {
             return res;
         }
 
+        template <typename T>
+        static
+        objects::sptr shared_empty( environment::sptr env )
+        {
+            objects::type tn = T::type_value;
+            auto &st( env->get_state( ) );
+            auto &res( st.shared_empty( tn ) );
+            if( !res ) {
+                res = T::make( st.env( ) );
+            }
+            return res;
+        }
+
         objects::sptr eval_array( ast::node *n, environment::sptr env )
         {
             auto arr = ast::cast<ast::expressions::array>( n );
+            if( arr->value( ).empty( ) ) {
+                return shared_empty<objects::array>( env );
+            }
+
             auto res = objects::array::make( env );
 
             for( auto &a: arr->value( ) ) {
@@ -1296,6 +1361,9 @@ namespace mico { namespace eval {
         objects::sptr eval_table( ast::node *n, environment::sptr env )
         {
             auto table = ast::cast<ast::expressions::table>( n );
+            if( table->value( ).empty( ) ) {
+                return shared_empty<objects::table>( env );
+            }
 
             auto res = objects::table::make( env );
 
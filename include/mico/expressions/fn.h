@@ -3,13 +3,45 @@
 
 #include <sstream>
 #include <map>
+#include <vector>
+#include <string>
 #include "mico/ast.h"
 #include "mico/tokens.h"
+#include "mico/symbols.h"
 #include "mico/expressions/impl.h"
 #include "mico/expressions/list.h"
 
 namespace mico { namespace ast { namespace expressions {
 
+    /// Tokens of a function body that the parser skipped.
+    /// `parser::parse_lazy` turns them into the body once; the result
+    /// (or the errors) is kept here for every later copy of the function
+    struct lazy_body {
+
+        using sptr       = std::shared_ptr<lazy_body>;
+        using token_list = std::vector<tokens::info>;
+        using error_list = std::vector<std::string>;
+        using parse_call = bool (*)( lazy_body & );
+
+        token_list          tokens;     /// the body without `{`, with `}`
+        std::vector<symbol> names;      /// idents used in the body
+        bool                macros = false; /// macro, quote or unquote
+
+        bool                done   = false;
+        ast::node::sptr     body;       /// shared by the function objects
+        error_list          errors;
+        parse_call          parse = nullptr; /// set by the parser
+
+        /// the body, parsed now if it is not yet; empty on errors
+        const ast::node::sptr &parsed( )
+        {
+            if( !done && parse ) {
+                parse( *this );
+            }
+            return body;
+        }
+    };
+
     template <>
     class impl<type::FN>: public typed_expr<type::FN> {
 
@@ -45,6 +77,8 @@ namespace mico { namespace ast { namespace expressions {
             }
             if( body_ ) {
                 oss << body_->str( ) << "\n";
+            } else if( lazy_ && lazy_->parsed( ) ) {
+                oss << lazy_->parsed( )->str( ) << "\n";
             }
             oss << "}";
             return oss.str( );
@@ -85,18 +119,36 @@ namespace mico { namespace ast { namespace expressions {
             params_ = std::move(val);
         }
 
+        /// the body is not parsed yet
+        bool is_lazy( ) const
+        {
+            return !body_ && lazy_;
+        }
+
+        const lazy_body::sptr &lazy( ) const
+        {
+            return lazy_;
+        }
+
+        void set_lazy( lazy_body::sptr val )
+        {
+            lazy_ = std::move(val);
+        }
+
         void mutate( mutator_type call ) override
         {
             for( auto &ini: inits_ ) {
                 ast::node::apply_mutator( ini.second, call );
             }
             list_type::apply_mutator( params_, call );
-            ast::node::apply_mutator( body_,   call );
+            if( body_ ) {
+                ast::node::apply_mutator( body_, call );
+            }
         }
 
         bool is_const( ) const override
         {
-            return body_->is_const( );
+            return body_ && body_->is_const( );
         }
 
         ast::node::uptr clone( ) const override
@@ -107,14 +159,18 @@ namespace mico { namespace ast { namespace expressions {
                                      node::call_clone( ini.second ) );
             }
             res->params_ = params_->clone_me( );
-            res->body_   = ast::node::call_clone( body_ );
+            if( body_ ) {
+                res->body_ = ast::node::call_clone( body_ );
+            }
+            res->lazy_ = lazy_;
             return ast::node::uptr( std::move( res ) );
         }
 
     private:
-        init_map     inits_;
-        params_type  params_;
-        body_type    body_;
+        init_map        inits_;
+        params_type     params_;
+        body_type       body_;
+        lazy_body::sptr lazy_;
     };
 
     using function = impl<type::FN>;
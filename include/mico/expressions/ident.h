@@ -4,6 +4,7 @@
 #include <sstream>
 #include "mico/ast.h"
 #include "mico/tokens.h"
+#include "mico/symbols.h"
 #include "mico/expressions/impl.h"
 
 namespace mico { namespace ast { namespace expressions {
@@ -21,12 +22,21 @@ namespace mico { namespace ast { namespace expressions {
             :value_(val)
         { }
 
+        impl( symbol val )
+            :value_(val)
+        { }
+
         std::string str( ) const override
         {
-            return value_;
+            return value_.name( );
         }
 
         const std::string &value( ) const
+        {
+            return value_.name( );
+        }
+
+        symbol sym( ) const
         {
             return value_;
         }
@@ -42,6 +52,12 @@ namespace mico { namespace ast { namespace expressions {
             return uptr(new this_type( name  ) );
         }
 
+        static
+        uptr make( symbol name )
+        {
+            return uptr(new this_type( name  ) );
+        }
+
         bool is_const( ) const override
         {
             return false;
@@ -53,7 +69,7 @@ namespace mico { namespace ast { namespace expressions {
         }
 
     private:
-        std::string value_;
+        symbol value_;
     };
 
     using ident = impl<type::IDENT>;
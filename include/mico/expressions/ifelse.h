@@ -66,6 +66,11 @@ namespace mico { namespace ast { namespace expressions {
             return general_;
         }
 
+        const if_list &ifs( ) const
+        {
+            return general_;
+        }
+
         expression::uptr &alt( )
         {
             return alt_;
@@ -1,6 +1,7 @@
 #ifndef MICO_EXPRESSION_INDEX_H
 #define MICO_EXPRESSION_INDEX_H
 
+#include <memory>
 #include <sstream>
 #include "mico/ast.h"
 #include "mico/tokens.h"
@@ -15,6 +16,13 @@ namespace mico { namespace ast { namespace expressions {
 
         using uptr = std::unique_ptr<impl>;
 
+        /// inline cache of the evaluator for a constant key: the record
+        /// shape seen here last time and the slot of the key in it
+        struct site_cache {
+            std::shared_ptr<const void> shape;
+            std::size_t                 slot = 0;
+        };
+
         impl( node::uptr left, node::uptr param )
             :left_(std::move(left))
             ,expr_(std::move(param))
@@ -59,6 +67,11 @@ namespace mico { namespace ast { namespace expressions {
             ast::node::apply_mutator( expr_, call );
         }
 
+        site_cache &site( ) const
+        {
+            return site_;
+        }
+
         bool is_const( ) const override
         {
             return left_->is_const( ) && expr_->is_const( );
@@ -75,6 +88,7 @@ namespace mico { namespace ast { namespace expressions {
     private:
         node::uptr left_;
         node::uptr expr_;
+        mutable site_cache site_;
     };
 
     using index = impl<type::INDEX>;
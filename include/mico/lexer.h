@@ -3,93 +3,192 @@
 
 #include <vector>
 #include <map>
+#include <string>
+#include <algorithm>
 #include <sstream>
 
-#include "etool/trees/trie/base.h"
 #include "mico/tokens.h"
 #include "mico/numeric.h"
 #include "mico/idents.h"
+#include "mico/charset/scan.h"
 
 namespace mico {
 
     struct lexer {
 
         using token_type  = tokens::type;
-        using token_trie  = etool::trees::trie::base<char, token_type>;
         using token_ident = tokens::type_ident;
         using token_info  = tokens::info;
         using token_list  = std::vector<token_info>;
         using error_list  = std::vector<std::string>;
 
-        struct state {
+        template <typename ItrT>
+        struct basic_state {
 
             explicit
-            state( std::string::const_iterator b )
+            basic_state( ItrT b )
                 :line_itr(b)
                 ,begin_itr(b)
             { }
             std::size_t line = 1;
-            std::string::const_iterator line_itr;
-            std::string::const_iterator begin_itr;
+            ItrT line_itr;
+            ItrT begin_itr;
         };
 
+        using state = basic_state<std::string::const_iterator>;
+
     //private:
 
-        static
-        void add_token( token_trie &ttrie, std::string value, token_type tt )
-        {
-            ttrie.set( value, tt );
-        }
+        /// Fixed spellings: operators, keywords and literal prefixes.
+        /// Entries are grouped by the first byte, longest first, so the
+        /// first full match is the longest one.
+        class token_table {
 
-        static
-        void add_token( token_trie &ttrie, int tt_int )
-        {
-            auto tt = static_cast<token_type>(tt_int);
-            std::string name = tokens::name::get( tt );
-            add_token( ttrie, name, tt );
-        }
+        public:
 
-        static
-        token_trie make_trie(  )
-        {
-            auto begin = static_cast<int>(tokens::type::FIRST_VISIBLE);
-            const auto end = static_cast<int>(tokens::type::LAST_VISIBLE);
+            template <typename ItrT>
+            struct match {
+
+                explicit operator bool ( ) const
+                {
+                    return found;
+                }
 
-            token_trie res;
-            for( ++begin; begin != end; ++begin ) {
-                add_token( res, begin );
+                const token_type &operator * ( ) const
+                {
+                    return type;
+                }
+
+                ItrT iterator( ) const
+                {
+                    return itr;
+                }
+
+                bool        found = false;
+                token_type  type  = token_type::NONE;
+                ItrT        itr   = ItrT( );
+            };
+
+            static
+            const token_table &instance( )
+            {
+                static const token_table inst;
+                return inst;
             }
 
-            add_token( res, "0b",   tokens::type::INT_BIN );
-            add_token( res, "0B",   tokens::type::INT_BIN );
+            template <typename ItrT>
+            match<ItrT> get( ItrT begin, ItrT end ) const
+            {
+                match<ItrT> res;
+                if( begin == end ) {
+                    return res;
+                }
 
-            add_token( res, "0t",   tokens::type::INT_TER );
-            add_token( res, "0T",   tokens::type::INT_TER );
+                auto first = static_cast<unsigned char>(*begin);
+                ++begin;
+
+                for( auto id = first_[first]; id != first_[first + 1]; ++id ) {
+                    const auto &ent( entries_[id] );
+                    auto cur = begin;
+                    std::size_t pos = 1;
+                    while( (pos < ent.value.size( )) && (cur != end) &&
+                           (ent.value[pos] == *cur) ) {
+                        ++pos;
+                        ++cur;
+                    }
+                    if( pos == ent.value.size( ) ) {
+                        res.found = true;
+                        res.type  = ent.type;
+                        res.itr   = cur;
+                        break;
+                    }
+                }
+                return res;
+            }
 
-            add_token( res, "0x",   tokens::type::INT_HEX );
-            add_token( res, "0X",   tokens::type::INT_HEX );
+        private:
 
-            add_token( res, "0",    tokens::type::INT_OCT );
-            add_token( res, "0o",   tokens::type::INT_OCT );
-            add_token( res, "0O",   tokens::type::INT_OCT );
+            struct entry {
+                std::string value;
+                token_type  type;
+            };
 
-            add_token( res, "\"",   tokens::type::STRING );
-            add_token( res, "r\"",  tokens::type::RSTRING );
-            add_token( res, "R\"",  tokens::type::RSTRING );
-            add_token( res, "'",    tokens::type::CHARACTER );
+            token_table( )
+            {
+                auto begin = static_cast<int>(tokens::type::FIRST_VISIBLE);
+                const auto end = static_cast<int>(tokens::type::LAST_VISIBLE);
 
-            add_token( res, "\n",   tokens::type::END_OF_LINE );
-            add_token( res, "\r\n", tokens::type::END_OF_LINE );
-            add_token( res, "\n\r", tokens::type::END_OF_LINE );
+                for( ++begin; begin != end; ++begin ) {
+                    auto tt = static_cast<token_type>(begin);
+                    add( tokens::name::get( tt ), tt );
+                }
 
-            add_token( res, "//",   tokens::type::COMMENT);
+                add( "0b",   tokens::type::INT_BIN );
+                add( "0B",   tokens::type::INT_BIN );
+
+                add( "0t",   tokens::type::INT_TER );
+                add( "0T",   tokens::type::INT_TER );
+
+                add( "0x",   tokens::type::INT_HEX );
+                add( "0X",   tokens::type::INT_HEX );
+
+                add( "0",    tokens::type::INT_OCT );
+                add( "0o",   tokens::type::INT_OCT );
+                add( "0O",   tokens::type::INT_OCT );
+
+                add( "\"",   tokens::type::STRING );
+                add( "r\"",  tokens::type::RSTRING );
+                add( "R\"",  tokens::type::RSTRING );
+                add( "'",    tokens::type::CHARACTER );
+
+                add( "\n",   tokens::type::END_OF_LINE );
+                add( "\r\n", tokens::type::END_OF_LINE );
+                add( "\n\r", tokens::type::END_OF_LINE );
+
+                add( "//",   tokens::type::COMMENT);
+
+                add( "λ",    tokens::type::FUNCTION );
+                add( "←",    tokens::type::LARROW );
+                add( "→",    tokens::type::RARROW );
+
+                std::stable_sort( entries_.begin( ), entries_.end( ),
+                    []( const entry &l, const entry &r ) {
+                        auto lf = static_cast<unsigned char>(l.value[0]);
+                        auto rf = static_cast<unsigned char>(r.value[0]);
+                        return (lf != rf) ? (lf < rf)
+                                          : (l.value.size( ) > r.value.size( ));
+                    } );
+
+                std::size_t id = 0;
+                for( std::size_t c = 0; c < 256; ++c ) {
+                    first_[c] = id;
+                    while( (id < entries_.size( )) &&
+                           (static_cast<unsigned char>(entries_[id].value[0])
+                                                                      == c ) ) {
+                        ++id;
+                    }
+                }
+                first_[256] = id;
+            }
 
-            add_token( res, "λ",    tokens::type::FUNCTION );
-            add_token( res, "←",    tokens::type::LARROW );
-            add_token( res, "→",    tokens::type::RARROW );
+            /// the last spelling wins as it did in the trie
+            void add( const std::string &value, token_type tt )
+            {
+                if( value.empty( ) ) {
+                    return;
+                }
+                for( auto &e: entries_ ) {
+                    if( e.value == value ) {
+                        e.type = tt;
+                        return;
+                    }
+                }
+                entries_.push_back( entry { value, tt } );
+            }
 
-            return res;
-        }
+            std::vector<entry>  entries_;
+            std::size_t         first_[257];
+        };
 
         template <typename ItrT>
         static ItrT skip_whitespaces( ItrT b, ItrT end )
@@ -107,12 +206,10 @@ namespace mico {
         }
 
         template <typename ItrT>
-        static ItrT skip_comment( ItrT b, ItrT end, state * /*lstate*/  )
+        static ItrT skip_comment( ItrT b, ItrT end,
+                                  basic_state<ItrT> * /*lstate*/  )
         {
-            while( b != end && !idents::is_newline(*b) ) {
-                ++b;
-            }
-            return b;
+            return charset::scan::newline( b, end );
         }
 
         template <typename ItrT>
@@ -134,10 +231,19 @@ namespace mico {
 
         template <typename ItrT>
         static
-        std::string read_string( ItrT &begin, ItrT end, state *lstate, char c )
+        std::string read_string( ItrT &begin, ItrT end,
+                                 basic_state<ItrT> *lstate, char c )
         {
             std::string res;
-            for( ; (begin != end) && (*begin != c); ++begin ) {
+            while( begin != end ) {
+
+                auto stop = charset::scan::string_stop( begin, end, c );
+                res.append( begin, stop );
+                begin = stop;
+
+                if( (begin == end) || (*begin == c) ) {
+                    break;
+                }
 
                 auto next = std::next(begin);
 
@@ -173,16 +279,14 @@ namespace mico {
                             break;
                         }
                     }
-                    begin = next;
-                    if( begin == end ) {
-                        break;
-                    }
+                    begin = std::next(next);
                 } else {
                     if( *begin == '\n') {
                         lstate->line++;
                         lstate->line_itr = next;
                     }
                     res.push_back( *begin );
+                    begin = next;
                 }
             }
 
@@ -197,16 +301,9 @@ namespace mico {
         static
         std::string read_ident( ItrT &begin, ItrT end )
         {
-            std::string res;
-
-            for( ; begin != end; ++begin ) {
-                if( idents::is_ident( *begin ) ) {
-                    res.push_back( *begin );
-                } else {
-                    break;
-                }
-            }
-
+            auto stop = charset::scan::ident_end( begin, end );
+            std::string res( begin, stop );
+            begin = stop;
             return res;
         }
 
@@ -259,8 +356,7 @@ namespace mico {
         template <typename ItrT>
         static
         std::pair<token_ident, ItrT> next_noken( ItrT begin, ItrT end,
-                                                 token_trie  &ttrie,
-                                                 state *lstate )
+                                                 basic_state<ItrT> *lstate )
         {
             using I = token_ident;
 
@@ -268,7 +364,7 @@ namespace mico {
 
                 auto bb   = begin;
                 token_ident value;
-                auto next = ttrie.get(begin, end, true);
+                auto next = token_table::instance( ).get( begin, end );
 
                 value.name = token_type::NONE;
                 int ffound = 0;
@@ -331,6 +427,7 @@ namespace mico {
                     case token_type::IDENT:
                         value.name    = token_type::IDENT;
                         value.literal = read_ident( bb, end  );
+                        value.sym     = symbol( value.literal );
                         return std::make_pair( std::move(value), bb );
                     case token_type::STRING:
                     case token_type::RSTRING:
@@ -360,6 +457,7 @@ namespace mico {
                     //// TODO: fix COPY-PASTE ...
                     value.name    = token_type::IDENT;
                     value.literal = read_ident( bb, end  );
+                    value.sym     = symbol( value.literal );
                     return std::make_pair( std::move(value), bb );
                 } else {
                     return std::make_pair( I(token_type::NONE), begin );
@@ -370,67 +468,112 @@ namespace mico {
         }
 
         template <typename ItrT>
-        void push_error( const state &st, ItrT cur )
+        static
+        std::string make_error( const basic_state<ItrT> &st, ItrT cur )
         {
             std::ostringstream oss;
             oss << st.line << ":" << std::distance(st.line_itr, cur)
                 << " Unexpected symbol '" << *cur << "'";
-
-            errors_.emplace_back( oss.str( ) );
+            return oss.str( );
         }
 
     public:
 
-        static
-        lexer make( const std::string &input )
-        {
-            auto ttrie = make_trie( );
-
-            state lex_state(input.begin( ));
-            lexer res;
+        /// Pulls tokens one by one from [begin, end); the input is not
+        /// copied, but every token keeps its own copy of its literal
+        template <typename ItrT>
+        class stream {
 
-            auto b = input.begin( );
+        public:
 
-            b = skip_whitespaces( b, input.end( ) );
+            stream( ItrT begin, ItrT end )
+                :state_(begin)
+                ,cur_(skip_whitespaces( begin, end ))
+                ,end_(end)
+            { }
 
-            while( b != input.end( ) ) {
+            bool next( token_info &ti )
+            {
+                while( !done_ && (cur_ != end_) ) {
 
-                auto bb = b;
-                token_info ti;
-                auto line_start = lex_state.line_itr;
-                auto current_line = lex_state.line;
+                    auto bb = cur_;
+                    auto line_start = state_.line_itr;
+                    auto current_line = state_.line;
 
-                auto nt = next_noken( b, input.end( ), ttrie, &lex_state );
+                    auto nt = next_noken( cur_, end_, &state_ );
 
-                if( nt.first.name == token_type::END_OF_FILE ) {
-                    break;
-                } else if( nt.first.name == token_type::END_OF_LINE ) {
-                    // do nothing yet
-                } else if ( nt.first.name == token_type::COMMENT ) {
-                    /// do nothing
-                } else if( nt.first.name == token_type::NONE ) {
-                    res.push_error( lex_state, b );
-                    nt.second++;
-                } else {
+                    if( nt.first.name == token_type::END_OF_FILE ) {
+                        break;
+                    }
 
-                    ti.ident      = std::move(nt.first);
-                    ti.where.line = current_line;
-                    ti.where.pos  = std::distance( line_start, bb );
+                    bool ready = false;
+                    if( nt.first.name == token_type::END_OF_LINE ) {
+                        // do nothing yet
+                    } else if ( nt.first.name == token_type::COMMENT ) {
+                        /// do nothing
+                    } else if( nt.first.name == token_type::NONE ) {
+                        errors_.emplace_back( make_error( state_, cur_ ) );
+                        nt.second++;
+                    } else {
+                        ti.ident      = std::move(nt.first);
+                        ti.where.line = current_line;
+                        ti.where.pos  = std::distance( line_start, bb );
+                        ready = true;
+                    }
+                    cur_ = skip_whitespaces( nt.second, end_ );
+                    if( ready ) {
+                        return true;
+                    }
+                }
 
-                    res.tokens_.emplace_back(std::move(ti));
+                if( done_ ) {
+                    return false;
                 }
-                b = skip_whitespaces( nt.second, input.end( ) );
+
+                done_ = true;
+                ti.ident      = token_ident(token_type::END_OF_FILE);
+                ti.where.line = state_.line;
+                ti.where.pos  = std::distance( state_.line_itr, cur_ );
+                return true;
             }
 
-            token_info ti;
-            ti.ident      = token_ident(token_type::END_OF_FILE);
-            ti.where.line = lex_state.line;
-            ti.where.pos  = std::distance( lex_state.line_itr, b );
-            res.tokens_.emplace_back(std::move(ti));
+            const error_list &errors( ) const
+            {
+                return errors_;
+            }
+
+        private:
+            basic_state<ItrT>   state_;
+            ItrT                cur_;
+            ItrT                end_;
+            error_list          errors_;
+            bool                done_ = false;
+        };
 
+        static
+        lexer make( const std::string &input )
+        {
+            stream<std::string::const_iterator> stm( input.begin( ),
+                                                     input.end( ) );
+            lexer res;
+            token_info ti;
+            while( stm.next( ti ) ) {
+                res.tokens_.emplace_back( std::move(ti) );
+            }
+            res.errors_ = stm.errors( );
             return res;
         }
 
+        token_list::iterator begin( )
+        {
+            return tokens_.begin( );
+        }
+
+        token_list::iterator end( )
+        {
+            return tokens_.end( );
+        }
+
         token_list::const_iterator begin( ) const
         {
             return tokens_.begin( );
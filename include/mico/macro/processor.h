@@ -6,11 +6,18 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
 
 #include "mico/ast.h"
 #include "mico/objects/base.h"
 #include "mico/expressions.h"
 #include "mico/statements.h"
+#include "mico/symbols.h"
+#include "mico/parser.h"
+#include "mico/ast/cache.h"
 
 namespace mico { namespace macro {
 
@@ -50,6 +57,37 @@ namespace mico { namespace macro {
 
         };
 
+        /// A macro body ready for calls. It is made on the first call:
+        /// the body is copied with expression statements already unwrapped,
+        /// and every place where a parameter is used is kept as a path of
+        /// child numbers (in `mutate` order). A call is then one clone and
+        /// a few replacements instead of a walk with a scope of quotes
+        struct plan {
+
+            using uptr = std::unique_ptr<plan>;
+            using path = std::vector<std::uint32_t>;
+
+            struct slot {
+                path        where;
+                std::size_t param;
+            };
+
+            ast::node::uptr     body;
+            std::vector<symbol> params;
+            std::vector<slot>   slots;
+
+            /// other names of the body; if none of them is a macro at the
+            /// call site, the expansion is just the substitution
+            std::vector<symbol> names;
+
+            /// the body defines macros itself; calls take the slow way
+            bool                generic = false;
+
+            /// expansions that are only the substitution, by the shape
+            /// of the arguments
+            std::unordered_map<std::string, ast::node::uptr> memo;
+        };
+
         struct scope {
 
             scope( ) = default;
@@ -59,31 +97,71 @@ namespace mico { namespace macro {
                 :parent_(p)
             { }
 
-            using value_map     = std::map<std::string, ast::node::uptr>;
-            using built_in_map  = std::map<std::string, built_in_macro::uptr>;
-            using remap_set     = std::set<std::string>;
+            scope( const scope & ) = delete;
+            scope &operator = ( const scope & ) = delete;
+
+            using value_map     = std::map<symbol, ast::node::uptr>;
+            using plan_map      = std::map<symbol, plan::uptr>;
+            using built_in_map  = std::map<symbol, built_in_macro::uptr>;
+            using remap_set     = std::set<symbol>;
+            using memo_map      = std::unordered_map<std::string,
+                                                     ast::node::uptr>;
 
             scope *parent( )
             {
                 return parent_;
             }
 
-            void set( std::string name, ast::node::uptr value )
+            /// Expansions made here that looked up other macros.
+            /// Parents of a scope do not change while it lives (the walk
+            /// is inside of it), so they stay right until this scope
+            /// changes itself
+            memo_map &memo( )
+            {
+                return memo_;
+            }
+
+            void set( symbol name, ast::node::uptr value )
             {
                 values_[name] = std::move(value);
+                plans_.erase( name );
+                memo_.clear( );
             }
 
-            void set_built( std::string name, built_in_macro::uptr value )
+            void set_built( symbol name, built_in_macro::uptr value )
             {
                 built_in_[name] = std::move(value);
+                memo_.clear( );
             }
 
-            void deny( std::string name )
+            void deny( symbol name )
             {
                 remaped_.insert(name);
+                memo_.clear( );
+            }
+
+            /// the scope where `name` is set
+            scope *owner( symbol name )
+            {
+                scope *cur = this;
+                while( cur ) {
+                    if( remaped_.find( name ) != remaped_.end( ) ) {
+                        return nullptr;
+                    }
+                    if( cur->values_.find( name ) != cur->values_.end( ) ) {
+                        return cur;
+                    }
+                    cur = cur->parent( );
+                }
+                return nullptr;
+            }
+
+            plan::uptr &plan_of( symbol name )
+            {
+                return plans_[name];
             }
 
-            built_in_macro *get_built( const std::string &name )
+            built_in_macro *get_built( symbol name )
             {
                 scope *cur = this;
                 while( cur ) {
@@ -100,7 +178,7 @@ namespace mico { namespace macro {
                 return nullptr;
             }
 
-            ast::node *get( const std::string &name )
+            ast::node *get( symbol name )
             {
                 scope *cur = this;
                 while( cur ) {
@@ -131,8 +209,10 @@ namespace mico { namespace macro {
 
             scope *parent_ = nullptr;
             value_map      values_;
+            plan_map       plans_;
             built_in_map   built_in_;
             remap_set      remaped_;
+            memo_map       memo_;
         };
 
         static
@@ -156,160 +236,575 @@ namespace mico { namespace macro {
             return lst;
         }
 
+        /// A pre-parsed body is parsed here only if some macro can touch it;
+        /// otherwise it stays as tokens
         static
-        ast::node::uptr apply_statement_expr( ast::node *n, scope *s,
-                                              error_list *e, eval_call ec )
+        void parse_lazy( ast::expressions::function *fn, scope *s,
+                         error_list *e )
         {
-            auto stm = ast::cast<ast::statements::expr>( n );
-            auto mut = macro_mutator( stm->value( ).get( ), s, e, ec );
-            return mut ? std::move(mut) : std::move(stm->value( ));
+            auto &lazy = *fn->lazy( );
+            bool need = false;
+            for( auto it = lazy.names.begin( );
+                 !need && it != lazy.names.end( ); ++it ) {
+                need = s->get( *it ) || s->get_built( *it );
+            }
+            if( !need ) {
+                return;
+            }
+            if( parser::parse_lazy( lazy ) ) {
+                fn->set_body( lazy.body->clone( ) );
+            } else {
+                e->insert( e->end( ), lazy.errors.begin( ),
+                           lazy.errors.end( ) );
+            }
+        }
+
+        static
+        ast::node *child_at( ast::node *n, std::uint32_t id )
+        {
+            ast::node *res = nullptr;
+            std::uint32_t cur = 0;
+            n->mutate( [&]( ast::node *c ) -> ast::node::uptr {
+                if( cur++ == id ) {
+                    res = c;
+                }
+                return nullptr;
+            } );
+            return res;
+        }
+
+        static
+        void replace_at( ast::node *root, const plan::path &where,
+                         ast::node::uptr val )
+        {
+            for( std::size_t i = 0; i + 1 < where.size( ); ++i ) {
+                root = child_at( root, where[i] );
+            }
+            std::uint32_t cur = 0;
+            root->mutate( [&]( ast::node * ) -> ast::node::uptr {
+                return (cur++ == where.back( )) ? std::move(val) : nullptr;
+            } );
+        }
+
+        /// Walks the body the same way the expansion does and writes down
+        /// what it would find there
+        static
+        ast::node::uptr compile_node( ast::node *n, plan::path &where,
+                                      plan &pl )
+        {
+            using     AT  = ast::type;
+            namespace AST = ast::statements;
+            namespace AEX = ast::expressions;
+
+            if( !n ) {
+                return nullptr;
+            }
+
+            switch( n->get_type( ) ) {
+            case AT::LET:
+                if( ast::cast<AST::let>( n )->value( )->get_type( )
+                    == AT::MACRO ) {
+                    pl.generic = true;
+                    return nullptr;
+                }
+                break;
+            case AT::MACRO:
+            case AT::BUILTIN_MACRO:
+                pl.generic = true;
+                return nullptr;
+            case AT::EXPR: {
+                auto stm = ast::cast<AST::expr>( n );
+                ast::node::uptr val = std::move(stm->value( ));
+                if( auto res = compile_node( val.get( ), where, pl ) ) {
+                    val = std::move(res);
+                }
+                return val;
+            }
+            case AT::IDENT: {
+                auto name = ast::cast<AEX::ident>( n )->sym( );
+                /// the last parameter with the name wins, as in a scope
+                for( auto i = pl.params.size( ); i > 0; --i ) {
+                    if( pl.params[i - 1] == name ) {
+                        pl.slots.push_back( plan::slot { where, i - 1 } );
+                        return nullptr;
+                    }
+                }
+                pl.names.push_back( name );
+                return nullptr;
+            }
+            case AT::QUOTE:
+                return nullptr;
+            case AT::FN: {
+                auto fn = ast::cast<AEX::function>( n );
+                if( !fn->is_lazy( ) ) {
+                    break;
+                }
+                auto &lazy = *fn->lazy( );
+                bool need = false;
+                for( auto &p: pl.params ) {
+                    need = need || std::binary_search( lazy.names.begin( ),
+                                                       lazy.names.end( ), p );
+                }
+                if( !need ) {
+                    pl.names.insert( pl.names.end( ), lazy.names.begin( ),
+                                     lazy.names.end( ) );
+                } else if( parser::parse_lazy( lazy ) ) {
+                    fn->set_body( lazy.body->clone( ) );
+                } else {
+                    /// the errors have to show up on every call
+                    pl.generic = true;
+                    return nullptr;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+
+            std::uint32_t id = 0;
+            n->mutate( [&]( ast::node *c ) {
+                where.push_back( id++ );
+                auto res = compile_node( c, where, pl );
+                where.pop_back( );
+                return res;
+            } );
+            return nullptr;
         }
 
+        /// Names bound by a macro body: `let`, parameters of functions
+        /// and idents of `for`. Function bodies are parsed to see them.
+        /// Quotes, macros and modules are not looked into
         static
-        ast::node::uptr apply_macro( ast::node *n, scope *s,
-                                     error_list *e, eval_call ec )
+        void find_bindings( ast::node *n, std::set<symbol> &res )
         {
             using     AT  = ast::type;
             namespace AST = ast::statements;
             namespace AEX = ast::expressions;
 
-            auto cn = ast::cast<AEX::call>( n );
-            auto mut = [s, e, ec](ast::node *n) {
-                return processor::macro_mutator( n, s, e, ec );
+            auto add = [&res]( const ast::node *id ) {
+                if( id && id->get_type( ) == AT::ELIPSIS ) {
+                    id = static_cast<const AEX::elipsis *>(id)->value( ).get( );
+                }
+                if( id && id->get_type( ) == AT::IDENT ) {
+                    res.insert( static_cast<const AEX::ident *>(id)->sym( ) );
+                }
             };
 
-            ast::node::apply_mutator( cn->func( ), mut );
-            cn->params( )->mutate( mut );
+            switch( n->get_type( ) ) {
+            case AT::QUOTE:
+            case AT::MACRO:
+            case AT::BUILTIN_MACRO:
+            case AT::MODULE:
+                return;
+            case AT::LET:
+                add( ast::cast<AST::let>( n )->ident( ).get( ) );
+                break;
+            case AT::FN: {
+                auto fn = ast::cast<AEX::function>( n );
+                if( fn->is_lazy( ) && parser::parse_lazy( *fn->lazy( ) ) ) {
+                    fn->set_body( fn->lazy( )->body->clone( ) );
+                }
+                for( auto &p: fn->params( )->value( ) ) {
+                    add( p.get( ) );
+                }
+                break;
+            }
+            case AT::FORIN:
+                for( auto &i: ast::cast<AEX::forin>( n )->idents( )
+                                                       ->value( ) ) {
+                    add( i.get( ) );
+                }
+                break;
+            default:
+                break;
+            }
+            n->mutate( [&res]( ast::node *c ) -> ast::node::uptr {
+                if( c ) {
+                    find_bindings( c, res );
+                }
+                return nullptr;
+            } );
+        }
+
+        /// replaces the idents of `names`; the right side of `.` is
+        /// a name in a module and stays as it is
+        static
+        ast::node::uptr rename( ast::node *n,
+                                const std::map<symbol, symbol> &names )
+        {
+            using     AT  = ast::type;
+            namespace AEX = ast::expressions;
+
+            if( !n ) {
+                return nullptr;
+            }
+            auto mut = [&names]( ast::node *c ) { return rename( c, names ); };
+            switch( n->get_type( ) ) {
+            case AT::QUOTE:
+            case AT::MACRO:
+            case AT::BUILTIN_MACRO:
+            case AT::MODULE:
+                return nullptr;
+            case AT::IDENT: {
+                auto f = names.find( ast::cast<AEX::ident>( n )->sym( ) );
+                if( f == names.end( ) ) {
+                    return nullptr;
+                }
+                ast::node::uptr res(new AEX::ident( f->second ));
+                res->set_pos( n->pos( ) );
+                return res;
+            }
+            case AT::INFIX: {
+                auto inf = ast::cast<AEX::infix>( n );
+                if( inf->token( ) == tokens::type::DOT ) {
+                    ast::node::apply_mutator( inf->left( ), mut );
+                    return nullptr;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+            n->mutate( mut );
+            return nullptr;
+        }
+
+        /// Hygiene: names bound by the body of `m` get a suffix that
+        /// cannot be written in a script, so they neither capture nor hide
+        /// the names of the arguments. The suffix is the place of the
+        /// macro, the same for all its expansions. Parameters keep
+        /// their names; they are replaced by the arguments
+        static
+        void rename_bindings( ast::node *body,
+                              const ast::expressions::macro *m,
+                              const std::vector<symbol> &params )
+        {
+            std::set<symbol> bound;
+            find_bindings( body, bound );
+            for( auto &p: params ) {
+                bound.erase( p );
+            }
+            if( bound.empty( ) ) {
+                return;
+            }
+            std::ostringstream suffix;
+            suffix << "#" << m->pos( ).line << ":" << m->pos( ).pos;
+            std::map<symbol, symbol> names;
+            for( auto &b: bound ) {
+                names.emplace( b, symbol( b.name( ) + suffix.str( ) ) );
+            }
+            body->mutate( [&names]( ast::node *c ) {
+                return rename( c, names );
+            } );
+        }
 
-            if( cn->func( )->get_type( ) == AT::MACRO ) {
+        static
+        plan::uptr compile( const ast::expressions::macro *m )
+        {
+            plan::uptr res(new plan);
+            for( auto &p: m->params( )->value( ) ) {
+                if( p->get_type( ) == ast::type::IDENT ) {
+                    res->params.push_back(
+                        ast::cast<ast::expressions::ident>( p.get( ) )->sym( ));
+                }
+            }
+            res->body = m->body( )->clone( );
+            rename_bindings( res->body.get( ), m, res->params );
+            plan::path where;
+            std::uint32_t id = 0;
+            res->body->mutate( [&]( ast::node *c ) {
+                where.push_back( id++ );
+                auto r = compile_node( c, where, *res );
+                where.pop_back( );
+                return r;
+            } );
+            std::sort( res->names.begin( ), res->names.end( ) );
+            res->names.erase( std::unique( res->names.begin( ),
+                                           res->names.end( ) ),
+                              res->names.end( ) );
+            return res;
+        }
 
-                scope mscope( s );
-                auto mfunc       = ast::cast<AEX::macro>(cn->func( ).get( ));
-                auto param_count = cn->param_list( ).size( );
-                std::size_t id   = 0;
+        /// Expands macros in a tree; one for every scope of the walk
+        class expander {
 
-                for( auto &p: mfunc->params( )->value( ) ) {
-                    if( p->get_type( ) == AT::IDENT ) {
-                        if( id < param_count ) {
+        public:
 
-                            auto &val(cn->param_list( )[id++]);
-                            ast::node::apply_mutator( val, mut );
+            expander( scope *s, error_list *e, const eval_call &ec )
+                :s_(s)
+                ,e_(e)
+                ,ec_(ec)
+            { }
+
+            ast::node::uptr operator ( )( ast::node *n )
+            {
+                using     AT  = ast::type;
+                namespace AST = ast::statements;
+                namespace AEX = ast::expressions;
 
-//                            mscope.set( p->str( ), QT::make( std::move(val) ) );
+                if( !n ) {
+                    return nullptr;
+                }
 
-//                            mscope.set( p->str( ), std::move(val) );
-//                            mscope.set( p->str( ),
-//                                   AEX::quote::make( std::move(val) ) );
+                if( n->get_type( ) == AT::LET ) {
+                    auto ln = ast::cast<AST::let>( n );
+                    if( ln->value( )->get_type( ) == AT::MACRO ) {
+                        auto &lid( ln->ident( ) );
+                        auto name = (lid->get_type( ) == AT::IDENT)
+                                  ? ast::cast<AEX::ident>( lid.get( ) )->sym( )
+                                  : symbol( lid->str( ) );
+                        s_->set( name, std::move( ln->value( ) ) );
+                        return AEX::null::make( );
+                    }
 
-                            /// hm...
-                            if( val->get_type( ) != AT::QUOTE ) {
-                                mscope.set( p->str( ),
-                                       AEX::quote::make( std::move(val) ) );
-                            } else {
-                                mscope.set( p->str( ), std::move(val) );
-                            }
-                        } else {
-                            /// what about error?
-                            mscope.set( p->str( ), AEX::null::make( ) );
-                            e->emplace_back( error_param_size(n) );
+                } else if( n->get_type( ) == AT::CALL ) {
+                    if( auto res = apply_macro( n ) ) {
+                        return res;
+                    }
+                    return nullptr;
+                } else if( n->get_type( ) == AT::LIST ) {
+                    auto ln = ast::cast<AEX::list>( n );
+                    if( ln->get_role( ) == AEX::list::role::LIST_SCOPE ) {
+                        scope sscope(s_);
+                        expander sub( &sscope, e_, ec_ );
+                        sub.visit( ln );
+                        built_calls_ += sub.built_calls_;
+                    }
+                } else if( n->get_type( ) == AT::EXPR ) {
+                    auto stm = ast::cast<AST::expr>( n );
+                    auto mut = (*this)( stm->value( ).get( ) );
+                    return mut ? std::move(mut) : std::move(stm->value( ));
+                } else if( n->get_type( ) == AT::IDENT ) {
+                    auto in = ast::cast<AEX::ident>( n );
+
+                    if( auto val = s_->get( in->sym( ) ) ) {
+                        return val->clone( );
+                    }
+
+                    /// built in macroses have less priority
+                    if( auto val = s_->get_built( in->sym( ) ) ) {
+                        return val->clone( );
+                    }
+
+                } else if( n->get_type( ) == AT::QUOTE ) { // ignore quotes
+                    return nullptr;
+                } else if( n->get_type( ) == AT::FN ) {
+                    auto fn = ast::cast<AEX::function>( n );
+                    if( fn->is_lazy( ) ) {
+                        parse_lazy( fn, s_, e_ );
+                    }
+                }
+
+                visit( n );
+                return nullptr;
+            }
+
+            void visit( ast::node *n )
+            {
+                n->mutate( mutator( ) );
+            }
+
+            ast::node::mutator_type mutator( )
+            {
+                return [this]( ast::node *c ) { return (*this)( c ); };
+            }
+
+        private:
+
+            ast::node::uptr apply_macro( ast::node *n )
+            {
+                using     AT  = ast::type;
+                namespace AEX = ast::expressions;
+
+                auto cn = ast::cast<AEX::call>( n );
+
+                /// a named macro is used right from its scope
+                if( cn->func( )->get_type( ) == AT::IDENT ) {
+                    auto name = ast::cast<AEX::ident>( cn->func( ).get( ) )
+                                ->sym( );
+                    auto owner = s_->owner( name );
+                    if( owner && owner->get( name )->get_type( )
+                                 == AT::MACRO ) {
+                        visit_params( cn );
+                        return expand( n, owner, name );
+                    }
+                    if( !owner ) {
+                        if( auto mfunc = s_->get_built( name ) ) {
+                            visit_params( cn );
+                            return call_built( n, mfunc );
                         }
                     }
                 }
 
-                auto new_body = mfunc->body( )->clone( );
-                new_body->mutate( [&mscope, e, ec]( ast::node *n ) {
-                    return processor::macro_mutator( n, &mscope, e, ec );
-                } );
+                ast::node::apply_mutator( cn->func( ), mutator( ) );
+                visit_params( cn );
 
-                new_body = unlist(std::move(new_body));
+                if( cn->func( )->get_type( ) == AT::MACRO ) {
+                    return expand_generic( n,
+                            ast::cast<AEX::macro>(cn->func( ).get( )) );
+                } else if( cn->func( )->get_type( ) == AT::BUILTIN_MACRO ) {
+                    return call_built( n,
+                            ast::cast<built_in_macro>(cn->func( ).get( )) );
+                }
 
-                //std::cout << new_body->str( ) << "\n";
+                return nullptr;
+            }
 
-                return new_body;
+            void visit_params( ast::expressions::call *cn )
+            {
+                auto mut = mutator( );
+                for( auto &p: cn->param_list( ) ) {
+                    ast::node::apply_mutator( p, mut );
+                }
+            }
 
-            } else if( cn->func( )->get_type( ) == AT::BUILTIN_MACRO ) {
-                scope mscope( s );
-                auto mfunc = ast::cast<built_in_macro>(cn->func( ).get( ));
+            ast::node::uptr call_built( ast::node *n, built_in_macro *mfunc )
+            {
+                auto cn = ast::cast<ast::expressions::call>( n );
+                scope mscope( s_ );
                 ast::node_list params;
                 for( auto &param: cn->param_list( ) ) {
                     params.emplace_back( std::move(param) );
                 }
-                return mfunc->call( n, &mscope, params, e );
+                ++built_calls_;
+                return mfunc->call( n, &mscope, params, e_ );
             }
 
-            return nullptr;
-        }
-
-        static
-        ast::node::uptr macro_mutator( ast::node *n, scope *s,
-                                       error_list *e, eval_call ec )
-        {
-            using     AT  = ast::type;
-            namespace AST = ast::statements;
-            namespace AEX = ast::expressions;
-
-            if( !n ) {
-                return nullptr;
+            /// values of the parameters: quoted arguments or nulls
+            ast::node_list take_params( ast::node *n,
+                                        const std::vector<symbol> &params )
+            {
+                namespace AEX = ast::expressions;
+                auto cn = ast::cast<AEX::call>( n );
+                auto &args( cn->param_list( ) );
+                ast::node_list res;
+                for( std::size_t id = 0; id < params.size( ); ++id ) {
+                    if( id < args.size( ) ) {
+                        auto &val( args[id] );
+                        if( val->get_type( ) != ast::type::QUOTE ) {
+                            res.emplace_back(
+                                AEX::quote::make( std::move(val) ) );
+                        } else {
+                            res.emplace_back( std::move(val) );
+                        }
+                    } else {
+                        /// what about error?
+                        res.emplace_back( AEX::null::make( ) );
+                        e_->emplace_back( error_param_size(n) );
+                    }
+                }
+                return res;
             }
 
-            auto me = [s, e, ec]( ast::node *n ) {
-                return macro_mutator( n, s, e, ec );
-            };
+            ast::node::uptr expand( ast::node *n, scope *owner, symbol name )
+            {
+                auto mfunc = ast::cast<ast::expressions::macro>(
+                                                        owner->get( name ) );
+                auto &pl( owner->plan_of( name ) );
+                if( !pl ) {
+                    pl = compile( mfunc );
+                }
+                if( pl->generic ) {
+                    return expand_generic( n, mfunc );
+                }
 
-            if( n->get_type( ) == AT::LET ) {
-                auto ln = ast::cast<AST::let>( n );
-                if( ln->value( )->get_type( ) == AT::MACRO ) {
-                    s->set( ln->ident( )->str( ), std::move( ln->value( ) ) );
-                    return AEX::null::make( );
-                } else {
-                    //s->deny( ln->ident( )->str( ) );
+                auto errors = e_->size( );
+                auto values = take_params( n, pl->params );
+
+                bool pure = true;
+                for( auto it = pl->names.begin( );
+                     pure && it != pl->names.end( ); ++it ) {
+                    pure = !s_->get( *it ) && !s_->get_built( *it );
                 }
 
-            } else if( n->get_type( ) == AT::CALL ) {
-                if( auto res = apply_macro( n, s, e, ec ) ) {
-                    return res;
+                /// the same arguments give the same tree; a substitution
+                /// depends on nothing else, other expansions depend on
+                /// the macros seen from this scope
+                auto &memo( pure ? pl->memo : s_->memo( ) );
+                ast::cache::writer key(false);
+                if( !pure ) {
+                    key.put_uint( reinterpret_cast<std::uintptr_t>(
+                                                            pl.get( ) ) );
                 }
-            } else if( n->get_type( ) == AT::LIST ) {
-                auto ln = ast::cast<AEX::list>( n );
-                if( ln->get_role( ) == AEX::list::role::LIST_SCOPE ) {
-                    scope sscope(s);
-                    ln->mutate( [&sscope, e, ec]( ast::node *n ) {
-                        return processor::macro_mutator( n, &sscope, e, ec );
-                    } );
+                bool keyed = true;
+                for( auto it = values.begin( );
+                     keyed && it != values.end( ); ++it ) {
+                    keyed = key.put( it->get( ) );
+                }
+                if( keyed ) {
+                    auto f = memo.find( key.data( ) );
+                    if( f != memo.end( ) ) {
+                        return f->second->clone( );
+                    }
                 }
-            } else if( n->get_type( ) == AT::EXPR ) {
-                return apply_statement_expr( n, s, e, ec );
-            } else if( n->get_type( ) == AT::IDENT ) {
-                auto in = ast::cast<AEX::ident>( n );
 
-                if( auto val = s->get( in->value( ) ) ) {
-                    return val->clone( );
+                auto res = pl->body->clone( );
+                for( auto &sl: pl->slots ) {
+                    replace_at( res.get( ), sl.where,
+                                values[sl.param]->clone( ) );
                 }
 
-                /// built in macroses have less priority
-                if( auto val = s->get_built( in->value( ) ) ) {
-                    return val->clone( );
+                auto built_calls = built_calls_;
+                if( !pure ) {
+                    /// macros called from the body see the parameters
+                    scope mscope( s_ );
+                    for( std::size_t i = 0; i < pl->params.size( ); ++i ) {
+                        mscope.set( pl->params[i], std::move(values[i]) );
+                    }
+                    expander sub( &mscope, e_, ec_ );
+                    sub.visit( res.get( ) );
+                    built_calls_ += sub.built_calls_;
                 }
+                res = unlist( std::move(res) );
 
-            } else if( n->get_type( ) == AT::QUOTE ) { // ignore quotes
-                return nullptr;
+                /// built in macroses may look at the environment
+                if( keyed && errors == e_->size( )
+                          && built_calls == built_calls_ ) {
+                    memo.emplace( key.data( ), res->clone( ) );
+                }
+                return res;
             }
-//            else if( n->get_type( ) == AT::UNQUOTE ) {
-//                auto quo = ast::cast<ast::expressions::unquote>(n);
 
-//                quo->value( )->mutate( me );
-//                auto mut = macro_mutator(quo->value( ).get( ), s, e, ec);
-//                return mut ? std::move(mut) : std::move(quo->value( ));
+            /// a macro that is not in a scope: a literal
+            /// or a body that defines macros
+            ast::node::uptr expand_generic( ast::node *n,
+                                            ast::expressions::macro *mfunc )
+            {
+                using AT = ast::type;
+                scope mscope( s_ );
+                std::vector<symbol> params;
+                for( auto &p: mfunc->params( )->value( ) ) {
+                    if( p->get_type( ) == AT::IDENT ) {
+                        params.push_back( ast::cast<ast::expressions::ident>(
+                                                        p.get( ) )->sym( ) );
+                    }
+                }
+                auto values = take_params( n, params );
+                for( std::size_t i = 0; i < params.size( ); ++i ) {
+                    mscope.set( params[i], std::move(values[i]) );
+                }
 
-////                auto re = ec( n );
-////                if( re->get_type( ) != objects::type::FAILURE ) {
-////                    return re->to_ast( n->pos( ) );
-////                }
-//            }
+                auto new_body = mfunc->body( )->clone( );
+                rename_bindings( new_body.get( ), mfunc, params );
+                expander sub( &mscope, e_, ec_ );
+                sub.visit( new_body.get( ) );
+                built_calls_ += sub.built_calls_;
 
-            n->mutate( me );
+                return unlist(std::move(new_body));
+            }
 
-            return nullptr;
+            scope            *s_;
+            error_list       *e_;
+            const eval_call  &ec_;
+            std::size_t       built_calls_ = 0;
+        };
+
+        static
+        ast::node::uptr macro_mutator( ast::node *n, scope *s,
+                                       error_list *e, eval_call ec )
+        {
+            expander ex( s, e, ec );
+            return ex( n );
         }
 
         static
@@ -323,9 +818,8 @@ namespace mico { namespace macro {
         void process( scope *s, ast::node *node,
                       error_list &errors, eval_call ec )
         {
-            node->mutate( [s, &errors, ec]( ast::node *n ) {
-                return macro_mutator( n, s, &errors, ec );
-            } );
+            expander ex( s, &errors, ec );
+            ex.visit( node );
         }
     };
 
@@ -0,0 +1,167 @@
+#ifndef MICO_MAPPED_FILE_H
+#define MICO_MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define MICO_MAPPED_FILE_POSIX 1
+#else
+#define MICO_MAPPED_FILE_POSIX 0
+#endif
+
+namespace mico {
+
+    /// Read-only view of a whole file.
+    /// The file is mapped if the system can do it; otherwise it is read
+    /// into a buffer. Either way the data lives while the object lives
+    class mapped_file {
+
+    public:
+
+        using const_iterator = const char *;
+
+        mapped_file( ) = default;
+
+        explicit
+        mapped_file( const std::string &path )
+        {
+            open( path );
+        }
+
+        ~mapped_file( )
+        {
+            close( );
+        }
+
+        mapped_file( const mapped_file & ) = delete;
+        mapped_file &operator = ( const mapped_file & ) = delete;
+
+        bool open( const std::string &path )
+        {
+            close( );
+#if MICO_MAPPED_FILE_POSIX
+            if( open_map( path ) ) {
+                return true;
+            }
+#endif
+            return open_read( path );
+        }
+
+        void close( )
+        {
+#if MICO_MAPPED_FILE_POSIX
+            if( map_ ) {
+                ::munmap( map_, size_ );
+            }
+#endif
+            map_    = nullptr;
+            data_   = nullptr;
+            size_   = 0;
+            opened_ = false;
+            buf_.clear( );
+        }
+
+        bool is_open( ) const
+        {
+            return opened_;
+        }
+
+        bool is_mapped( ) const
+        {
+            return map_ != nullptr;
+        }
+
+        std::size_t size( ) const
+        {
+            return size_;
+        }
+
+        const_iterator begin( ) const
+        {
+            return data_;
+        }
+
+        const_iterator end( ) const
+        {
+            return data_ + size_;
+        }
+
+    private:
+
+#if MICO_MAPPED_FILE_POSIX
+        bool open_map( const std::string &path )
+        {
+            int fd = ::open( path.c_str( ), O_RDONLY );
+            if( fd < 0 ) {
+                return false;
+            }
+
+            struct stat st;
+            if( ::fstat( fd, &st ) != 0 || !S_ISREG( st.st_mode ) ) {
+                ::close( fd );
+                return false;
+            }
+
+            opened_ = true;
+            size_   = static_cast<std::size_t>(st.st_size);
+            if( size_ == 0 ) {
+                ::close( fd );
+                return true;
+            }
+
+            void *addr = ::mmap( nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0 );
+            ::close( fd );
+
+            if( addr == MAP_FAILED ) {
+                opened_ = false;
+                size_   = 0;
+                return false;
+            }
+#if defined(MADV_SEQUENTIAL)
+            ::madvise( addr, size_, MADV_SEQUENTIAL );
+#endif
+            map_  = addr;
+            data_ = static_cast<const char *>(addr);
+            return true;
+        }
+#endif
+
+        bool open_read( const std::string &path )
+        {
+            std::ifstream f(path, std::ifstream::binary);
+            if( !f.is_open( ) ) {
+                return false;
+            }
+
+            f.seekg( 0, f.end );
+            auto size = f.tellg( );
+            f.seekg( 0, f.beg );
+
+            buf_.resize( static_cast<std::size_t>(size) );
+            if( size ) {
+                f.read( &buf_[0], size );
+            }
+            opened_ = true;
+            size_   = buf_.size( );
+            data_   = buf_.data( );
+            return true;
+        }
+
+        void               *map_    = nullptr;
+        const char         *data_   = nullptr;
+        std::size_t         size_   = 0;
+        bool                opened_ = false;
+        std::vector<char>   buf_;
+    };
+
+}
+
+#undef MICO_MAPPED_FILE_POSIX
+
+#endif // MAPPED_FILE_H
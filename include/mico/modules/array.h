@@ -0,0 +1,765 @@
+#ifndef MICO_MODULES_ARRAY_H
+#define MICO_MODULES_ARRAY_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <unordered_set>
+
+#include "mico/builtin/common.h"
+#include "mico/builtin/caller.h"
+#include "mico/objects/module.h"
+#include "mico/objects/array.h"
+#include "mico/objects/packed.h"
+#include "mico/modules/array/sort.h"
+
+#include "mico/environment.h"
+
+namespace mico { namespace modules {
+
+    /// sort, sort_by, binary_search, unique and reverse. A `mut` array
+    /// is changed in place and is the result; for other arrays the
+    /// result is a new array. Numbers, strings, characters and booleans
+    /// are compared natively; a user function is called only by sort_by
+    /// and by binary_search with a function
+    struct array {
+
+        using eval_call  = builtin::caller::eval_call;
+        using S          = array_sort;
+        using ARR        = objects::array;
+        using REF        = objects::impl<objects::type::REFERENCE>;
+        using packed     = objects::packed;
+        using int_type   = packed::int_type;
+        using float_type = packed::float_type;
+        using obj_list   = std::vector<objects::sptr>;
+        using order_type = std::vector<std::size_t>;
+
+        template <typename ...Args>
+        static
+        objects::sptr fail( const char *name, Args&&...args )
+        {
+            static const auto line = __LINE__;
+            return objects::error::make( tokens::position( line, 0 ),
+                                         "'array.", name, "' ",
+                                         std::forward<Args>(args)... );
+        }
+
+        /// checks the number of the parameters and that the first one
+        /// is an array; the result is empty or an error
+        static
+        objects::sptr check( const char *name, objects::slist &par,
+                             std::size_t min, std::size_t max )
+        {
+            if( par.size( ) < min || par.size( ) > max ) {
+                if( min == max ) {
+                    return fail( name, "expects ", min, " parameter(s)" );
+                }
+                return fail( name, "expects ", min, " or ", max,
+                             " parameters" );
+            }
+            if( par[0]->get_type( ) != objects::type::ARRAY ) {
+                return fail( name, "expects an array; got ",
+                             par[0]->get_type( ) );
+            }
+            return objects::sptr( );
+        }
+
+        static
+        bool is_number( objects::type t )
+        {
+            return t == objects::type::INTEGER || t == objects::type::FLOAT;
+        }
+
+        static
+        float_type number( const objects::sptr &val )
+        {
+            if( val->get_type( ) == objects::type::INTEGER ) {
+                auto v = objects::cast_int( val.get( ) )->value( );
+                return static_cast<float_type>(v);
+            }
+            return objects::cast_float( val.get( ) )->value( );
+        }
+
+        /// an integer in the order of the floats: the bits of a negative
+        /// float are turned over. -0.0 is 0.0; NaN goes to an end
+        static
+        int_type float_key( float_type val )
+        {
+            std::uint64_t bits = 0;
+            val = (val == 0) ? 0.0 : val;
+            std::memcpy( &bits, &val, sizeof(bits) );
+            if( bits >> 63 ) {
+                bits ^= 0x7FFFFFFFFFFFFFFFull;
+            }
+            return static_cast<int_type>(bits);
+        }
+
+        /// `a` < `b` as the evaluator compares them; `ok` is false if
+        /// they cannot be compared
+        static
+        bool less( const objects::sptr &a, const objects::sptr &b, bool &ok )
+        {
+            auto ta = a->get_type( );
+            auto tb = b->get_type( );
+            if( ta == objects::type::INTEGER && tb == objects::type::INTEGER ) {
+                return objects::cast_int( a.get( ) )->value( )
+                     < objects::cast_int( b.get( ) )->value( );
+            } else if( is_number( ta ) && is_number( tb ) ) {
+                return float_key( number( a ) ) < float_key( number( b ) );
+            } else if( ta != tb ) {
+                ok = false;
+                return false;
+            }
+            switch( ta ) {
+            case objects::type::STRING:
+                return objects::cast_string( a.get( ) )->value( )
+                     < objects::cast_string( b.get( ) )->value( );
+            case objects::type::CHARACTER:
+                return objects::cast_char( a.get( ) )->value( )
+                     < objects::cast_char( b.get( ) )->value( );
+            case objects::type::BOOLEAN:
+                return !objects::cast_bool( a.get( ) )->value( )
+                     && objects::cast_bool( b.get( ) )->value( );
+            default:
+                break;
+            }
+            ok = false;
+            return false;
+        }
+
+        /// the array to work on: `obj` itself if it is mutable,
+        /// otherwise a new array with the same elements
+        static
+        ARR::sptr target( const objects::sptr &obj, environment::sptr env )
+        {
+            auto arr = std::static_pointer_cast<ARR>( obj );
+            if( arr->is_mutable( ) || arr->size( ) == 0 ) {
+                return arr;
+            }
+            auto &pack( arr->packed_storage( ) );
+            if( pack ) {
+                return std::make_shared<ARR>( env,
+                                        std::make_shared<packed>( *pack ) );
+            }
+            auto res = ARR::make( env );
+            arr->for_each( [&]( const objects::sptr &v ) {
+                res->push( env.get( ), v );
+            } );
+            return res;
+        }
+
+        static
+        obj_list values( const ARR &arr )
+        {
+            obj_list res;
+            res.reserve( arr.size( ) );
+            arr.for_each( [&]( const objects::sptr &v ) {
+                res.emplace_back( v );
+            } );
+            return res;
+        }
+
+        /// calls `call` with the vector of the packed values
+        template <typename CallT>
+        static
+        void visit( packed &pack, CallT call )
+        {
+            switch( pack.kind( ) ) {
+            case objects::type::INTEGER:
+                call( pack.ints( ) );
+                break;
+            case objects::type::FLOAT:
+                call( pack.floats( ) );
+                break;
+            case objects::type::BOOLEAN:
+                call( pack.bools( ) );
+                break;
+            case objects::type::CHARACTER:
+                call( pack.chars( ) );
+                break;
+            default:
+                break;
+            }
+        }
+
+        /// `vals[i]` becomes the old `vals[order[i]]`
+        struct permute {
+            template <typename ContT>
+            void operator ( )( ContT &vals ) const
+            {
+                std::vector<typename ContT::value_type> tmp;
+                tmp.reserve( vals.size( ) );
+                for( auto id: order ) {
+                    tmp.emplace_back( std::move(vals[id]) );
+                }
+                std::move( tmp.begin( ), tmp.end( ), vals.begin( ) );
+            }
+            const order_type &order;
+        };
+
+        struct reverse_values {
+            template <typename ContT>
+            void operator ( )( ContT &vals ) const
+            {
+                std::reverse( vals.begin( ), vals.end( ) );
+            }
+        };
+
+        /// keeps the first of the equal values
+        struct unique_values {
+            template <typename T>
+            void operator ( )( std::vector<T> &vals ) const
+            {
+                std::unordered_set<T> seen;
+                std::size_t out = 0;
+                for( std::size_t i = 0; i < vals.size( ); ++i ) {
+                    if( seen.insert( vals[i] ).second ) {
+                        vals[out++] = vals[i];
+                    }
+                }
+                vals.resize( out );
+            }
+        };
+
+        struct sort_values {
+            void operator ( )( std::vector<int_type> &vals ) const
+            {
+                S::radix( vals.data( ), vals.size( ),
+                          []( int_type v ) { return v; } );
+            }
+
+            void operator ( )( std::vector<float_type> &vals ) const
+            {
+                S::radix( vals.data( ), vals.size( ),
+                          []( float_type v ) { return float_key( v ); } );
+            }
+
+            void operator ( )( std::vector<packed::bool_type> &vals ) const
+            {
+                auto trues = std::count_if( vals.begin( ), vals.end( ),
+                                [ ]( packed::bool_type v ) { return v; } );
+                auto mid = vals.end( ) - trues;
+                std::fill( vals.begin( ), mid, packed::bool_type( 0 ) );
+                std::fill( mid, vals.end( ), packed::bool_type( 1 ) );
+            }
+
+            void operator ( )( std::vector<packed::char_type> &vals ) const
+            {
+                S::radix( vals.data( ), vals.size( ),
+                          []( packed::char_type v ) {
+                              return static_cast<int_type>(v);
+                          } );
+            }
+        };
+
+        static
+        void apply_order( ARR &arr, const order_type &order )
+        {
+            arr.moved( );
+            if( auto pack = arr.mutable_packed( ) ) {
+                visit( *pack, permute { order } );
+            } else {
+                permute { order }( arr.mutable_value( ) );
+            }
+        }
+
+        /// the kind of all the keys: INTEGER, FLOAT for numbers that are
+        /// not all integers, STRING, CHARACTER or BOOLEAN; NULL_OBJ if
+        /// they cannot be compared
+        static
+        objects::type key_kind( const obj_list &keys )
+        {
+            auto kind = keys.empty( ) ? objects::type::INTEGER
+                                      : keys[0]->get_type( );
+            for( auto &k: keys ) {
+                auto t = k->get_type( );
+                if( t != kind ) {
+                    if( !is_number( t ) || !is_number( kind ) ) {
+                        return objects::type::NULL_OBJ;
+                    }
+                    kind = objects::type::FLOAT;
+                }
+            }
+            switch( kind ) {
+            case objects::type::INTEGER:
+            case objects::type::FLOAT:
+            case objects::type::STRING:
+            case objects::type::CHARACTER:
+            case objects::type::BOOLEAN:
+                return kind;
+            default:
+                break;
+            }
+            return objects::type::NULL_OBJ;
+        }
+
+        /// a key of a number, a character or a boolean; floats are
+        /// in the order of float_key if not all the numbers are integers
+        static
+        int_type int_key( const objects::sptr &key, bool floats )
+        {
+            switch( key->get_type( ) ) {
+            case objects::type::INTEGER:
+                if( floats ) {
+                    return float_key( number( key ) );
+                }
+                break;
+            case objects::type::FLOAT:
+                return float_key( number( key ) );
+            case objects::type::CHARACTER:
+                return objects::cast_char( key.get( ) )->value( );
+            case objects::type::BOOLEAN:
+                return objects::cast_bool( key.get( ) )->value( ) ? 1 : 0;
+            default:
+                break;
+            }
+            return objects::cast_int( key.get( ) )->value( );
+        }
+
+        template <typename T>
+        static
+        void fill_order( const std::vector<std::pair<T, std::size_t> > &src,
+                         order_type &order )
+        {
+            order.clear( );
+            order.reserve( src.size( ) );
+            for( auto &s: src ) {
+                order.push_back( s.second );
+            }
+        }
+
+        /// a string key. The first three UCS-4 symbols are kept in the
+        /// item (21 bits each), so most of the compares do not read
+        /// the strings. A string with a symbol out of the range is
+        /// always compared as a whole
+        struct string_item {
+
+            string_item( ) = default;
+
+            string_item( const mico::string *val, std::size_t pos )
+                :str(val)
+                ,id(pos)
+            {
+                for( std::size_t i = 0; i < 3; ++i ) {
+                    std::uint64_t sym = 0;
+                    if( i < val->size( ) ) {
+                        auto c = static_cast<std::int64_t>((*val)[i]);
+                        known = known && c > 0 && c < 0x1FFFFF;
+                        sym = known ? static_cast<std::uint64_t>(c) : 0;
+                    }
+                    prefix = (prefix << 21) | sym;
+                }
+            }
+
+            bool before( const string_item &other ) const
+            {
+                if( known && other.known && prefix != other.prefix ) {
+                    return prefix < other.prefix;
+                }
+                auto res = str->compare( *other.str );
+                return res < 0 || (res == 0 && id < other.id);
+            }
+
+            std::uint64_t       prefix = 0;
+            bool                known  = true;
+            const mico::string *str    = nullptr;
+            std::size_t         id     = 0;
+        };
+
+        /// positions of the keys in the sorted order; equal keys keep
+        /// their order. False if the keys cannot be compared
+        static
+        bool key_order( const obj_list &keys, order_type &order )
+        {
+            auto n    = keys.size( );
+            auto kind = key_kind( keys );
+            switch( kind ) {
+            case objects::type::INTEGER:
+            case objects::type::FLOAT:
+            case objects::type::CHARACTER:
+            case objects::type::BOOLEAN: {
+                using item = std::pair<int_type, std::size_t>;
+                std::vector<item> items( n );
+                for( std::size_t i = 0; i < n; ++i ) {
+                    items[i] = item( int_key( keys[i],
+                                         kind == objects::type::FLOAT ), i );
+                }
+                S::radix( items.data( ), n,
+                          []( const item &v ) { return v.first; } );
+                fill_order( items, order );
+                return true;
+            }
+            case objects::type::STRING: {
+                std::vector<string_item> items( n );
+                for( std::size_t i = 0; i < n; ++i ) {
+                    auto s = objects::cast_string( keys[i].get( ) );
+                    items[i] = string_item( &s->value( ), i );
+                }
+                S::pdqsort( items.begin( ), items.end( ),
+                            []( const string_item &a,
+                                const string_item &b ) {
+                                return a.before( b );
+                            } );
+                order.clear( );
+                order.reserve( n );
+                for( auto &s: items ) {
+                    order.push_back( s.id );
+                }
+                return true;
+            }
+            default:
+                break;
+            }
+            return false;
+        }
+
+        /// the result of a user function
+        static
+        objects::sptr call_result( builtin::caller &call )
+        {
+            auto res = call( );
+            if( res->get_type( ) == objects::type::REFERENCE ) {
+                res = objects::cast_ref( res.get( ) )->value( );
+            }
+            return res;
+        }
+
+        /// a user comparator `fn(a, b)` that is true if `a` goes before
+        /// `b`. The first error is kept; after it every call is false
+        struct user_less {
+
+            user_less( const char *name, eval_call ev, environment::sptr env,
+                       objects::sptr fn, const objects::sptr &first )
+                :name_(name)
+                ,call_(std::move(ev), env, std::move(fn),
+                       objects::slist { first, first })
+            { }
+
+            bool operator ( )( const objects::sptr &a,
+                               const objects::sptr &b )
+            {
+                if( error ) {
+                    return false;
+                }
+                call_.set_param( 0, a );
+                call_.set_param( 1, b );
+                auto res = call_result( call_ );
+                if( res->get_type( ) == objects::type::BOOLEAN ) {
+                    return objects::cast_bool( res.get( ) )->value( );
+                } else if( res->get_type( ) == objects::type::FAILURE ) {
+                    error = res;
+                } else {
+                    error = fail( name_, "expects a boolean from the "
+                                         "function; got ",
+                                  res->get_type( ) );
+                }
+                return false;
+            }
+
+            const char     *name_;
+            builtin::caller call_;
+            objects::sptr   error;
+        };
+
+        struct sort {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                auto err = check( "sort", par, 1, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto arr = target( par[0], env );
+                if( arr->size( ) < 2 ) {
+                    return arr;
+                }
+                if( arr->packed_storage( ) ) {
+                    arr->moved( );
+                    visit( *arr->mutable_packed( ), sort_values { } );
+                    return arr;
+                }
+                order_type order;
+                if( !key_order( values( *arr ), order ) ) {
+                    return fail( "sort", "cannot compare the elements; "
+                                         "use 'sort_by'" );
+                }
+                apply_order( *arr, order );
+                return arr;
+            }
+        };
+
+        /// sort_by(a, fn): `fn(x)` with one parameter gives a key of
+        /// an element; it is called once for every element and the keys
+        /// are compared natively. Otherwise `fn(x, y)` is true if `x`
+        /// goes before `y`
+        struct sort_by {
+
+            explicit
+            sort_by( eval_call ev )
+                :ev_(std::move(ev))
+            { }
+
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                auto err = check( "sort_by", par, 2, 2 );
+                if( err ) {
+                    return err;
+                } else if( !builtin::caller::is_callable( par[1] ) ) {
+                    return fail( "sort_by", "expects a function; got ",
+                                 par[1]->get_type( ) );
+                }
+                auto arr = target( par[0], env );
+                if( arr->size( ) < 2 ) {
+                    return arr;
+                }
+                auto vals = values( *arr );
+
+                order_type order;
+                if( is_key_function( par[1] ) ) {
+                    obj_list keys;
+                    keys.reserve( vals.size( ) );
+                    builtin::caller call( ev_, env, par[1],
+                                          objects::slist { vals[0] } );
+                    for( auto &v: vals ) {
+                        call.set_param( 0, v );
+                        auto key = call_result( call );
+                        if( key->get_type( ) == objects::type::FAILURE ) {
+                            return key;
+                        }
+                        keys.emplace_back( std::move(key) );
+                    }
+                    if( !key_order( keys, order ) ) {
+                        return fail( "sort_by", "cannot compare the keys" );
+                    }
+                } else {
+                    user_less cmp( "sort_by", ev_, env, par[1], vals[0] );
+                    order.resize( vals.size( ) );
+                    for( std::size_t i = 0; i < order.size( ); ++i ) {
+                        order[i] = i;
+                    }
+                    S::pdqsort( order.begin( ), order.end( ),
+                                [&]( std::size_t a, std::size_t b ) {
+                                    return cmp( vals[a], vals[b] );
+                                } );
+                    if( cmp.error ) {
+                        return cmp.error;
+                    }
+                }
+                apply_order( *arr, order );
+                return arr;
+            }
+
+            static
+            bool is_key_function( const objects::sptr &fn )
+            {
+                return fn->get_type( ) == objects::type::FUNCTION
+                    && objects::cast_func( fn.get( ) )->param_size( ) == 1;
+            }
+
+            eval_call ev_;
+        };
+
+        /// binary_search(a, x[, fn]): the position of the first element
+        /// of the sorted `a` that is equal to `x` or -1. `fn(a, b)` is
+        /// the comparator `a` was sorted with
+        struct binary_search {
+
+            explicit
+            binary_search( eval_call ev )
+                :ev_(std::move(ev))
+            { }
+
+            template <typename LessT>
+            static
+            std::int64_t search( const ARR &arr, const objects::sptr &val,
+                                 LessT less )
+            {
+                std::size_t lo = 0;
+                std::size_t hi = arr.size( );
+                while( lo < hi ) {
+                    auto mid = lo + (hi - lo) / 2;
+                    if( less( arr.element( mid ), val ) ) {
+                        lo = mid + 1;
+                    } else {
+                        hi = mid;
+                    }
+                }
+                if( lo < arr.size( ) && !less( val, arr.element( lo ) ) ) {
+                    return static_cast<std::int64_t>(lo);
+                }
+                return -1;
+            }
+
+            template <typename T, typename LessT>
+            static
+            std::int64_t search( const std::vector<T> &vals, T val,
+                                 LessT less )
+            {
+                auto f = std::lower_bound( vals.begin( ), vals.end( ),
+                                           val, less );
+                if( f != vals.end( ) && !less( val, *f ) ) {
+                    return static_cast<std::int64_t>(f - vals.begin( ));
+                }
+                return -1;
+            }
+
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                auto err = check( "binary_search", par, 2, 3 );
+                if( err ) {
+                    return err;
+                }
+                auto arr = objects::cast_array( par[0].get( ) );
+                auto &val( par[1] );
+
+                if( par.size( ) == 3 ) {
+                    if( !builtin::caller::is_callable( par[2] ) ) {
+                        return fail( "binary_search",
+                                     "expects a function; got ",
+                                     par[2]->get_type( ) );
+                    }
+                    user_less cmp( "binary_search", ev_, env, par[2], val );
+                    auto res = search( *arr, val, std::ref( cmp ) );
+                    if( cmp.error ) {
+                        return cmp.error;
+                    }
+                    return objects::integer::make( res );
+                }
+
+                auto &pack( arr->packed_storage( ) );
+                if( pack && pack->kind( ) == objects::type::INTEGER
+                 && val->get_type( ) == objects::type::INTEGER )
+                {
+                    auto v = objects::cast_int( val.get( ) )->value( );
+                    return objects::integer::make(
+                        search( pack->ints( ), v, std::less<int_type>( ) ) );
+                } else if( pack && pack->kind( ) == objects::type::FLOAT
+                        && is_number( val->get_type( ) ) )
+                {
+                    return objects::integer::make(
+                        search( pack->floats( ), number( val ),
+                                []( float_type a, float_type b ) {
+                                    return float_key( a ) < float_key( b );
+                                } ) );
+                }
+
+                bool ok = true;
+                auto res = search( *arr, val,
+                    [&ok]( const objects::sptr &a, const objects::sptr &b ) {
+                        return less( a, b, ok );
+                    } );
+                if( !ok ) {
+                    return fail( "binary_search", "cannot compare ",
+                                 val->get_type( ),
+                                 " with the elements; use a function" );
+                }
+                return objects::integer::make( res );
+            }
+
+            eval_call ev_;
+        };
+
+        /// removes the elements that are equal to an element before
+        struct unique {
+
+            struct hasher {
+                std::size_t operator ( )( const objects::base *o ) const
+                {
+                    return static_cast<std::size_t>(o->hash( ));
+                }
+            };
+
+            struct equal {
+                bool operator ( )( const objects::base *a,
+                                   const objects::base *b ) const
+                {
+                    return a->equal( b );
+                }
+            };
+
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                auto err = check( "unique", par, 1, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto arr = target( par[0], env );
+                if( arr->size( ) < 2 ) {
+                    return arr;
+                }
+                arr->moved( );
+                if( arr->packed_storage( ) ) {
+                    visit( *arr->mutable_packed( ), unique_values { } );
+                    return arr;
+                }
+
+                auto &vals( arr->mutable_value( ) );
+                std::unordered_set<const objects::base *,
+                                   hasher, equal> seen;
+                std::size_t out = 0;
+                for( std::size_t i = 0; i < vals.size( ); ++i ) {
+                    auto v = REF::slot_value( vals[i] ).get( );
+                    if( seen.insert( v ).second ) {
+                        if( out != i ) {
+                            vals[out] = std::move(vals[i]);
+                        }
+                        ++out;
+                    }
+                }
+                vals.erase( vals.begin( ) + static_cast<std::ptrdiff_t>(out),
+                            vals.end( ) );
+                return arr;
+            }
+        };
+
+        struct reverse {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                auto err = check( "reverse", par, 1, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto arr = target( par[0], env );
+                if( arr->size( ) < 2 ) {
+                    return arr;
+                }
+                arr->moved( );
+                if( arr->packed_storage( ) ) {
+                    visit( *arr->mutable_packed( ), reverse_values { } );
+                } else {
+                    reverse_values { }( arr->mutable_value( ) );
+                }
+                return arr;
+            }
+        };
+
+        static
+        void load( environment::sptr &env, eval_call ev,
+                   const std::string &name = "array" )
+        {
+            using BC = builtin::common;
+            auto mod_env = environment::make(env);
+            auto mod = objects::module::make( mod_env, name );
+
+            mod_env->set_const( "sort",    BC::make( mod_env, sort { } ) );
+            mod_env->set_const( "sort_by", BC::make( mod_env,
+                                                     sort_by( ev ) ) );
+            mod_env->set_const( "binary_search",
+                                BC::make( mod_env, binary_search( ev ) ) );
+            mod_env->set_const( "unique",  BC::make( mod_env, unique { } ) );
+            mod_env->set_const( "reverse", BC::make( mod_env,
+                                                     reverse { } ) );
+
+            env->set_const( name, mod );
+        }
+    };
+
+}}
+
+#endif // ARRAY_H
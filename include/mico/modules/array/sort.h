@@ -0,0 +1,313 @@
+#ifndef MICO_MODULES_ARRAY_SORT_H
+#define MICO_MODULES_ARRAY_SORT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+
+namespace mico { namespace modules {
+
+    /// Sorting of plain values for the array module.
+    /// `pdqsort` is a pattern-defeating quicksort: insertion sort for
+    /// short ranges, a median of 3 (or a ninther) pivot, a check for
+    /// ranges that are already sorted, a shuffle after a bad partition
+    /// and heapsort if there are too many of them. Every loop checks
+    /// its bounds, so a comparator that is not a strict order (such as
+    /// a user function) gives a wrong order but never leaves the range.
+    /// `radix` is a stable LSD radix sort of 64-bit keys (an insertion
+    /// sort for a few of them)
+    struct array_sort {
+
+        template <typename Iter, typename Less>
+        static
+        void pdqsort( Iter begin, Iter end, Less less )
+        {
+            auto size = end - begin;
+            int bad_allowed = 1;
+            while( size >>= 1 ) {
+                ++bad_allowed;
+            }
+            pdq_loop( begin, end, less, bad_allowed, true );
+        }
+
+        /// `key` gives a signed 64-bit key of an element; T has to be
+        /// default constructible. Digits that are the same for all the
+        /// keys are skipped
+        template <typename T, typename KeyF>
+        static
+        void radix( T *vals, std::size_t n, KeyF key )
+        {
+            static const unsigned digits = 8;
+            static const std::uint64_t sign = std::uint64_t( 1 ) << 63;
+
+            if( n < radix_limit ) {
+                auto less = [&key]( const T &a, const T &b ) {
+                    return key( a ) < key( b );
+                };
+                insertion( vals, vals + n, less );
+                return;
+            }
+
+            std::vector<std::size_t> counts( digits * 256 );
+            for( std::size_t i = 0; i < n; ++i ) {
+                auto k = static_cast<std::uint64_t>(key( vals[i] )) ^ sign;
+                for( unsigned d = 0; d < digits; ++d ) {
+                    ++counts[d * 256 + ((k >> (d * 8)) & 0xFF)];
+                }
+            }
+
+            std::vector<T> buf( n );
+            T *from = vals;
+            T *to   = buf.data( );
+            for( unsigned d = 0; d < digits; ++d ) {
+                auto cnt = &counts[d * 256];
+                if( std::find( cnt, cnt + 256, n ) != cnt + 256 ) {
+                    continue;
+                }
+                std::size_t pos = 0;
+                for( std::size_t b = 0; b < 256; ++b ) {
+                    auto next = pos + cnt[b];
+                    cnt[b] = pos;
+                    pos = next;
+                }
+                for( std::size_t i = 0; i < n; ++i ) {
+                    auto k = static_cast<std::uint64_t>(key( from[i] ))
+                           ^ sign;
+                    to[cnt[(k >> (d * 8)) & 0xFF]++] = std::move(from[i]);
+                }
+                std::swap( from, to );
+            }
+            if( from != vals ) {
+                std::move( from, from + n, vals );
+            }
+        }
+
+    private:
+
+        static const std::ptrdiff_t insertion_limit = 24;
+        static const std::ptrdiff_t ninther_limit   = 128;
+        static const std::size_t    partial_limit   = 8;
+        static const std::size_t    radix_limit     = 64;
+
+        template <typename Iter, typename Less>
+        static
+        void insertion( Iter begin, Iter end, Less &less )
+        {
+            if( begin == end ) {
+                return;
+            }
+            for( auto cur = begin + 1; cur != end; ++cur ) {
+                if( less( *cur, *(cur - 1) ) ) {
+                    auto tmp  = std::move(*cur);
+                    auto sift = cur;
+                    do {
+                        *sift = std::move(*(sift - 1));
+                        --sift;
+                    } while( sift != begin && less( tmp, *(sift - 1) ) );
+                    *sift = std::move(tmp);
+                }
+            }
+        }
+
+        /// insertion sort that gives up after `partial_limit` moves
+        template <typename Iter, typename Less>
+        static
+        bool partial_insertion( Iter begin, Iter end, Less &less )
+        {
+            if( begin == end ) {
+                return true;
+            }
+            std::size_t moves = 0;
+            for( auto cur = begin + 1; cur != end; ++cur ) {
+                if( less( *cur, *(cur - 1) ) ) {
+                    auto tmp  = std::move(*cur);
+                    auto sift = cur;
+                    do {
+                        *sift = std::move(*(sift - 1));
+                        --sift;
+                    } while( sift != begin && less( tmp, *(sift - 1) ) );
+                    *sift = std::move(tmp);
+                    moves += static_cast<std::size_t>(cur - sift);
+                    if( moves > partial_limit ) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        template <typename Iter, typename Less>
+        static
+        void sort3( Iter a, Iter b, Iter c, Less &less )
+        {
+            if( less( *b, *a ) ) {
+                std::iter_swap( a, b );
+            }
+            if( less( *c, *b ) ) {
+                std::iter_swap( b, c );
+            }
+            if( less( *b, *a ) ) {
+                std::iter_swap( a, b );
+            }
+        }
+
+        /// the pivot is *begin; the elements less than the pivot go to
+        /// the left of it. The flag is set if no element was moved
+        template <typename Iter, typename Less>
+        static
+        std::pair<Iter, bool> partition_right( Iter begin, Iter end,
+                                               Less &less )
+        {
+            auto pivot = std::move(*begin);
+            auto first = begin + 1;
+            auto last  = end;
+
+            while( first != last && less( *first, pivot ) ) {
+                ++first;
+            }
+            while( first != last && !less( *(last - 1), pivot ) ) {
+                --last;
+            }
+            bool already = (first == last);
+            while( first != last ) {
+                if( first == --last ) {
+                    break;
+                }
+                std::iter_swap( first, last );
+                ++first;
+                while( first != last && less( *first, pivot ) ) {
+                    ++first;
+                }
+                while( first != last && !less( *(last - 1), pivot ) ) {
+                    --last;
+                }
+            }
+
+            auto pos = first - 1;
+            *begin = std::move(*pos);
+            *pos   = std::move(pivot);
+            return std::make_pair( pos, already );
+        }
+
+        /// the elements equal to the pivot go to the left of it; used
+        /// when the pivot is equal to the element before the range
+        template <typename Iter, typename Less>
+        static
+        Iter partition_left( Iter begin, Iter end, Less &less )
+        {
+            auto pivot = std::move(*begin);
+            auto first = begin + 1;
+            auto last  = end;
+
+            while( first != last && !less( pivot, *first ) ) {
+                ++first;
+            }
+            while( first != last && less( pivot, *(last - 1) ) ) {
+                --last;
+            }
+            while( first != last ) {
+                if( first == --last ) {
+                    break;
+                }
+                std::iter_swap( first, last );
+                ++first;
+                while( first != last && !less( pivot, *first ) ) {
+                    ++first;
+                }
+                while( first != last && less( pivot, *(last - 1) ) ) {
+                    --last;
+                }
+            }
+
+            auto pos = first - 1;
+            *begin = std::move(*pos);
+            *pos   = std::move(pivot);
+            return pos;
+        }
+
+        /// moves some elements of [begin, end) around after a bad
+        /// partition, so the next pivot is taken from other places
+        template <typename Iter>
+        static
+        void shuffle( Iter begin, Iter end )
+        {
+            auto size = end - begin;
+            if( size < insertion_limit ) {
+                return;
+            }
+            auto q = size / 4;
+            std::iter_swap( begin, begin + q );
+            std::iter_swap( end - 1, end - q );
+            if( size > ninther_limit ) {
+                std::iter_swap( begin + 1, begin + (q + 1) );
+                std::iter_swap( begin + 2, begin + (q + 2) );
+                std::iter_swap( end - 2, end - (q + 1) );
+                std::iter_swap( end - 3, end - (q + 2) );
+            }
+        }
+
+        template <typename Iter, typename Less>
+        static
+        void pdq_loop( Iter begin, Iter end, Less &less, int bad_allowed,
+                       bool leftmost )
+        {
+            while( true ) {
+                auto size = end - begin;
+                if( size < insertion_limit ) {
+                    insertion( begin, end, less );
+                    return;
+                }
+
+                auto half = size / 2;
+                if( size > ninther_limit ) {
+                    sort3( begin, begin + half, end - 1, less );
+                    sort3( begin + 1, begin + (half - 1), end - 2, less );
+                    sort3( begin + 2, begin + (half + 1), end - 3, less );
+                    sort3( begin + (half - 1), begin + half,
+                           begin + (half + 1), less );
+                    std::iter_swap( begin, begin + half );
+                } else {
+                    sort3( begin + half, begin, end - 1, less );
+                }
+
+                /// the element before the range is not greater than any
+                /// element of it; if it is equal to the pivot, there are
+                /// many equal elements and they are done at once
+                if( !leftmost && !less( *(begin - 1), *begin ) ) {
+                    begin = partition_left( begin, end, less ) + 1;
+                    continue;
+                }
+
+                auto part  = partition_right( begin, end, less );
+                auto pivot = part.first;
+                auto lsize = pivot - begin;
+                auto rsize = end - (pivot + 1);
+
+                if( lsize < size / 8 || rsize < size / 8 ) {
+                    if( --bad_allowed == 0 ) {
+                        std::make_heap( begin, end, less );
+                        std::sort_heap( begin, end, less );
+                        return;
+                    }
+                    shuffle( begin, pivot );
+                    shuffle( pivot + 1, end );
+                } else if( part.second
+                        && partial_insertion( begin, pivot, less )
+                        && partial_insertion( pivot + 1, end, less ) )
+                {
+                    return;
+                }
+
+                pdq_loop( begin, pivot, less, bad_allowed, leftmost );
+                begin    = pivot + 1;
+                leftmost = false;
+            }
+        }
+    };
+
+}}
+
+#endif // SORT_H
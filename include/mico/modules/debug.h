@@ -3,7 +3,10 @@
 
 #include "mico/builtin.h"
 #include "mico/builtin/common.h"
+#include "mico/builtin/caller.h"
 #include "mico/objects/module.h"
+#include "mico/objects/pool.h"
+#include "mico/perf/counters.h"
 
 namespace mico { namespace modules {
 
@@ -24,14 +27,93 @@ namespace mico { namespace modules {
         environment::wptr env;
     };
 
+    /// dbg.counters(fn, params...)
+    /// calls `fn` with the parameters and returns a table
+    /// with wall time and hardware counters (if available)
+    struct counters_call {
+
+        using eval_call = builtin::caller::eval_call;
+
+        explicit
+        counters_call( eval_call ev )
+            :ev_(std::move(ev))
+        { }
+
+        static
+        void set( objects::table::sptr &t, environment::sptr &env,
+                  const std::string &key, objects::sptr val )
+        {
+            t->set( env.get( ), objects::string::make( key ), val );
+        }
+
+        objects::sptr operator ( )( objects::slist &pp, environment::sptr e )
+        {
+            static const auto line = __LINE__;
+            using objects::error;
+
+            if( pp.empty( ) || !builtin::caller::is_callable( pp[0] ) ) {
+                return error::make( tokens::position( line, 0 ),
+                                    "'counters' expects a function" );
+            }
+
+            objects::slist params( pp.begin( ) + 1, pp.end( ) );
+            builtin::caller call( ev_, e, pp[0], params );
+
+            auto &pool( objects::pool::local( ) );
+            auto pool_start = pool.statistics( );
+            perf::counters cnt;
+            cnt.start( );
+            auto call_res = call( );
+            auto smpl = cnt.stop( );
+            auto pool_stop = pool.statistics( );
+
+            if( call_res->get_type( ) == objects::type::FAILURE ) {
+                return call_res;
+            }
+
+            auto res = objects::table::make( e );
+            set( res, e, "result",  call_res );
+            set( res, e, "wall_ns", objects::integer::make( smpl.wall_ns ) );
+            set( res, e, "hw",      objects::boolean::make( smpl.has_hw( ) ) );
+            set( res, e, "pool_hits",
+                 objects::integer::make( pool_stop.hits - pool_start.hits ) );
+            set( res, e, "pool_misses",
+                 objects::integer::make( pool_stop.misses
+                                       - pool_start.misses ) );
+            for( std::size_t i = 0; i < perf::sample::count; ++i ) {
+                auto ev = static_cast<perf::event>(i);
+                if( smpl.has( ev ) ) {
+                    set( res, e, perf::name::get( ev ),
+                         objects::integer::make( smpl.get( ev ) ) );
+                }
+            }
+            return res;
+        }
+        eval_call ev_;
+    };
+
     struct debug {
+
+        using eval_call = builtin::caller::eval_call;
+
         static
         void load( environment::sptr &env, const std::string &name = "dbg" )
+        {
+            load( env, nullptr, name );
+        }
+
+        static
+        void load( environment::sptr &env, eval_call ev,
+                   const std::string &name = "dbg" )
         {
             using BC = builtin::common;
             auto mod_e = environment::make(env);
             auto mod = objects::module::make( mod_e, name );
             mod_e->set_const( "env", BC::make( mod_e, env_show(env) ) );
+            if( ev ) {
+                mod_e->set_const( "counters",
+                                  BC::make( mod_e, counters_call(ev) ) );
+            }
             env->set_const( name, mod );
         }
     };
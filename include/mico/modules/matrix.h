@@ -0,0 +1,418 @@
+#ifndef MICO_MODULES_MATRIX_H
+#define MICO_MODULES_MATRIX_H
+
+#include <vector>
+#include <algorithm>
+
+#include "mico/builtin/common.h"
+#include "mico/objects/module.h"
+#include "mico/objects/array.h"
+#include "mico/objects/packed.h"
+#include "mico/objects/matrix.h"
+#include "mico/modules/vec.h"
+#include "mico/modules/vec/kernels.h"
+
+#include "mico/environment.h"
+
+namespace mico { namespace modules {
+
+    /// Making matrices and taking them apart. Operators and indexes are
+    /// in eval/operations/matrix.h
+    struct matrix {
+
+        using K          = vec_kernels;
+        using float_type = K::float_type;
+        using MAT        = objects::matrix;
+        using packed     = objects::packed;
+        using ARR        = objects::array;
+        using FLT        = objects::floating;
+        using INT        = objects::integer;
+
+        template <typename ...Args>
+        static
+        objects::sptr fail( const char *name, Args&&...args )
+        {
+            static const auto line = __LINE__;
+            return objects::error::make( tokens::position( line, 0 ),
+                                         "'matrix.", name, "' ",
+                                         std::forward<Args>(args)... );
+        }
+
+        /// false if `obj` is not a non negative integer
+        static
+        bool read_size( const objects::sptr &obj, std::size_t &res )
+        {
+            if( obj->get_type( ) != objects::type::INTEGER ) {
+                return false;
+            }
+            auto val = objects::cast_int( obj.get( ) )->value( );
+            res = static_cast<std::size_t>(val);
+            return val >= 0;
+        }
+
+        /// checks the number of the parameters and that the first one
+        /// is a matrix; the result is empty or an error
+        static
+        objects::sptr check( const char *name, objects::slist &par,
+                             std::size_t count )
+        {
+            if( par.size( ) != count ) {
+                return fail( name, "expects ", count, " parameter(s)" );
+            }
+            if( par[0]->get_type( ) != objects::type::MATRIX ) {
+                return fail( name, "expects a matrix; got ",
+                             par[0]->get_type( ) );
+            }
+            return objects::sptr( );
+        }
+
+        /// zeros or an error if there is no memory for them
+        static
+        objects::sptr alloc( const char *name, std::size_t rows,
+                             std::size_t cols )
+        {
+            if( auto res = MAT::try_make( rows, cols ) ) {
+                return res;
+            }
+            return fail( name, "cannot make a matrix ", rows, "x", cols );
+        }
+
+        static
+        objects::sptr make_array( environment::sptr env,
+                                  const float_type *from, std::size_t count,
+                                  std::size_t step = 1 )
+        {
+            auto res = std::make_shared<packed>( objects::type::FLOAT );
+            auto &vals( res->floats( ) );
+            vals.reserve( count );
+            for( std::size_t i = 0; i < count; ++i ) {
+                vals.push_back( from[i * step] );
+            }
+            return std::make_shared<ARR>( env, res );
+        }
+
+        /// the error for the row `r` of matrix.make; names the first
+        /// element that is not a number if the row is an array or a slice
+        static
+        objects::sptr invalid_row( std::size_t r, const objects::sptr &obj )
+        {
+            std::size_t beg = 0;
+            std::size_t end = 0;
+            bool reversed   = false;
+            if( auto arr = vec::elements( obj, beg, end, reversed ) ) {
+                for( std::size_t c = 0; c < end - beg; ++c ) {
+                    auto t = arr->element( reversed ? end - 1 - c
+                                                    : beg + c )->get_type( );
+                    if( !vec::is_number( t ) ) {
+                        return fail( "make", "got an invalid element ", c,
+                                     " of row ", r, ": ", t );
+                    }
+                }
+            }
+            return fail( "make", "got an invalid row ", r,
+                         ": ", obj->get_type( ) );
+        }
+
+        /// an array of rows; every row is an array of numbers of
+        /// the same size
+        struct make {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                if( par.size( ) != 1 ) {
+                    return fail( "make", "expects 1 parameter(s)" );
+                }
+                if( par[0]->get_type( ) != objects::type::ARRAY ) {
+                    return fail( "make", "expects an array of rows; got ",
+                                 par[0]->get_type( ) );
+                }
+                auto arr  = objects::cast_array( par[0].get( ) );
+                auto rows = arr->size( );
+                std::size_t cols = 0;
+                auto val = std::make_shared<MAT::value_type>( );
+                for( std::size_t r = 0; r < rows; ++r ) {
+                    vec::operand row;
+                    if( !vec::read( arr->element( r ), row ) || row.scalar
+                     || !row.number( ) )
+                    {
+                        return invalid_row( r, arr->element( r ) );
+                    }
+                    if( r == 0 ) {
+                        cols = row.size;
+                        val->reserve( rows * cols );
+                    } else if( row.size != cols ) {
+                        return fail( "make", "got rows of different sizes" );
+                    }
+                    row.to_float( );
+                    val->insert( val->end( ), row.floats,
+                                 row.floats + row.size );
+                }
+                return MAT::make( rows, cols, val );
+            }
+        };
+
+        struct zeros {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                std::size_t rows = 0;
+                std::size_t cols = 0;
+                if( par.size( ) != 2 || !read_size( par[0], rows )
+                                     || !read_size( par[1], cols ) )
+                {
+                    return fail( "zeros", "expects 2 non negative integers" );
+                }
+                return alloc( "zeros", rows, cols );
+            }
+        };
+
+        struct identity {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                std::size_t count = 0;
+                if( par.size( ) != 1 || !read_size( par[0], count ) ) {
+                    return fail( "identity",
+                                 "expects a non negative integer" );
+                }
+                auto res = alloc( "identity", count, count );
+                if( res->get_type( ) != objects::type::MATRIX ) {
+                    return res;
+                }
+                auto out = objects::cast_matrix( res.get( ) )->mutable_data( );
+                for( std::size_t i = 0; i < count; ++i ) {
+                    out[i * count + i] = 1;
+                }
+                return res;
+            }
+        };
+
+        /// an array of rows
+        struct to_array {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                auto err = check( "to_array", par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                auto res = ARR::make( env );
+                for( std::size_t r = 0; r < mat->rows( ); ++r ) {
+                    res->push( env.get( ),
+                               make_array( env,
+                                           mat->data( ) + r * mat->cols( ),
+                                           mat->cols( ) ) );
+                }
+                return res;
+            }
+        };
+
+        struct rows {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                auto err = check( "rows", par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                return INT::make( static_cast<std::int64_t>(mat->rows( )) );
+            }
+        };
+
+        struct cols {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                auto err = check( "cols", par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                return INT::make( static_cast<std::int64_t>(mat->cols( )) );
+            }
+        };
+
+        struct transpose {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                auto err = check( "transpose", par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                auto res = MAT::make( mat->cols( ), mat->rows( ) );
+                K::transpose( mat->data( ), res->mutable_data( ),
+                              mat->rows( ), mat->cols( ) );
+                return res;
+            }
+        };
+
+        /// row(m, i) and col(m, j); a negative index counts from the end
+        template <bool Row>
+        struct line {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                const char *name = Row ? "row" : "col";
+                auto err = check( name, par, 2 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                auto count = Row ? mat->rows( ) : mat->cols( );
+                if( par[1]->get_type( ) != objects::type::INTEGER ) {
+                    return fail( name, "expects an integer index; got ",
+                                 par[1]->get_type( ) );
+                }
+                auto id = MAT::fix_id(
+                            objects::cast_int( par[1].get( ) )->value( ),
+                            count );
+                if( id == MAT::npos ) {
+                    return fail( name, "got an index out of range" );
+                }
+                if( Row ) {
+                    return make_array( env, mat->data( ) + id * mat->cols( ),
+                                       mat->cols( ) );
+                }
+                return make_array( env, mat->data( ) + id, mat->rows( ),
+                                   mat->cols( ) );
+            }
+        };
+
+        struct sum {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                auto err = check( "sum", par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                return FLT::make( K::sum( mat->data( ),
+                                          mat->rows( ) * mat->cols( ) ) );
+            }
+        };
+
+        struct mean {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                auto err = check( "mean", par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                auto count = mat->rows( ) * mat->cols( );
+                if( count == 0 ) {
+                    return fail( "mean", "got an empty matrix" );
+                }
+                return FLT::make( K::sum( mat->data( ), count )
+                                / static_cast<float_type>(count) );
+            }
+        };
+
+        template <bool Max>
+        struct extreme {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                const char *name = Max ? "max" : "min";
+                auto err = check( name, par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                auto count = mat->rows( ) * mat->cols( );
+                if( count == 0 ) {
+                    return fail( name, "got an empty matrix" );
+                }
+                return FLT::make( K::extreme<Max>( mat->data( ), count ) );
+            }
+        };
+
+        /// sums of every row
+        struct sum_rows {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                auto err = check( "sum_rows", par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                auto res = std::make_shared<packed>( objects::type::FLOAT );
+                auto &vals( res->floats( ) );
+                vals.reserve( mat->rows( ) );
+                for( std::size_t r = 0; r < mat->rows( ); ++r ) {
+                    vals.push_back( K::sum( mat->data( ) + r * mat->cols( ),
+                                            mat->cols( ) ) );
+                }
+                return std::make_shared<ARR>( env, res );
+            }
+        };
+
+        /// sums of every column; rows are added as a whole
+        struct sum_cols {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                auto err = check( "sum_cols", par, 1 );
+                if( err ) {
+                    return err;
+                }
+                auto mat = objects::cast_matrix( par[0].get( ) );
+                auto res = std::make_shared<packed>( objects::type::FLOAT );
+                auto &vals( res->floats( ) );
+                vals.resize( mat->cols( ) );
+                for( std::size_t r = 0; r < mat->rows( ); ++r ) {
+                    K::binary<K::add_op>( vals.data( ), false,
+                                          mat->data( ) + r * mat->cols( ),
+                                          false, vals.data( ), vals.size( ) );
+                }
+                return std::make_shared<ARR>( env, res );
+            }
+        };
+
+        static
+        void load( environment::sptr &env,
+                   const std::string &name = "matrix" )
+        {
+            using BC = builtin::common;
+            auto mod_env = environment::make(env);
+            auto mod = objects::module::make( mod_env, name );
+
+            mod_env->set_const( "make",      BC::make( mod_env, make { } ) );
+            mod_env->set_const( "zeros",     BC::make( mod_env, zeros { } ) );
+            mod_env->set_const( "identity",  BC::make( mod_env,
+                                                       identity { } ) );
+            mod_env->set_const( "to_array",  BC::make( mod_env,
+                                                       to_array { } ) );
+            mod_env->set_const( "rows",      BC::make( mod_env, rows { } ) );
+            mod_env->set_const( "cols",      BC::make( mod_env, cols { } ) );
+            mod_env->set_const( "transpose", BC::make( mod_env,
+                                                       transpose { } ) );
+            mod_env->set_const( "row",       BC::make( mod_env,
+                                                       line<true> { } ) );
+            mod_env->set_const( "col",       BC::make( mod_env,
+                                                       line<false> { } ) );
+            mod_env->set_const( "sum",       BC::make( mod_env, sum { } ) );
+            mod_env->set_const( "mean",      BC::make( mod_env, mean { } ) );
+            mod_env->set_const( "min",       BC::make( mod_env,
+                                                       extreme<false> { } ) );
+            mod_env->set_const( "max",       BC::make( mod_env,
+                                                       extreme<true> { } ) );
+            mod_env->set_const( "sum_rows",  BC::make( mod_env,
+                                                       sum_rows { } ) );
+            mod_env->set_const( "sum_cols",  BC::make( mod_env,
+                                                       sum_cols { } ) );
+
+            env->set_const( name, mod );
+        }
+    };
+
+}}
+
+#endif // MATRIX_H
@@ -0,0 +1,183 @@
+#ifndef MICO_MODULES_TIME_H
+#define MICO_MODULES_TIME_H
+
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "mico/builtin.h"
+#include "mico/builtin/common.h"
+#include "mico/builtin/caller.h"
+#include "mico/objects/module.h"
+#include "mico/parser.h"
+
+namespace mico { namespace modules {
+
+    struct time {
+
+        using clock_type = std::chrono::steady_clock;
+        using eval_call  = builtin::caller::eval_call;
+
+        static
+        std::int64_t now_ns( )
+        {
+            auto d = clock_type::now( ).time_since_epoch( );
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(d)
+                  .count( );
+        }
+
+        /// time.clock( ) monotonic nanoseconds
+        struct clock {
+            objects::sptr operator ( )( objects::slist &, environment::sptr )
+            {
+                return objects::integer::make( now_ns( ) );
+            }
+        };
+
+        /// time.bench( fn, iterations, params... )
+        /// returns { min, median, p95, mean, ops_per_sec, ... }
+        /// every value is in nanoseconds per call with the cost of calling
+        /// an empty function subtracted
+        struct bench {
+
+            explicit
+            bench( eval_call ev )
+                :ev_(std::move(ev))
+            { }
+
+            static
+            double measure( builtin::caller &call, std::size_t count,
+                            std::vector<double> *times,
+                            objects::sptr *fail )
+            {
+                times->clear( );
+                times->reserve( count );
+                for( std::size_t i = 0; i < count; ++i ) {
+                    auto start = now_ns( );
+                    auto res = call( );
+                    auto stop = now_ns( );
+                    if( res->get_type( ) == objects::type::FAILURE ) {
+                        *fail = res;
+                        return 0;
+                    }
+                    times->push_back( static_cast<double>(stop - start) );
+                }
+                std::sort( times->begin( ), times->end( ) );
+                return times->empty( ) ? 0 : (*times)[times->size( ) / 2];
+            }
+
+            static
+            double percentile( const std::vector<double> &sorted, double p )
+            {
+                auto id = static_cast<std::size_t>(p * (sorted.size( ) - 1));
+                return sorted[id];
+            }
+
+            objects::sptr empty_function( )
+            {
+                auto prog = parser::parse( "fn( ...p ) { }" );
+                if( !prog.errors( ).empty( ) ) {
+                    return nullptr;
+                }
+                return ev_( &prog );
+            }
+
+            static
+            void set( objects::table::sptr &t, environment::sptr &env,
+                      const std::string &key, objects::sptr val )
+            {
+                t->set( env.get( ), objects::string::make( key ), val );
+            }
+
+            objects::sptr operator ( )( objects::slist &pp,
+                                        environment::sptr e )
+            {
+                static const auto line = __LINE__;
+                using objects::error;
+                using FLT = objects::floating;
+
+                if( pp.size( ) < 2 || !builtin::caller::is_callable( pp[0] )
+                  || pp[1]->get_type( ) != objects::type::INTEGER ) {
+                    return error::make( tokens::position( line, 0 ),
+                              "'bench' expects a function and a number "
+                              "of iterations" );
+                }
+
+                auto iters = objects::cast_int( pp[1].get( ) )->value( );
+                if( iters <= 0 ) {
+                    return error::make( tokens::position( line, 0 ),
+                              "'bench': invalid number of iterations ",
+                              iters );
+                }
+
+                auto count = static_cast<std::size_t>(iters);
+                auto warmup = std::max<std::size_t>( 1,
+                                      std::min<std::size_t>( count / 10,
+                                                             1000 ) );
+
+                objects::slist params( pp.begin( ) + 2, pp.end( ) );
+                objects::sptr fail;
+                std::vector<double> times;
+
+                /// call overhead
+                double overhead = 0;
+                auto empty = empty_function( );
+                if( empty ) {
+                    builtin::caller ecall( ev_, e, empty, params );
+                    measure( ecall, warmup, &times, &fail );
+                    overhead = measure( ecall, std::min<std::size_t>(
+                                                count, 10000 ),
+                                        &times, &fail );
+                    fail.reset( );
+                }
+
+                builtin::caller call( ev_, e, pp[0], params );
+                measure( call, warmup, &times, &fail );
+                if( !fail ) {
+                    measure( call, count, &times, &fail );
+                }
+                if( fail ) {
+                    return fail;
+                }
+
+                double total = 0;
+                for( auto &t: times ) {
+                    t = std::max( 0.0, t - overhead );
+                    total += t;
+                }
+                auto mean = total / static_cast<double>(times.size( ));
+
+                auto res = objects::table::make( e );
+                set( res, e, "iterations",  objects::integer::make( count ) );
+                set( res, e, "min",         FLT::make( times.front( ) ) );
+                set( res, e, "median",      FLT::make( percentile( times,
+                                                                   0.5 ) ) );
+                set( res, e, "p95",         FLT::make( percentile( times,
+                                                                   0.95 ) ) );
+                set( res, e, "mean",        FLT::make( mean ) );
+                set( res, e, "ops_per_sec", FLT::make( mean > 0
+                                                       ? 1e9 / mean
+                                                       : 0.0 ) );
+                set( res, e, "overhead",    FLT::make( overhead ) );
+                return res;
+            }
+
+            eval_call ev_;
+        };
+
+        static
+        void load( environment::sptr &env, eval_call ev,
+                   const std::string &name = "time" )
+        {
+            using BC = builtin::common;
+            auto mod_env = environment::make(env);
+            auto mod = objects::module::make( mod_env, name );
+            mod_env->set_const( "clock", BC::make( mod_env, clock { } ) );
+            mod_env->set_const( "bench", BC::make( mod_env, bench(ev) ) );
+            env->set_const( name, mod );
+        }
+    };
+
+}}
+
+#endif // TIME_H
@@ -0,0 +1,589 @@
+#ifndef MICO_MODULES_VEC_H
+#define MICO_MODULES_VEC_H
+
+#include <vector>
+#include <algorithm>
+
+#include "mico/builtin/common.h"
+#include "mico/objects/module.h"
+#include "mico/objects/array.h"
+#include "mico/objects/slices.h"
+#include "mico/objects/packed.h"
+#include "mico/modules/vec/kernels.h"
+
+#include "mico/environment.h"
+
+namespace mico { namespace modules {
+
+    /// Numeric arrays and slices as a whole. The elements of a packed
+    /// array are read in place; other arrays are copied to plain
+    /// numbers first. Results are packed arrays. Integers mixed with
+    /// floats are taken as floats
+    struct vec {
+
+        using K          = vec_kernels;
+        using int_type   = K::int_type;
+        using float_type = K::float_type;
+        using bool_type  = K::bool_type;
+        using packed     = objects::packed;
+        using ARR        = objects::array;
+        using INT        = objects::integer;
+        using FLT        = objects::floating;
+
+        /// an argument: a number or the elements of an array or a slice;
+        /// kind is INTEGER, FLOAT or BOOLEAN
+        struct operand {
+
+            operand( ) = default;
+            operand( const operand & ) = delete;
+            operand &operator = ( const operand & ) = delete;
+
+            bool number( ) const
+            {
+                return kind == objects::type::INTEGER
+                    || kind == objects::type::FLOAT;
+            }
+
+            /// integers become floats
+            void to_float( )
+            {
+                if( kind != objects::type::INTEGER ) {
+                    return;
+                }
+                if( scalar ) {
+                    float_value = static_cast<float_type>(int_value);
+                    floats = &float_value;
+                } else {
+                    float_copy.assign( ints, ints + size );
+                    floats = float_copy.data( );
+                }
+                kind = objects::type::FLOAT;
+            }
+
+            objects::type     kind   = objects::type::INTEGER;
+            bool              scalar = false;
+            std::size_t       size   = 0;
+            const int_type   *ints   = nullptr;
+            const float_type *floats = nullptr;
+            const bool_type  *bools  = nullptr;
+
+            int_type                int_value   = 0;
+            float_type              float_value = 0;
+            std::vector<int_type>   int_copy;
+            std::vector<float_type> float_copy;
+            std::vector<bool_type>  bool_copy;
+        };
+
+        /// false if `obj` is neither a number nor an array or a slice
+        /// of numbers or booleans
+        static
+        bool read( const objects::sptr &obj, operand &res )
+        {
+            switch( obj->get_type( ) ) {
+            case objects::type::INTEGER:
+                res.scalar    = true;
+                res.size      = 1;
+                res.int_value = objects::cast_int( obj.get( ) )->value( );
+                res.ints      = &res.int_value;
+                return true;
+            case objects::type::FLOAT:
+                res.kind        = objects::type::FLOAT;
+                res.scalar      = true;
+                res.size        = 1;
+                res.float_value = objects::cast_float( obj.get( ) )->value( );
+                res.floats      = &res.float_value;
+                return true;
+            default:
+                break;
+            }
+            std::size_t beg = 0;
+            std::size_t end = 0;
+            bool reversed   = false;
+            if( auto arr = elements( obj, beg, end, reversed ) ) {
+                return read( arr, beg, end, reversed, res );
+            }
+            return false;
+        }
+
+        /// the array and the range of the elements of an array or
+        /// a slice; nullptr for other objects
+        static
+        const ARR *elements( const objects::sptr &obj, std::size_t &beg,
+                             std::size_t &end, bool &reversed )
+        {
+            switch( obj->get_type( ) ) {
+            case objects::type::ARRAY: {
+                auto arr = objects::cast_array( obj.get( ) );
+                beg      = 0;
+                end      = arr->size( );
+                reversed = false;
+                return arr;
+            }
+            case objects::type::ASLICE: {
+                auto slc = objects::cast_aslice( obj.get( ) );
+                auto arr = slc->value( ).get( );
+                end      = std::min( slc->end( ), arr->size( ) );
+                beg      = std::min( slc->begin( ), end );
+                reversed = slc->reversed( );
+                return arr;
+            }
+            default:
+                break;
+            }
+            return nullptr;
+        }
+
+        static
+        bool is_number( objects::type t )
+        {
+            return t == objects::type::INTEGER || t == objects::type::FLOAT;
+        }
+
+        /// The error for the parameter `param` that was not accepted.
+        /// For an array or a slice it names the first element that is
+        /// not a number; with `booleans` an array that starts with
+        /// a boolean is checked for booleans instead
+        static
+        objects::sptr invalid( const char *name, std::size_t param,
+                               const objects::sptr &obj,
+                               bool booleans = false )
+        {
+            std::size_t beg = 0;
+            std::size_t end = 0;
+            bool reversed   = false;
+            auto arr = elements( obj, beg, end, reversed );
+            auto get = [&]( std::size_t id ) {
+                return arr->element( reversed ? end - 1 - id : beg + id );
+            };
+            if( arr && beg < end ) {
+                auto first = get( 0 )->get_type( );
+                for( std::size_t i = 0; i < end - beg; ++i ) {
+                    auto t = get( i )->get_type( );
+                    bool ok = booleans && first == objects::type::BOOLEAN
+                            ? t == first
+                            : is_number( t );
+                    if( !ok ) {
+                        return fail( name, "got an invalid element ", i,
+                                     " of parameter ", param, ": ", t );
+                    }
+                }
+            }
+            return fail( name, "got an invalid parameter ", param,
+                         ": ", obj->get_type( ) );
+        }
+
+        static
+        bool read( const ARR *arr, std::size_t beg, std::size_t end,
+                   bool reversed, operand &res )
+        {
+            res.size = end - beg;
+            auto &pack( arr->packed_storage( ) );
+            if( pack && !reversed ) {
+                res.kind = pack->kind( );
+                switch( res.kind ) {
+                case objects::type::INTEGER:
+                    res.ints = pack->ints( ).data( ) + beg;
+                    return true;
+                case objects::type::FLOAT:
+                    res.floats = pack->floats( ).data( ) + beg;
+                    return true;
+                case objects::type::BOOLEAN:
+                    res.bools = pack->bools( ).data( ) + beg;
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            auto get = [&]( std::size_t id ) {
+                return arr->element( reversed ? end - 1 - id : beg + id );
+            };
+
+            bool ints   = true;
+            bool floats = true;
+            bool bools  = true;
+            for( std::size_t i = 0; i < res.size; ++i ) {
+                auto t = get( i )->get_type( );
+                ints   = ints   && t == objects::type::INTEGER;
+                floats = floats && (t == objects::type::INTEGER
+                                 || t == objects::type::FLOAT);
+                bools  = bools  && t == objects::type::BOOLEAN;
+            }
+
+            if( ints ) {
+                res.int_copy.reserve( res.size );
+                for( std::size_t i = 0; i < res.size; ++i ) {
+                    auto v = get( i );
+                    res.int_copy.push_back(
+                            objects::cast_int( v.get( ) )->value( ) );
+                }
+                res.ints = res.int_copy.data( );
+            } else if( floats ) {
+                res.kind = objects::type::FLOAT;
+                res.float_copy.reserve( res.size );
+                for( std::size_t i = 0; i < res.size; ++i ) {
+                    auto v = get( i );
+                    res.float_copy.push_back( number( v ) );
+                }
+                res.floats = res.float_copy.data( );
+            } else if( bools ) {
+                res.kind = objects::type::BOOLEAN;
+                res.bool_copy.reserve( res.size );
+                for( std::size_t i = 0; i < res.size; ++i ) {
+                    auto v = get( i );
+                    res.bool_copy.push_back(
+                            objects::cast_bool( v.get( ) )->value( ) );
+                }
+                res.bools = res.bool_copy.data( );
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        static
+        float_type number( const objects::sptr &val )
+        {
+            if( val->get_type( ) == objects::type::INTEGER ) {
+                auto v = objects::cast_int( val.get( ) )->value( );
+                return static_cast<float_type>(v);
+            }
+            return objects::cast_float( val.get( ) )->value( );
+        }
+
+        template <typename ...Args>
+        static
+        objects::sptr fail( const char *name, Args&&...args )
+        {
+            static const auto line = __LINE__;
+            return objects::error::make( tokens::position( line, 0 ),
+                                         "'vec.", name, "' ",
+                                         std::forward<Args>(args)... );
+        }
+
+        static
+        objects::sptr make_array( environment::sptr env,
+                                  std::shared_ptr<packed> pack )
+        {
+            return std::make_shared<ARR>( env, std::move(pack) );
+        }
+
+        /// reads `par` and checks that all of them are arrays of numbers
+        /// or numbers and that the arrays have the same size. The result
+        /// is empty or an error
+        static
+        objects::sptr read_numbers( const char *name, objects::slist &par,
+                                    operand *ops, std::size_t count,
+                                    bool allow_scalar )
+        {
+            if( par.size( ) != count ) {
+                return fail( name, "expects ", count, " parameter(s)" );
+            }
+            bool array = false;
+            for( std::size_t i = 0; i < count; ++i ) {
+                if( !read( par[i], ops[i] ) || !ops[i].number( ) ) {
+                    return invalid( name, i + 1, par[i] );
+                }
+                if( ops[i].scalar && !allow_scalar ) {
+                    return fail( name, "expects an array; got ",
+                                 par[i]->get_type( ) );
+                }
+                if( !ops[i].scalar ) {
+                    if( array && ops[i].size != ops[0].size ) {
+                        return fail( name, "got arrays of different sizes" );
+                    }
+                    array = true;
+                }
+            }
+            if( !array ) {
+                return fail( name, "expects an array" );
+            }
+            return objects::sptr( );
+        }
+
+        static
+        std::size_t result_size( const operand &a, const operand &b )
+        {
+            return a.scalar ? b.size : a.size;
+        }
+
+        static
+        bool has_zero( const operand &a )
+        {
+            if( a.kind == objects::type::INTEGER ) {
+                return std::find( a.ints, a.ints + a.size, 0 )
+                    != a.ints + a.size;
+            }
+            return std::find( a.floats, a.floats + a.size, 0.0 )
+                != a.floats + a.size;
+        }
+
+        /// add, sub, mul, div: an array and an array or a number
+        template <typename Op>
+        struct arith {
+
+            explicit
+            arith( const char *name )
+                :name_(name)
+            { }
+
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                operand ops[2];
+                auto err = read_numbers( name_, par, ops, 2, true );
+                if( err ) {
+                    return err;
+                }
+                auto &a( ops[0] );
+                auto &b( ops[1] );
+                if( Op::divides && has_zero( b ) ) {
+                    return fail( name_, "Division by zero." );
+                }
+
+                auto count = result_size( a, b );
+                if( a.kind == objects::type::FLOAT
+                 || b.kind == objects::type::FLOAT )
+                {
+                    a.to_float( );
+                    b.to_float( );
+                    auto res = std::make_shared<packed>(
+                                                objects::type::FLOAT );
+                    res->floats( ).resize( count );
+                    K::binary<Op>( a.floats, a.scalar, b.floats, b.scalar,
+                                   res->floats( ).data( ), count );
+                    return make_array( env, res );
+                }
+                auto res = std::make_shared<packed>( objects::type::INTEGER );
+                res->ints( ).resize( count );
+                K::binary<Op>( a.ints, a.scalar, b.ints, b.scalar,
+                               res->ints( ).data( ), count );
+                return make_array( env, res );
+            }
+
+            const char *name_;
+        };
+
+        /// lt, le, gt, ge, eq, ne: an array of booleans
+        template <typename Op>
+        struct compare {
+
+            explicit
+            compare( const char *name )
+                :name_(name)
+            { }
+
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                operand ops[2];
+                auto err = read_numbers( name_, par, ops, 2, true );
+                if( err ) {
+                    return err;
+                }
+                auto &a( ops[0] );
+                auto &b( ops[1] );
+
+                auto count = result_size( a, b );
+                auto res = std::make_shared<packed>( objects::type::BOOLEAN );
+                res->bools( ).resize( count );
+                if( a.kind == objects::type::FLOAT
+                 || b.kind == objects::type::FLOAT )
+                {
+                    a.to_float( );
+                    b.to_float( );
+                    K::compare<Op>( a.floats, a.scalar, b.floats, b.scalar,
+                                    res->bools( ).data( ), count );
+                } else {
+                    K::compare<Op>( a.ints, a.scalar, b.ints, b.scalar,
+                                    res->bools( ).data( ), count );
+                }
+                return make_array( env, res );
+            }
+
+            const char *name_;
+        };
+
+        struct sum {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                operand a;
+                auto err = read_numbers( "sum", par, &a, 1, false );
+                if( err ) {
+                    return err;
+                }
+                if( a.kind == objects::type::FLOAT ) {
+                    return FLT::make( K::sum( a.floats, a.size ) );
+                }
+                return INT::make( K::sum( a.ints, a.size ) );
+            }
+        };
+
+        struct mean {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                operand a;
+                auto err = read_numbers( "mean", par, &a, 1, false );
+                if( err ) {
+                    return err;
+                } else if( a.size == 0 ) {
+                    return fail( "mean", "got an empty array" );
+                }
+                auto count = static_cast<float_type>(a.size);
+                if( a.kind == objects::type::FLOAT ) {
+                    return FLT::make( K::sum( a.floats, a.size ) / count );
+                }
+                auto total = static_cast<float_type>(K::sum( a.ints, a.size ));
+                return FLT::make( total / count );
+            }
+        };
+
+        template <bool Max>
+        struct extreme {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                const char *name = Max ? "max" : "min";
+                operand a;
+                auto err = read_numbers( name, par, &a, 1, false );
+                if( err ) {
+                    return err;
+                } else if( a.size == 0 ) {
+                    return fail( name, "got an empty array" );
+                }
+                if( a.kind == objects::type::FLOAT ) {
+                    return FLT::make( K::extreme<Max>( a.floats, a.size ) );
+                }
+                return INT::make( K::extreme<Max>( a.ints, a.size ) );
+            }
+        };
+
+        struct dot {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr )
+            {
+                operand ops[2];
+                auto err = read_numbers( "dot", par, ops, 2, false );
+                if( err ) {
+                    return err;
+                }
+                auto &a( ops[0] );
+                auto &b( ops[1] );
+                if( a.kind == objects::type::FLOAT
+                 || b.kind == objects::type::FLOAT )
+                {
+                    a.to_float( );
+                    b.to_float( );
+                    return FLT::make( K::dot( a.floats, b.floats, a.size ) );
+                }
+                return INT::make( K::dot( a.ints, b.ints, a.size ) );
+            }
+        };
+
+        struct cumsum {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                operand a;
+                auto err = read_numbers( "cumsum", par, &a, 1, false );
+                if( err ) {
+                    return err;
+                }
+                auto res = std::make_shared<packed>( a.kind );
+                if( a.kind == objects::type::FLOAT ) {
+                    res->floats( ).resize( a.size );
+                    K::cumulative( a.floats, res->floats( ).data( ), a.size );
+                } else {
+                    res->ints( ).resize( a.size );
+                    K::cumulative( a.ints, res->ints( ).data( ), a.size );
+                }
+                return make_array( env, res );
+            }
+        };
+
+        /// the elements of an array where a mask of the same size is true
+        struct select {
+            objects::sptr operator ( )( objects::slist &par,
+                                        environment::sptr env )
+            {
+                if( par.size( ) != 2 ) {
+                    return fail( "select", "expects 2 parameter(s)" );
+                }
+                operand a;
+                operand mask;
+                if( !read( par[0], a ) || a.scalar ) {
+                    return invalid( "select", 1, par[0], true );
+                }
+                if( !read( par[1], mask ) || mask.scalar
+                 || mask.kind != objects::type::BOOLEAN )
+                {
+                    return fail( "select", "expects an array of booleans; "
+                                 "got ", par[1]->get_type( ) );
+                }
+                if( a.size != mask.size ) {
+                    return fail( "select", "got arrays of different sizes" );
+                }
+                auto res = std::make_shared<packed>( a.kind );
+                switch( a.kind ) {
+                case objects::type::INTEGER:
+                    K::select( a.ints, mask.bools, a.size, res->ints( ) );
+                    break;
+                case objects::type::FLOAT:
+                    K::select( a.floats, mask.bools, a.size, res->floats( ) );
+                    break;
+                default:
+                    K::select( a.bools, mask.bools, a.size, res->bools( ) );
+                    break;
+                }
+                return make_array( env, res );
+            }
+        };
+
+        static
+        void load( environment::sptr &env, const std::string &name = "vec" )
+        {
+            using BC = builtin::common;
+            auto mod_env = environment::make(env);
+            auto mod = objects::module::make( mod_env, name );
+
+            mod_env->set_const( "sum",    BC::make( mod_env, sum { } ) );
+            mod_env->set_const( "mean",   BC::make( mod_env, mean { } ) );
+            mod_env->set_const( "min",    BC::make( mod_env,
+                                                    extreme<false> { } ) );
+            mod_env->set_const( "max",    BC::make( mod_env,
+                                                    extreme<true> { } ) );
+            mod_env->set_const( "dot",    BC::make( mod_env, dot { } ) );
+            mod_env->set_const( "cumsum", BC::make( mod_env, cumsum { } ) );
+            mod_env->set_const( "select", BC::make( mod_env, select { } ) );
+
+            add_call<arith<K::add_op> >( mod_env, "add" );
+            add_call<arith<K::sub_op> >( mod_env, "sub" );
+            add_call<arith<K::mul_op> >( mod_env, "mul" );
+            add_call<arith<K::div_op> >( mod_env, "div" );
+
+            add_call<compare<K::lt_op> >( mod_env, "lt" );
+            add_call<compare<K::le_op> >( mod_env, "le" );
+            add_call<compare<K::gt_op> >( mod_env, "gt" );
+            add_call<compare<K::ge_op> >( mod_env, "ge" );
+            add_call<compare<K::eq_op> >( mod_env, "eq" );
+            add_call<compare<K::ne_op> >( mod_env, "ne" );
+
+            env->set_const( name, mod );
+        }
+
+    private:
+
+        template <typename CallT>
+        static
+        void add_call( environment::sptr &mod_env, const char *name )
+        {
+            using BC = builtin::common;
+            mod_env->set_const( name, BC::make( mod_env, CallT( name ) ) );
+        }
+    };
+
+}}
+
+#endif // VEC_H
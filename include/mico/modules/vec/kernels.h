@@ -0,0 +1,925 @@
+#ifndef MICO_MODULES_VEC_KERNELS_H
+#define MICO_MODULES_VEC_KERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+#if (!defined(DISABLE_SIMD) || !DISABLE_SIMD) && defined(__GNUC__) \
+    && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#include <emmintrin.h>
+#define MICO_VEC_SSE2 1
+#else
+#define MICO_VEC_SSE2 0
+#endif
+
+#if MICO_VEC_SSE2 && defined(__x86_64__)
+#include <immintrin.h>
+#define MICO_VEC_AVX2 1
+#define MICO_VEC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MICO_VEC_AVX2 0
+#endif
+
+namespace mico { namespace modules {
+
+    /// Loops of the vec module over plain numbers. A kernel has an SSE2
+    /// version and an AVX2 one that runs if the cpu has AVX2; without
+    /// SSE2 it is a plain loop. Sums of floats go in lanes, so the last
+    /// bits of a sum can differ from the ones of a loop in order.
+    /// Integers wrap around on overflow.
+    /// An operand with the `scalar` flag is one value for every element
+    struct vec_kernels {
+
+        using int_type   = std::int64_t;
+        using float_type = double;
+        using bool_type  = std::uint8_t;
+
+        static
+        bool has_avx2( )
+        {
+#if MICO_VEC_AVX2
+            static const bool res = []( ) {
+                __builtin_cpu_init( );
+                return __builtin_cpu_supports( "avx2" ) != 0;
+            }( );
+            return res;
+#else
+            return false;
+#endif
+        }
+
+        static
+        int_type wrap( std::uint64_t val )
+        {
+            return static_cast<int_type>(val);
+        }
+
+        static
+        std::uint64_t uns( int_type val )
+        {
+            return static_cast<std::uint64_t>(val);
+        }
+
+        /// arithmetic; `int_lanes` if the integer version has SIMD too
+        struct add_op {
+            static const bool int_lanes = true;
+            static const bool divides   = false;
+            static float_type scalar( float_type a, float_type b )
+            {
+                return a + b;
+            }
+            static int_type scalar( int_type a, int_type b )
+            {
+                return wrap( uns( a ) + uns( b ) );
+            }
+#if MICO_VEC_SSE2
+            static __m128d lanes( __m128d a, __m128d b )
+            {
+                return _mm_add_pd( a, b );
+            }
+            static __m128i lanes( __m128i a, __m128i b )
+            {
+                return _mm_add_epi64( a, b );
+            }
+#endif
+#if MICO_VEC_AVX2
+            MICO_VEC_TARGET_AVX2
+            static __m256d lanes( __m256d a, __m256d b )
+            {
+                return _mm256_add_pd( a, b );
+            }
+            MICO_VEC_TARGET_AVX2
+            static __m256i lanes( __m256i a, __m256i b )
+            {
+                return _mm256_add_epi64( a, b );
+            }
+#endif
+        };
+
+        struct sub_op {
+            static const bool int_lanes = true;
+            static const bool divides   = false;
+            static float_type scalar( float_type a, float_type b )
+            {
+                return a - b;
+            }
+            static int_type scalar( int_type a, int_type b )
+            {
+                return wrap( uns( a ) - uns( b ) );
+            }
+#if MICO_VEC_SSE2
+            static __m128d lanes( __m128d a, __m128d b )
+            {
+                return _mm_sub_pd( a, b );
+            }
+            static __m128i lanes( __m128i a, __m128i b )
+            {
+                return _mm_sub_epi64( a, b );
+            }
+#endif
+#if MICO_VEC_AVX2
+            MICO_VEC_TARGET_AVX2
+            static __m256d lanes( __m256d a, __m256d b )
+            {
+                return _mm256_sub_pd( a, b );
+            }
+            MICO_VEC_TARGET_AVX2
+            static __m256i lanes( __m256i a, __m256i b )
+            {
+                return _mm256_sub_epi64( a, b );
+            }
+#endif
+        };
+
+        /// neither SSE2 nor AVX2 multiply 64 bit integers
+        struct mul_op {
+            static const bool int_lanes = false;
+            static const bool divides   = false;
+            static float_type scalar( float_type a, float_type b )
+            {
+                return a * b;
+            }
+            static int_type scalar( int_type a, int_type b )
+            {
+                return wrap( uns( a ) * uns( b ) );
+            }
+#if MICO_VEC_SSE2
+            static __m128d lanes( __m128d a, __m128d b )
+            {
+                return _mm_mul_pd( a, b );
+            }
+#endif
+#if MICO_VEC_AVX2
+            MICO_VEC_TARGET_AVX2
+            static __m256d lanes( __m256d a, __m256d b )
+            {
+                return _mm256_mul_pd( a, b );
+            }
+#endif
+        };
+
+        /// the divisors must not be zero
+        struct div_op {
+            static const bool int_lanes = false;
+            static const bool divides   = true;
+            static float_type scalar( float_type a, float_type b )
+            {
+                return a / b;
+            }
+            static int_type scalar( int_type a, int_type b )
+            {
+                return a / b;
+            }
+#if MICO_VEC_SSE2
+            static __m128d lanes( __m128d a, __m128d b )
+            {
+                return _mm_div_pd( a, b );
+            }
+#endif
+#if MICO_VEC_AVX2
+            MICO_VEC_TARGET_AVX2
+            static __m256d lanes( __m256d a, __m256d b )
+            {
+                return _mm256_div_pd( a, b );
+            }
+#endif
+        };
+
+        /// comparisons; the lanes of a result are all ones or all zeros.
+        /// SSE2 has no compare of 64 bit integers
+#if MICO_VEC_AVX2
+#define MICO_VEC_INT_CMP( expr )                                    \
+            MICO_VEC_TARGET_AVX2                                    \
+            static __m256i lanes( __m256i a, __m256i b )            \
+            {                                                       \
+                return expr;                                        \
+            }
+#define MICO_VEC_NOT( val ) \
+            _mm256_xor_si256( val, _mm256_set1_epi64x( -1 ) )
+#else
+#define MICO_VEC_INT_CMP( expr )
+#endif
+
+#if MICO_VEC_SSE2
+#define MICO_VEC_FLOAT_CMP( sse )                                   \
+            static __m128d lanes( __m128d a, __m128d b )            \
+            {                                                       \
+                return sse( a, b );                                 \
+            }
+#else
+#define MICO_VEC_FLOAT_CMP( sse )
+#endif
+
+#if MICO_VEC_AVX2
+#define MICO_VEC_FLOAT_CMP_AVX( pred )                              \
+            MICO_VEC_TARGET_AVX2                                    \
+            static __m256d lanes( __m256d a, __m256d b )            \
+            {                                                       \
+                return _mm256_cmp_pd( a, b, pred );                 \
+            }
+#else
+#define MICO_VEC_FLOAT_CMP_AVX( pred )
+#endif
+
+#define MICO_VEC_CMP_OP( name, op, sse, pred, int_expr )            \
+        struct name {                                               \
+            template <typename T>                                   \
+            static bool scalar( T a, T b )                          \
+            {                                                       \
+                return a op b;                                      \
+            }                                                       \
+            MICO_VEC_FLOAT_CMP( sse )                               \
+            MICO_VEC_FLOAT_CMP_AVX( pred )                          \
+            MICO_VEC_INT_CMP( int_expr )                            \
+        };
+
+        MICO_VEC_CMP_OP( lt_op, < , _mm_cmplt_pd,  _CMP_LT_OQ,
+                         _mm256_cmpgt_epi64( b, a ) )
+        MICO_VEC_CMP_OP( le_op, <=, _mm_cmple_pd,  _CMP_LE_OQ,
+                         MICO_VEC_NOT( _mm256_cmpgt_epi64( a, b ) ) )
+        MICO_VEC_CMP_OP( gt_op, > , _mm_cmpgt_pd,  _CMP_GT_OQ,
+                         _mm256_cmpgt_epi64( a, b ) )
+        MICO_VEC_CMP_OP( ge_op, >=, _mm_cmpge_pd,  _CMP_GE_OQ,
+                         MICO_VEC_NOT( _mm256_cmpgt_epi64( b, a ) ) )
+        MICO_VEC_CMP_OP( eq_op, ==, _mm_cmpeq_pd,  _CMP_EQ_OQ,
+                         _mm256_cmpeq_epi64( a, b ) )
+        MICO_VEC_CMP_OP( ne_op, !=, _mm_cmpneq_pd, _CMP_NEQ_UQ,
+                         MICO_VEC_NOT( _mm256_cmpeq_epi64( a, b ) ) )
+
+#undef MICO_VEC_CMP_OP
+#undef MICO_VEC_FLOAT_CMP_AVX
+#undef MICO_VEC_FLOAT_CMP
+#undef MICO_VEC_NOT
+#undef MICO_VEC_INT_CMP
+
+        /////////////////// reductions
+
+        static
+        float_type sum( const float_type *a, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                return sum_avx2( a, n );
+            }
+#endif
+            std::size_t i = 0;
+            float_type res = 0;
+#if MICO_VEC_SSE2
+            auto acc0 = _mm_setzero_pd( );
+            auto acc1 = _mm_setzero_pd( );
+            for( ; i + 4 <= n; i += 4 ) {
+                acc0 = _mm_add_pd( acc0, _mm_loadu_pd( a + i ) );
+                acc1 = _mm_add_pd( acc1, _mm_loadu_pd( a + i + 2 ) );
+            }
+            res = horizontal( _mm_add_pd( acc0, acc1 ) );
+#endif
+            for( ; i < n; ++i ) {
+                res += a[i];
+            }
+            return res;
+        }
+
+        static
+        int_type sum( const int_type *a, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                return sum_avx2( a, n );
+            }
+#endif
+            std::size_t i = 0;
+            std::uint64_t res = 0;
+#if MICO_VEC_SSE2
+            auto acc = _mm_setzero_si128( );
+            for( ; i + 2 <= n; i += 2 ) {
+                acc = _mm_add_epi64( acc, load( a + i ) );
+            }
+            res = horizontal( acc );
+#endif
+            for( ; i < n; ++i ) {
+                res += uns( a[i] );
+            }
+            return wrap( res );
+        }
+
+        static
+        float_type dot( const float_type *a, const float_type *b,
+                        std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                return dot_avx2( a, b, n );
+            }
+#endif
+            std::size_t i = 0;
+            float_type res = 0;
+#if MICO_VEC_SSE2
+            auto acc0 = _mm_setzero_pd( );
+            auto acc1 = _mm_setzero_pd( );
+            for( ; i + 4 <= n; i += 4 ) {
+                acc0 = _mm_add_pd( acc0, _mm_mul_pd( _mm_loadu_pd( a + i ),
+                                                     _mm_loadu_pd( b + i ) ) );
+                acc1 = _mm_add_pd( acc1,
+                                   _mm_mul_pd( _mm_loadu_pd( a + i + 2 ),
+                                               _mm_loadu_pd( b + i + 2 ) ) );
+            }
+            res = horizontal( _mm_add_pd( acc0, acc1 ) );
+#endif
+            for( ; i < n; ++i ) {
+                res += a[i] * b[i];
+            }
+            return res;
+        }
+
+        static
+        int_type dot( const int_type *a, const int_type *b, std::size_t n )
+        {
+            std::uint64_t res = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                res += uns( a[i] ) * uns( b[i] );
+            }
+            return wrap( res );
+        }
+
+        /// the least or the greatest element; `n` must not be zero
+        template <bool Max>
+        static
+        float_type extreme( const float_type *a, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                return extreme_avx2<Max>( a, n );
+            }
+#endif
+            std::size_t i = 0;
+            float_type res = a[0];
+#if MICO_VEC_SSE2
+            if( n >= 2 ) {
+                auto acc = _mm_loadu_pd( a );
+                for( i = 2; i + 2 <= n; i += 2 ) {
+                    auto v = _mm_loadu_pd( a + i );
+                    acc = Max ? _mm_max_pd( acc, v ) : _mm_min_pd( acc, v );
+                }
+                double lanes[2];
+                _mm_storeu_pd( lanes, acc );
+                res = pick<Max>( lanes[0], lanes[1] );
+            }
+#endif
+            for( ; i < n; ++i ) {
+                res = pick<Max>( res, a[i] );
+            }
+            return res;
+        }
+
+        template <bool Max>
+        static
+        int_type extreme( const int_type *a, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                return extreme_avx2<Max>( a, n );
+            }
+#endif
+            int_type res = a[0];
+            for( std::size_t i = 1; i < n; ++i ) {
+                res = pick<Max>( res, a[i] );
+            }
+            return res;
+        }
+
+        /////////////////// elementwise
+
+        template <typename Op>
+        static
+        void binary( const float_type *a, bool as,
+                     const float_type *b, bool bs,
+                     float_type *out, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                binary_avx2<Op>( a, as, b, bs, out, n );
+                return;
+            }
+#endif
+            std::size_t i = 0;
+#if MICO_VEC_SSE2
+            if( n > 0 ) {
+                auto sa = _mm_set1_pd( *a );
+                auto sb = _mm_set1_pd( *b );
+                for( ; i + 2 <= n; i += 2 ) {
+                    auto va = as ? sa : _mm_loadu_pd( a + i );
+                    auto vb = bs ? sb : _mm_loadu_pd( b + i );
+                    _mm_storeu_pd( out + i, Op::lanes( va, vb ) );
+                }
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+
+        template <typename Op>
+        static
+        void binary( const int_type *a, bool as,
+                     const int_type *b, bool bs,
+                     int_type *out, std::size_t n )
+        {
+            std::integral_constant<bool, Op::int_lanes> lanes;
+            binary_ints<Op>( lanes, a, as, b, bs, out, n );
+        }
+
+        template <typename Op>
+        static
+        void compare( const float_type *a, bool as,
+                      const float_type *b, bool bs,
+                      bool_type *out, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                compare_avx2<Op>( a, as, b, bs, out, n );
+                return;
+            }
+#endif
+            std::size_t i = 0;
+#if MICO_VEC_SSE2
+            if( n > 0 ) {
+                auto sa = _mm_set1_pd( *a );
+                auto sb = _mm_set1_pd( *b );
+                for( ; i + 2 <= n; i += 2 ) {
+                    auto va = as ? sa : _mm_loadu_pd( a + i );
+                    auto vb = bs ? sb : _mm_loadu_pd( b + i );
+                    auto m  = _mm_movemask_pd( Op::lanes( va, vb ) );
+                    put_mask( out + i, static_cast<unsigned>(m), 2 );
+                }
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+
+        template <typename Op>
+        static
+        void compare( const int_type *a, bool as,
+                      const int_type *b, bool bs,
+                      bool_type *out, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                compare_avx2<Op>( a, as, b, bs, out, n );
+                return;
+            }
+#endif
+            for( std::size_t i = 0; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+
+        /// `out` gets the sums of the first 1, 2, ... n elements
+        template <typename T>
+        static
+        void cumulative( const T *a, T *out, std::size_t n )
+        {
+            T acc = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                acc = add_op::scalar( acc, a[i] );
+                out[i] = acc;
+            }
+        }
+
+        /// appends the elements of `a` that have a non zero mask byte
+        template <typename T, typename ContT>
+        static
+        void select( const T *a, const bool_type *mask, std::size_t n,
+                     ContT &out )
+        {
+            std::size_t count = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                count += (mask[i] != 0);
+            }
+            out.reserve( out.size( ) + count );
+            for( std::size_t i = 0; i < n; ++i ) {
+                if( mask[i] ) {
+                    out.push_back( a[i] );
+                }
+            }
+        }
+
+        /// `c` = `a` * `b` for row-major `a` (n x k), `b` (k x m) and
+        /// `c` (n x m). The loops go over blocks that stay in the cache;
+        /// every element of `c` still gets its products in the order of
+        /// `k`, so the result does not depend on SSE2 or AVX2
+        static
+        void matmul( const float_type *a, const float_type *b,
+                     float_type *c, std::size_t n, std::size_t k,
+                     std::size_t m )
+        {
+            static const std::size_t block_i = 64;
+            static const std::size_t block_k = 128;
+            static const std::size_t block_j = 256;
+
+            bool avx = has_avx2( );
+            std::fill( c, c + n * m, float_type( 0 ) );
+            for( std::size_t i0 = 0; i0 < n; i0 += block_i ) {
+                auto i1 = std::min( n, i0 + block_i );
+                for( std::size_t p0 = 0; p0 < k; p0 += block_k ) {
+                    auto p1 = std::min( k, p0 + block_k );
+                    for( std::size_t j0 = 0; j0 < m; j0 += block_j ) {
+                        auto len = std::min( m - j0, block_j );
+                        for( std::size_t i = i0; i < i1; ++i ) {
+                            auto row = c + i * m + j0;
+                            for( std::size_t p = p0; p < p1; ++p ) {
+                                axpy( avx, a[i * k + p], b + p * m + j0,
+                                      row, len );
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        /// `out` (cols x rows) gets `a` (rows x cols) transposed;
+        /// tile by tile, so both sides are read and written in the cache
+        static
+        void transpose( const float_type *a, float_type *out,
+                        std::size_t rows, std::size_t cols )
+        {
+            static const std::size_t tile = 32;
+            for( std::size_t r0 = 0; r0 < rows; r0 += tile ) {
+                auto r1 = std::min( rows, r0 + tile );
+                for( std::size_t c0 = 0; c0 < cols; c0 += tile ) {
+                    auto c1 = std::min( cols, c0 + tile );
+                    for( std::size_t r = r0; r < r1; ++r ) {
+                        for( std::size_t c = c0; c < c1; ++c ) {
+                            out[c * rows + r] = a[r * cols + c];
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+
+        /// `y` += `x` * `val`
+        static
+        void axpy( bool avx, float_type val, const float_type *x,
+                   float_type *y, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( avx ) {
+                axpy_avx2( val, x, y, n );
+                return;
+            }
+#else
+            (void)avx;
+#endif
+            std::size_t i = 0;
+#if MICO_VEC_SSE2
+            auto v = _mm_set1_pd( val );
+            auto body = n & ~std::size_t( 3 );
+            for( ; i < body; i += 4 ) {
+                auto y0 = _mm_add_pd( _mm_loadu_pd( y + i ),
+                                      _mm_mul_pd( _mm_loadu_pd( x + i ), v ) );
+                auto y1 = _mm_add_pd( _mm_loadu_pd( y + i + 2 ),
+                                      _mm_mul_pd( _mm_loadu_pd( x + i + 2 ),
+                                                  v ) );
+                _mm_storeu_pd( y + i, y0 );
+                _mm_storeu_pd( y + i + 2, y1 );
+            }
+#endif
+            for( ; i < n; ++i ) {
+                y[i] += x[i] * val;
+            }
+        }
+
+        template <bool Max, typename T>
+        static
+        T pick( T a, T b )
+        {
+            return Max ? (b > a ? b : a) : (b < a ? b : a);
+        }
+
+        /// bit `k` of a movemask of up to 4 lanes goes to byte `k`;
+        /// the shifted copies of the bits do not overlap. Only the SIMD
+        /// paths call it, so the bytes are little endian
+        static
+        void put_mask( bool_type *out, unsigned mask, unsigned count )
+        {
+            std::uint32_t bytes = (mask * 0x00204081u) & 0x01010101u;
+            std::memcpy( out, &bytes, count );
+        }
+
+        template <typename Op>
+        static
+        void binary_ints( std::false_type,
+                          const int_type *a, bool as,
+                          const int_type *b, bool bs,
+                          int_type *out, std::size_t n )
+        {
+            for( std::size_t i = 0; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+
+        template <typename Op>
+        static
+        void binary_ints( std::true_type,
+                          const int_type *a, bool as,
+                          const int_type *b, bool bs,
+                          int_type *out, std::size_t n )
+        {
+#if MICO_VEC_AVX2
+            if( has_avx2( ) ) {
+                binary_ints_avx2<Op>( a, as, b, bs, out, n );
+                return;
+            }
+#endif
+            std::size_t i = 0;
+#if MICO_VEC_SSE2
+            if( n > 0 ) {
+                auto sa = _mm_set1_epi64x( *a );
+                auto sb = _mm_set1_epi64x( *b );
+                for( ; i + 2 <= n; i += 2 ) {
+                    auto va = as ? sa : load( a + i );
+                    auto vb = bs ? sb : load( b + i );
+                    _mm_storeu_si128( reinterpret_cast<__m128i *>(out + i),
+                                      Op::lanes( va, vb ) );
+                }
+            }
+#endif
+            for( ; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+
+#if MICO_VEC_SSE2
+        static
+        __m128i load( const int_type *a )
+        {
+            return _mm_loadu_si128( reinterpret_cast<const __m128i *>(a) );
+        }
+
+        static
+        float_type horizontal( __m128d val )
+        {
+            double lanes[2];
+            _mm_storeu_pd( lanes, val );
+            return lanes[0] + lanes[1];
+        }
+
+        static
+        std::uint64_t horizontal( __m128i val )
+        {
+            std::uint64_t lanes[2];
+            _mm_storeu_si128( reinterpret_cast<__m128i *>(lanes), val );
+            return lanes[0] + lanes[1];
+        }
+#endif
+
+#if MICO_VEC_AVX2
+        MICO_VEC_TARGET_AVX2
+        static
+        __m256i load256( const int_type *a )
+        {
+            return _mm256_loadu_si256( reinterpret_cast<const __m256i *>(a) );
+        }
+
+        MICO_VEC_TARGET_AVX2
+        static
+        float_type horizontal( __m256d val )
+        {
+            double lanes[4];
+            _mm256_storeu_pd( lanes, val );
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        }
+
+        MICO_VEC_TARGET_AVX2
+        static
+        void axpy_avx2( float_type val, const float_type *x,
+                        float_type *y, std::size_t n )
+        {
+            std::size_t i = 0;
+            auto v = _mm256_set1_pd( val );
+            for( ; i + 8 <= n; i += 8 ) {
+                auto y0 = _mm256_add_pd( _mm256_loadu_pd( y + i ),
+                            _mm256_mul_pd( _mm256_loadu_pd( x + i ), v ) );
+                auto y1 = _mm256_add_pd( _mm256_loadu_pd( y + i + 4 ),
+                            _mm256_mul_pd( _mm256_loadu_pd( x + i + 4 ), v ) );
+                _mm256_storeu_pd( y + i, y0 );
+                _mm256_storeu_pd( y + i + 4, y1 );
+            }
+            for( ; i < n; ++i ) {
+                y[i] += x[i] * val;
+            }
+        }
+
+        MICO_VEC_TARGET_AVX2
+        static
+        float_type sum_avx2( const float_type *a, std::size_t n )
+        {
+            std::size_t i = 0;
+            auto acc0 = _mm256_setzero_pd( );
+            auto acc1 = _mm256_setzero_pd( );
+            for( ; i + 8 <= n; i += 8 ) {
+                acc0 = _mm256_add_pd( acc0, _mm256_loadu_pd( a + i ) );
+                acc1 = _mm256_add_pd( acc1, _mm256_loadu_pd( a + i + 4 ) );
+            }
+            float_type res = horizontal( _mm256_add_pd( acc0, acc1 ) );
+            for( ; i < n; ++i ) {
+                res += a[i];
+            }
+            return res;
+        }
+
+        MICO_VEC_TARGET_AVX2
+        static
+        int_type sum_avx2( const int_type *a, std::size_t n )
+        {
+            std::size_t i = 0;
+            auto acc = _mm256_setzero_si256( );
+            for( ; i + 4 <= n; i += 4 ) {
+                acc = _mm256_add_epi64( acc, load256( a + i ) );
+            }
+            std::uint64_t lanes[4];
+            _mm256_storeu_si256( reinterpret_cast<__m256i *>(lanes), acc );
+            std::uint64_t res = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            for( ; i < n; ++i ) {
+                res += uns( a[i] );
+            }
+            return wrap( res );
+        }
+
+        MICO_VEC_TARGET_AVX2
+        static
+        float_type dot_avx2( const float_type *a, const float_type *b,
+                             std::size_t n )
+        {
+            std::size_t i = 0;
+            auto acc0 = _mm256_setzero_pd( );
+            auto acc1 = _mm256_setzero_pd( );
+            for( ; i + 8 <= n; i += 8 ) {
+                acc0 = _mm256_add_pd( acc0,
+                            _mm256_mul_pd( _mm256_loadu_pd( a + i ),
+                                           _mm256_loadu_pd( b + i ) ) );
+                acc1 = _mm256_add_pd( acc1,
+                            _mm256_mul_pd( _mm256_loadu_pd( a + i + 4 ),
+                                           _mm256_loadu_pd( b + i + 4 ) ) );
+            }
+            float_type res = horizontal( _mm256_add_pd( acc0, acc1 ) );
+            for( ; i < n; ++i ) {
+                res += a[i] * b[i];
+            }
+            return res;
+        }
+
+        template <bool Max>
+        MICO_VEC_TARGET_AVX2
+        static
+        float_type extreme_avx2( const float_type *a, std::size_t n )
+        {
+            std::size_t i = 0;
+            float_type res = a[0];
+            if( n >= 4 ) {
+                auto acc = _mm256_loadu_pd( a );
+                for( i = 4; i + 4 <= n; i += 4 ) {
+                    auto v = _mm256_loadu_pd( a + i );
+                    acc = Max ? _mm256_max_pd( acc, v )
+                              : _mm256_min_pd( acc, v );
+                }
+                double lanes[4];
+                _mm256_storeu_pd( lanes, acc );
+                res = pick<Max>( pick<Max>( lanes[0], lanes[1] ),
+                                 pick<Max>( lanes[2], lanes[3] ) );
+            }
+            for( ; i < n; ++i ) {
+                res = pick<Max>( res, a[i] );
+            }
+            return res;
+        }
+
+        template <bool Max>
+        MICO_VEC_TARGET_AVX2
+        static
+        int_type extreme_avx2( const int_type *a, std::size_t n )
+        {
+            std::size_t i = 0;
+            int_type res = a[0];
+            if( n >= 4 ) {
+                auto acc = load256( a );
+                for( i = 4; i + 4 <= n; i += 4 ) {
+                    auto v = load256( a + i );
+                    auto m = Max ? _mm256_cmpgt_epi64( v, acc )
+                                 : _mm256_cmpgt_epi64( acc, v );
+                    acc = _mm256_blendv_epi8( acc, v, m );
+                }
+                int_type lanes[4];
+                _mm256_storeu_si256( reinterpret_cast<__m256i *>(lanes), acc );
+                res = pick<Max>( pick<Max>( lanes[0], lanes[1] ),
+                                 pick<Max>( lanes[2], lanes[3] ) );
+            }
+            for( ; i < n; ++i ) {
+                res = pick<Max>( res, a[i] );
+            }
+            return res;
+        }
+
+        template <typename Op>
+        MICO_VEC_TARGET_AVX2
+        static
+        void binary_avx2( const float_type *a, bool as,
+                          const float_type *b, bool bs,
+                          float_type *out, std::size_t n )
+        {
+            std::size_t i = 0;
+            if( n > 0 ) {
+                auto sa = _mm256_set1_pd( *a );
+                auto sb = _mm256_set1_pd( *b );
+                for( ; i + 4 <= n; i += 4 ) {
+                    auto va = as ? sa : _mm256_loadu_pd( a + i );
+                    auto vb = bs ? sb : _mm256_loadu_pd( b + i );
+                    _mm256_storeu_pd( out + i, Op::lanes( va, vb ) );
+                }
+            }
+            for( ; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+
+        template <typename Op>
+        MICO_VEC_TARGET_AVX2
+        static
+        void binary_ints_avx2( const int_type *a, bool as,
+                               const int_type *b, bool bs,
+                               int_type *out, std::size_t n )
+        {
+            std::size_t i = 0;
+            if( n > 0 ) {
+                auto sa = _mm256_set1_epi64x( *a );
+                auto sb = _mm256_set1_epi64x( *b );
+                for( ; i + 4 <= n; i += 4 ) {
+                    auto va = as ? sa : load256( a + i );
+                    auto vb = bs ? sb : load256( b + i );
+                    _mm256_storeu_si256( reinterpret_cast<__m256i *>(out + i),
+                                         Op::lanes( va, vb ) );
+                }
+            }
+            for( ; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+
+        template <typename Op>
+        MICO_VEC_TARGET_AVX2
+        static
+        void compare_avx2( const float_type *a, bool as,
+                           const float_type *b, bool bs,
+                           bool_type *out, std::size_t n )
+        {
+            std::size_t i = 0;
+            if( n > 0 ) {
+                auto sa = _mm256_set1_pd( *a );
+                auto sb = _mm256_set1_pd( *b );
+                for( ; i + 4 <= n; i += 4 ) {
+                    auto va = as ? sa : _mm256_loadu_pd( a + i );
+                    auto vb = bs ? sb : _mm256_loadu_pd( b + i );
+                    auto m  = _mm256_movemask_pd( Op::lanes( va, vb ) );
+                    put_mask( out + i, static_cast<unsigned>(m), 4 );
+                }
+            }
+            for( ; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+
+        template <typename Op>
+        MICO_VEC_TARGET_AVX2
+        static
+        void compare_avx2( const int_type *a, bool as,
+                           const int_type *b, bool bs,
+                           bool_type *out, std::size_t n )
+        {
+            std::size_t i = 0;
+            if( n > 0 ) {
+                auto sa = _mm256_set1_epi64x( *a );
+                auto sb = _mm256_set1_epi64x( *b );
+                for( ; i + 4 <= n; i += 4 ) {
+                    auto va = as ? sa : load256( a + i );
+                    auto vb = bs ? sb : load256( b + i );
+                    auto m  = _mm256_movemask_pd(
+                                _mm256_castsi256_pd( Op::lanes( va, vb ) ) );
+                    put_mask( out + i, static_cast<unsigned>(m), 4 );
+                }
+            }
+            for( ; i < n; ++i ) {
+                out[i] = Op::scalar( as ? *a : a[i], bs ? *b : b[i] );
+            }
+        }
+#endif
+    };
+
+}}
+
+#endif // VEC_KERNELS_H
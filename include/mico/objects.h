@@ -27,6 +27,7 @@
 #include "mico/objects/continue.h"
 #include "mico/objects/infinite.h"
 #include "mico/objects/type.h"
+#include "mico/objects/matrix.h"
 
 namespace mico { namespace objects {
 
@@ -65,6 +66,7 @@ namespace mico { namespace objects {
     MICO_DEFINE_CAST_FUNC( rslice,      type::RSLICE    )
     MICO_DEFINE_CAST_FUNC( inf,         type::INF_OBJ   )
     MICO_DEFINE_CAST_FUNC( type,        type::TYPE_OBJ  )
+    MICO_DEFINE_CAST_FUNC( matrix,      type::MATRIX    )
 
 #if !defined(DISABLE_MACRO) || !DISABLE_MACRO
     MICO_DEFINE_CAST_FUNC( quote,       type::QUOTE     )
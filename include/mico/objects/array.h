@@ -2,7 +2,10 @@
 #define MICO_OBJECTS_ARRAY_H
 
 #include <deque>
+#include <vector>
 #include "mico/objects/base.h"
+#include "mico/objects/pvector.h"
+#include "mico/objects/packed.h"
 #include "mico/objects/reference.h"
 #include "mico/objects/null.h"
 #include "mico/objects/collectable.h"
@@ -10,6 +13,42 @@
 
 namespace mico { namespace objects {
 
+    /// A reference to an element of a packed array. The element has no
+    /// object to refer to, so the reference keeps a copy and writes it
+    /// back on every change. It becomes stale when the elements of the
+    /// array are moved in place or the index is out of the array
+    template <typename ArrayT>
+    class element_ref: public impl<type::REFERENCE> {
+        using parent_type = impl<type::REFERENCE>;
+    public:
+
+        element_ref( std::shared_ptr<ArrayT> arr, std::size_t id,
+                     objects::sptr val )
+            :parent_type(arr->env( ).get( ), std::move(val), true)
+            ,arr_(std::move(arr))
+            ,id_(id)
+            ,moves_(arr_->moves( ))
+        { }
+
+        bool stale( ) const override
+        {
+            return moves_ != arr_->moves( ) || id_ >= arr_->size( );
+        }
+
+        void set_value( const environment *my_env, value_type val ) override
+        {
+            if( !stale( ) ) {
+                parent_type::set_value( my_env, val );
+                arr_->set_at( id_, std::move(val) );
+            }
+        }
+
+    private:
+        std::shared_ptr<ArrayT> arr_;
+        std::size_t             id_;
+        std::size_t             moves_;
+    };
+
     template <>
     class impl<type::ARRAY>: public collectable<type::ARRAY> {
         using this_type = impl<type::ARRAY>;
@@ -19,13 +58,32 @@ namespace mico { namespace objects {
 
         using sptr       = std::shared_ptr<this_type>;
         using cont       = impl<type::REFERENCE>;
-        using cont_sptr  = std::shared_ptr<cont>;
-        using value_type = std::deque<cont_sptr>;
+        using value_type = std::deque<objects::sptr>;
+        using value_sptr = std::shared_ptr<value_type>;
+        using tree_type  = pvector<objects::sptr>;
+        using packed_type = packed;
+        using packed_sptr = std::shared_ptr<packed_type>;
 
         using slice_type = impl<type::ASLICE>;
 
         impl( environment::sptr env )
             :collectable<type::ARRAY>(env)
+            ,value_(std::make_shared<value_type>( ))
+        { }
+
+        impl( environment::sptr env, value_sptr val )
+            :collectable<type::ARRAY>(env)
+            ,value_(std::move(val))
+        { }
+
+        impl( environment::sptr env, tree_type val )
+            :collectable<type::ARRAY>(env)
+            ,tree_(std::move(val))
+        { }
+
+        impl( environment::sptr env, packed_sptr val )
+            :collectable<type::ARRAY>(env)
+            ,packed_(std::move(val))
         { }
 
         std::string str( ) const override
@@ -33,31 +91,132 @@ namespace mico { namespace objects {
             std::ostringstream oss;
             oss << "[";
             bool first = true;
-            for( auto &v: value( ) ) {
+            for_each( [&]( const objects::sptr &v ) {
                 if( first ) {
                     first = false;
                 } else {
                     oss << ", ";
                 }
-                oss << v->value( )->str( );
-            }
+                oss << v->str( );
+            } );
             oss << "]";
             return oss.str( );
         }
 
-        const value_type &value( ) const
+        std::size_t size( ) const override
+        {
+            return packed_ ? packed_->size( )
+                 : value_  ? value_->size( )
+                 : tree_.size( );
+        }
+
+        /// packed storage; empty if the elements are kept as objects
+        const packed_sptr &packed_storage( ) const
         {
-            return value_;
+            return packed_;
         }
 
-        std::size_t size( ) const override
+        /// `id` must be less than size( )
+        objects::sptr element( std::size_t id ) const
         {
-            return value_.size( );
+            if( packed_ ) {
+                return packed_->get( id );
+            }
+            return cont::slot_value( value_ ? (*value_)[id] : tree_.at( id ) );
         }
 
-        value_type &value( )
+        /// calls `call` with the values; see reference::make_slot
+        template <typename CallT>
+        void for_each( CallT call ) const
         {
-            return value_;
+            auto unref = [&call]( const objects::sptr &v ) {
+                call( cont::slot_value( v ) );
+            };
+            if( packed_ ) {
+                for( std::size_t i = 0; i < packed_->size( ); ++i ) {
+                    call( packed_->get( i ) );
+                }
+            } else if( value_ ) {
+                for( auto &v: *value_ ) {
+                    unref( v );
+                }
+            } else {
+                tree_.for_each( unref );
+            }
+        }
+
+        /// Clones share the elements until one of them is written.
+        /// The first write gets a private copy: every element is cloned
+        /// the same lazy way. A tree or packed storage becomes a flat
+        /// copy here too
+        value_type &mutable_value( )
+        {
+            if( !value_ || value_.use_count( ) > 1 ) {
+                auto copy = std::make_shared<value_type>( );
+                auto my_env = env( );
+                for_each( [&]( const objects::sptr &v ) {
+                    copy->emplace_back( cont::make_slot( my_env.get( ),
+                                                         v->clone( ) ) );
+                } );
+                value_  = copy;
+                tree_   = tree_type( );
+                packed_.reset( );
+            }
+            hash_ = 0;
+            return *value_;
+        }
+
+        /// Packed storage for a write; a shared one is copied first.
+        /// Elements that are about to be copied anyway are packed if
+        /// they are all of one packable type. Empty if they are not
+        packed_type *mutable_packed( )
+        {
+            if( packed_ ) {
+                if( packed_.use_count( ) > 1 ) {
+                    packed_ = std::make_shared<packed_type>( *packed_ );
+                }
+            } else if( !value_ || value_.use_count( ) > 1 ) {
+                packed_ = pack( );
+                if( packed_ ) {
+                    value_.reset( );
+                    tree_ = tree_type( );
+                }
+            }
+            if( packed_ ) {
+                hash_ = 0;
+            }
+            return packed_.get( );
+        }
+
+        /// Immutable arrays keep the elements in a persistent tree after
+        /// the first concatenation. The elements are shared with the flat
+        /// storage only if no clone can write them
+        const tree_type &tree( )
+        {
+            if( packed_ ) {
+                std::vector<objects::sptr> copy;
+                copy.reserve( packed_->size( ) );
+                for_each( [&]( const objects::sptr &v ) {
+                    copy.emplace_back( v );
+                } );
+                tree_ = tree_type( copy.begin( ), copy.end( ) );
+                packed_.reset( );
+            } else if( value_ ) {
+                if( value_.use_count( ) == 1 ) {
+                    tree_ = tree_type( value_->begin( ), value_->end( ) );
+                } else {
+                    auto my_env = env( );
+                    std::vector<objects::sptr> copy;
+                    copy.reserve( value_->size( ) );
+                    for_each( [&]( const objects::sptr &v ) {
+                        copy.emplace_back( cont::make_slot( my_env.get( ),
+                                                            v->clone( ) ) );
+                    } );
+                    tree_ = tree_type( copy.begin( ), copy.end( ) );
+                }
+                value_.reset( );
+            }
+            return tree_;
         }
 
         std::size_t fix_id( std::int64_t id ) const
@@ -71,18 +230,65 @@ namespace mico { namespace objects {
 
         bool valid_id( std::int64_t id ) const
         {
-            return fix_id(id) < value_.size( );
+            return fix_id(id) < size( );
         }
 
         objects::sptr at( std::int64_t id )
         {
             auto siz = fix_id( id );
 
-            if( siz < value_.size( ) ) {
-                return is_mutable( ) ? value_[siz] : value_[siz]->value( );
-            } else {
+            if( siz >= size( ) ) {
                 return nullptr;
+            } else if( !is_mutable( ) || packed_ ) {
+                return element( siz );
+            } else if( auto pack = mutable_packed( ) ) {
+                return pack->get( siz );
             }
+            return cont::slot_value( mutable_value( )[siz] );
+        }
+
+        /// `at` for an element that is going to be written: a mutable
+        /// array gives the reference of the slot (see reference::slot_ref)
+        /// or an element_ref if the elements are packed
+        static
+        objects::sptr ref_at( const sptr &arr, std::int64_t id )
+        {
+            auto siz = arr->fix_id( id );
+
+            if( siz >= arr->size( ) || !arr->is_mutable( ) ) {
+                return arr->at( id );
+            } else if( arr->packed_ || arr->mutable_packed( ) ) {
+                return pool::make_shared<element_ref<this_type> >( arr, siz,
+                                                arr->packed_->get( siz ) );
+            }
+            return cont::slot_ref( arr->env( ).get( ),
+                                   arr->mutable_value( )[siz] );
+        }
+
+        /// writes the element `id`; false if there is no such element
+        bool set_at( std::size_t id, objects::sptr val )
+        {
+            if( id >= size( ) ) {
+                return false;
+            } else if( packed_ && mutable_packed( )->set( id, val ) ) {
+                return true;
+            }
+            auto my_env = env( );
+            mutable_value( )[id] = cont::make_slot( my_env.get( ),
+                                                    std::move(val) );
+            return true;
+        }
+
+        /// Counts the in place moves of the elements (sort, unique...).
+        /// An element_ref made before a move does not write back
+        std::size_t moves( ) const
+        {
+            return moves_;
+        }
+
+        void moved( )
+        {
+            ++moves_;
         }
 
         objects::sptr at_obj( std::int64_t id )
@@ -93,7 +299,62 @@ namespace mico { namespace objects {
         void push( const environment * /*menv*/, objects::sptr val )
         {
             // mark in MY environment
-            value_.emplace_back( cont::make_var( env( ).get( ), val) );
+            auto my_env = env( );
+            hash_ = 0;
+            if( value_ && value_->empty( ) &&
+                packed_type::packable( val->get_type( ) ) )
+            {
+                packed_ = std::make_shared<packed_type>( val->get_type( ) );
+                value_.reset( );
+            }
+            if( packed_ ) {
+                if( mutable_packed( )->push( val ) ) {
+                    return;
+                }
+                mutable_value( );
+            }
+            if( !value_ ) {
+                tree_ = tree_.push_back( cont::make_slot( my_env.get( ),
+                                                          std::move(val) ) );
+            } else {
+                auto &vals( mutable_value( ) );
+                vals.emplace_back( cont::make_slot( my_env.get( ),
+                                                    std::move(val) ) );
+            }
+        }
+
+        /// `this + other`. An immutable result shares the elements
+        /// of both sides and takes O(log n)
+        objects::sptr concat( this_type *other )
+        {
+            auto my_env = env( );
+            if( is_mutable( ) ) {
+                auto res = clone( );
+                auto resarr = static_cast<this_type *>(res.get( ));
+                auto &opack( other->packed_ );
+                if( packed_ && opack && packed_->kind( ) == opack->kind( ) ) {
+                    resarr->mutable_packed( )->append( *opack );
+                    return res;
+                }
+                other->for_each( [&]( const objects::sptr &v ) {
+                    resarr->push( my_env.get( ), v );
+                } );
+                return res;
+            }
+
+            tree_type rtree;
+            if( other->is_mutable( ) ) {
+                std::vector<objects::sptr> vals;
+                vals.reserve( other->size( ) );
+                other->for_each( [&]( const objects::sptr &v ) {
+                    vals.emplace_back( cont::make_slot( my_env.get( ), v ) );
+                } );
+                rtree = tree_type( vals.begin( ), vals.end( ) );
+            } else {
+                rtree = other->tree( );
+            }
+            return std::make_shared<this_type>( my_env,
+                                                tree( ).concat( rtree ) );
         }
 
         static
@@ -102,25 +363,51 @@ namespace mico { namespace objects {
             return std::make_shared<this_type>( env );
         }
 
+        /// An immutable array keeps its hash if every element keeps
+        /// its own; a mutable one can be changed through its slots
         hash_type hash( ) const override
         {
+            if( known_hash( ) ) {
+                return hash_;
+            }
             auto init = static_cast<std::uint64_t>(get_type( ));
             std::uint64_t h = base::hash64( init );
-            for( auto &o: value( ) ) {
-                h = base::hash64( h + o->hash( ) );
+            bool stable = !is_mutable( );
+            for_each( [&]( const objects::sptr &val ) {
+                h = base::hash64( h + val->hash( ) );
+                stable = stable && val->hash_stable( );
+            } );
+            if( stable ) {
+                hash_ = h;
             }
             return h;
         }
 
+        bool hash_stable( ) const override
+        {
+            hash( );
+            return known_hash( );
+        }
+
         bool equal( const base *other ) const override
         {
             if( other->get_type( ) == get_type( ) ) {
                 auto o = static_cast<const this_type *>( other );
-                if( o->value( ).size( ) == value( ).size( ) ) {
-                    std::size_t id = value( ).size( );
+                if( value_ && o->value_ == value_ ) {
+                    return true;
+                } else if( packed_ && o->packed_ ) {
+                    return packed_ == o->packed_
+                        || packed_->equal( *o->packed_ );
+                } else if( known_hash( ) && o->known_hash( ) &&
+                           hash_ != o->hash_ )
+                {
+                    return false;
+                }
+                if( o->size( ) == size( ) ) {
+                    std::size_t id = size( );
                     while( id-- ) {
-                        auto other = o->value( )[id]->value( ).get( );
-                        if( !value( )[id]->equal( other ) ) {
+                        auto other = o->element( id ).get( );
+                        if( !element( id )->equal( other ) ) {
                             return false;
                         }
                     }
@@ -132,12 +419,13 @@ namespace mico { namespace objects {
 
         objects::sptr clone( ) const override
         {
-            auto res = make( env( ) );
-            for( auto &v: value_ ) {
-                auto clone = v->value( )->clone( );
-                res->push( v->env( ), clone );
-            }
+            auto res = packed_
+                     ? std::make_shared<this_type>( env( ), packed_ )
+                     : value_
+                     ? std::make_shared<this_type>( env( ), value_ )
+                     : std::make_shared<this_type>( env( ), tree_ );
             res->set_mutable( is_mutable( ) );
+            res->hash_ = is_mutable( ) ? 0 : hash_;
             return res;
         }
 
@@ -145,10 +433,10 @@ namespace mico { namespace objects {
         {
             using ast_type = ast::expressions::impl<ast::type::ARRAY>;
             auto res = ast::node::make<ast_type>(pos);
-            for( auto &v: value_ ) {
-                auto next = v->value( )->to_ast( pos );
+            for_each( [&]( const objects::sptr &v ) {
+                auto next = v->to_ast( pos );
                 res->value( ).emplace_back( ast::expression::cast( next ) );
-            }
+            } );
             if( is_mutable( ) ) {
                 auto mut = ast::expressions::mod_mut::make(std::move( res ));
                 return ast::node::uptr( std::move( mut ) );
@@ -158,7 +446,35 @@ namespace mico { namespace objects {
         }
 
     private:
-        value_type  value_;
+
+        bool known_hash( ) const
+        {
+            return hash_ && !is_mutable( );
+        }
+
+        /// the elements as packed storage if they can be
+        packed_sptr pack( ) const
+        {
+            if( size( ) == 0 || !packed_type::packable(
+                                        element( 0 )->get_type( ) ) )
+            {
+                return nullptr;
+            }
+            auto res = std::make_shared<packed_type>(
+                                        element( 0 )->get_type( ) );
+            res->reserve( size( ) );
+            bool packs = true;
+            for_each( [&]( const objects::sptr &v ) {
+                packs = packs && res->push( v );
+            } );
+            return packs ? res : nullptr;
+        }
+
+        value_sptr  value_;  /// flat storage; empty when tree_ is used
+        packed_sptr packed_; /// set instead of value_ for plain values
+        tree_type   tree_;
+        std::size_t moves_ = 0;
+        mutable hash_type hash_ = 0;
     };
 
     using array = impl<type::ARRAY>;
@@ -8,6 +8,7 @@
 
 #include "mico/ast.h"
 #include "mico/types.h"
+#include "mico/objects/hash.h"
 
 #if defined(DISABLE_SWITCH_WARNINGS)
 #ifdef __clang__
@@ -50,6 +51,7 @@ namespace mico { namespace objects {
         RSLICE      = 23,
         INF_OBJ     = 24,
         TYPE_OBJ    = 25,
+        MATRIX      = 26,
     };
 
     struct name {
@@ -83,6 +85,7 @@ namespace mico { namespace objects {
             case type::RSLICE     : return "OBJ_SLICE_RSTR";
             case type::INF_OBJ    : return "OBJ_INFINITE";
             case type::TYPE_OBJ   : return "OBJ_TYPE";
+            case type::MATRIX     : return "OBJ_MATRIX";
             }
             return "<invalid>";
         }
@@ -141,18 +144,24 @@ namespace mico { namespace objects {
         static
         std::size_t hash_combine( std::size_t s, const mico::string &key )
         {
-            std::size_t seed = s;
-            for( auto &a: key ) {
-                seed = hash_combine( seed, a );
-            }
-            return seed;
+            using symbol = mico::string::value_type;
+            return static_cast<std::size_t>(
+                    wyhash::get( key.data( ), key.size( ) * sizeof(symbol),
+                                 s ) );
         }
 
         virtual
         hash_type hash( ) const
         {
-            std::hash<std::string> h;
-            return h( str( ) )  ;
+            auto s = str( );
+            return wyhash::get( s.data( ), s.size( ), 0 );
+        }
+
+        /// the hash cannot change anymore; containers keep such hashes
+        virtual
+        bool hash_stable( ) const
+        {
+            return !is_mutable( );
         }
 
         virtual
@@ -164,8 +173,7 @@ namespace mico { namespace objects {
         static
         std::uint64_t hash64(uint64_t x)
         {
-            std::hash<std::uint64_t> h;
-            return h(x);
+            return wyhash::get( x );
         }
 
         virtual
@@ -179,6 +187,7 @@ namespace mico { namespace objects {
         {
             return (o->get_type( ) == type::ARRAY)
                 || (o->get_type( ) == type::TABLE)
+                || (o->get_type( ) == type::MATRIX)
                  ;
         }
 
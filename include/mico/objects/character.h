@@ -2,8 +2,11 @@
 #define MICO_OBJECTS_CHAR_H
 
 #include <string>
+#include <vector>
+#include <cstdint>
 #include <sstream>
 #include "mico/objects/base.h"
+#include "mico/objects/pool.h"
 #include "mico/expressions/string.h"
 
 #include "mico/types.h"
@@ -62,10 +65,14 @@ namespace mico { namespace objects {
             return h(value( ));
         }
 
+        /// Latin-1 characters are shared objects
         static
         sptr make( value_type val )
         {
-            return std::make_shared<this_type>( val );
+            if( static_cast<std::uint32_t>(val) < latin1 ) {
+                return shared( )[static_cast<std::size_t>(val)];
+            }
+            return pool::make_shared<this_type>( val );
         }
 
         bool equal( const base *other ) const override
@@ -79,7 +86,7 @@ namespace mico { namespace objects {
 
         objects::sptr clone( ) const override
         {
-            return std::make_shared<this_type>( value_ );
+            return make( value_ );
         }
 
         ast::node::uptr to_ast( tokens::position pos ) const override
@@ -90,6 +97,22 @@ namespace mico { namespace objects {
 
     private:
 
+        static const std::uint32_t latin1 = 256;
+
+        static
+        const std::vector<sptr> &shared( )
+        {
+            static const std::vector<sptr> values = []( ) {
+                std::vector<sptr> res;
+                for( std::uint32_t c = 0; c < latin1; ++c ) {
+                    res.emplace_back( std::make_shared<this_type>(
+                                            static_cast<value_type>(c) ) );
+                }
+                return res;
+            }( );
+            return values;
+        }
+
         value_type value_;
 
     };
@@ -43,6 +43,14 @@ namespace mico { namespace objects {
             return value_;
         }
 
+        hash_type hash( ) const override
+        {
+            std::hash<value_type> h;
+            std::size_t seed = h( value_ );
+            seed = hash_combine( seed, where_.line );
+            return hash_combine( seed, where_.pos );
+        }
+
         objects::sptr clone( ) const override
         {
             auto res = make( where_, value_ );
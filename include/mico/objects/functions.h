@@ -4,6 +4,7 @@
 #include "mico/objects/reference.h"
 #include "mico/objects/collectable.h"
 #include "mico/objects/null.h"
+#include "mico/objects/pool.h"
 
 #include "mico/expressions/fn.h"
 #include "mico/expressions/list.h"
@@ -37,6 +38,8 @@ namespace mico { namespace objects {
         using param_type = ast::expressions::list;
         using param_ptr  = param_type::sptr;
 
+        using lazy_ptr   = ast::expressions::lazy_body::sptr;
+
         impl( environment::sptr e, param_type::uptr par,
               body_type::uptr body, std::size_t start = 0)
             :collectable(e)
@@ -76,6 +79,16 @@ namespace mico { namespace objects {
             return oss.str( );
         }
 
+        /// the same fields str( ) shows
+        hash_type hash( ) const override
+        {
+            std::size_t seed = static_cast<std::size_t>(get_type( ));
+            seed = hash_combine( seed, param_size( ) );
+            seed = hash_combine( seed, start_param_ ? params_->value( ).size( )
+                                                    : 0 );
+            return hash_combine( seed, elipsis_ );
+        }
+
         static
         sptr make( environment::sptr e, param_type::uptr par,
                    ast::node::uptr body, std::size_t start = 0 )
@@ -88,8 +101,10 @@ namespace mico { namespace objects {
         sptr make( environment::sptr e,
                    this_type &other, std::size_t start )
         {
-            return std::make_shared<impl>( e, other.params_, other.body_,
-                                           start + other.start_param_ );
+            auto res = std::make_shared<impl>( e, other.params_, other.body_,
+                                               start + other.start_param_ );
+            res->lazy_ = other.lazy_;
+            return res;
         }
 
         static
@@ -98,9 +113,11 @@ namespace mico { namespace objects {
             if( other->start_param_ != 0 ) {
                 if( auto p = other->env( ) ) {
                     //auto np = environment::make( p->parent( ) );
-                    return std::make_shared<impl>( p->parent( ),
-                                                   other->params_,
-                                                   other->body_, 0 );
+                    auto res = std::make_shared<impl>( p->parent( ),
+                                                       other->params_,
+                                                       other->body_, 0 );
+                    res->lazy_ = other->lazy_;
+                    return res;
                 }
             }
             return other;
@@ -141,10 +158,28 @@ namespace mico { namespace objects {
             return body_.get( );
         }
 
+        void set_body( body_ptr val )
+        {
+            body_ = std::move(val);
+        }
+
+        /// tokens of the body if it is not parsed yet
+        const lazy_ptr &lazy( ) const
+        {
+            return lazy_;
+        }
+
+        void set_lazy( lazy_ptr val )
+        {
+            lazy_ = std::move(val);
+        }
+
         objects::sptr clone( ) const override
         {
-            return std::make_shared<this_type>( env( ), params_, body_,
-                                                start_param_ );
+            auto res = std::make_shared<this_type>( env( ), params_, body_,
+                                                    start_param_ );
+            res->lazy_ = lazy_;
+            return res;
         }
 
         ast::node::uptr to_ast( tokens::position pos ) const override
@@ -153,7 +188,10 @@ namespace mico { namespace objects {
             auto res = ast::node::make<ast_type>(pos);
 
             auto e = env( );
-            res->set_body( body_->clone( ) );
+            if( body_ ) {
+                res->set_body( body_->clone( ) );
+            }
+            res->set_lazy( lazy_ );
             res->set_params( params_->clone_me( ) );
 
             for( std::size_t i = 0; i < start_param_; ++i ) {
@@ -162,7 +200,7 @@ namespace mico { namespace objects {
 
                 if( p->get_type( ) == ast::type::IDENT ) {
                     auto id = static_cast<ast::expressions::ident *>(p.get( ));
-                    auto obj = e->get( id->value( ) );
+                    auto obj = e->get( id->sym( ) );
                     if( !obj ) {
                         throw std::logic_error( "Invalid object." );
                     }
@@ -184,6 +222,7 @@ namespace mico { namespace objects {
 
         param_ptr   params_;
         body_ptr    body_;
+        lazy_ptr    lazy_;
         std::size_t start_param_ = 0;
         bool        elipsis_ = false;
     };
@@ -222,6 +261,11 @@ namespace mico { namespace objects {
             return false;
         }
 
+        hash_type hash( ) const override
+        {
+            return base::hash64( reinterpret_cast<std::uintptr_t>(this) );
+        }
+
         virtual
         std::uintptr_t stub_number( ) const = 0;
 
@@ -284,16 +328,22 @@ namespace mico { namespace objects {
             return obj_;
         }
 
+        /// all tail calls look the same for equal( )
+        hash_type hash( ) const override
+        {
+            return base::hash64( static_cast<std::uint64_t>(get_type( )) );
+        }
+
         static
         sptr make( objects::sptr obj, objects::slist p, environment::sptr e )
         {
-            return std::make_shared<this_type>( obj, std::move(p), e );
+            return pool::make_shared<this_type>( obj, std::move(p), e );
         }
 
         static
         sptr make( objects::sptr obj, environment::sptr e )
         {
-            return std::make_shared<this_type>( obj, objects::slist { }, e );
+            return pool::make_shared<this_type>( obj, objects::slist { }, e );
         }
 
         objects::slist &params( )
@@ -303,7 +353,7 @@ namespace mico { namespace objects {
 
         std::shared_ptr<base> clone( ) const override
         {
-            return std::make_shared<this_type>( obj_, params_, env( ) );
+            return pool::make_shared<this_type>( obj_, params_, env( ) );
         }
 
         ast::node::uptr to_ast( tokens::position /*pos*/ ) const override
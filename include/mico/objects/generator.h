@@ -4,6 +4,7 @@
 #include <string>
 #include <sstream>
 #include "mico/objects/base.h"
+#include "mico/objects/pool.h"
 #include "mico/expressions/none.h"
 #include "mico/objects/array.h"
 #include "mico/objects/table.h"
@@ -37,6 +38,12 @@ namespace mico { namespace objects {
             return ast::expressions::null::make( );
         }
 
+        /// generators are equal if they print the same: "gen(<kind>)"
+        hash_type hash( ) const override
+        {
+            return base::hash64( static_cast<std::uint64_t>(get_type( )) );
+        }
+
         virtual void reset( ) = 0;
         virtual void next( ) = 0;
         virtual bool end( ) const = 0;
@@ -109,10 +116,11 @@ namespace mico { namespace objects {
                 return objects::integer::make( id_ );
             }
 
+            /// a reference to the element if the array is mutable
             objects::sptr get_val( ) override
             {
                 if( !end( ) ) {
-                    return object_->at( id_ );
+                    return objects::array::ref_at( object_, id_ );
                 }
                 return nullptr;
             }
@@ -120,13 +128,13 @@ namespace mico { namespace objects {
             static
             sptr make( objects::array::sptr obj )
             {
-                return std::make_shared<this_type>( obj, 1 );
+                return pool::make_shared<this_type>( obj, 1 );
             }
 
             static
             sptr make( objects::array::sptr obj, std::int64_t step )
             {
-                return std::make_shared<this_type>( obj, step );
+                return pool::make_shared<this_type>( obj, step );
             }
 
         private:
@@ -141,14 +149,14 @@ namespace mico { namespace objects {
         struct obj<type::TABLE>: public generator {
 
             using this_type = obj<type::TABLE>;
-            using iterator  = objects::table::value_type::iterator;
-            using const_iterator  = objects::table::value_type::const_iterator;
+            using iterator      = objects::table::value_type::iterator;
+            using tree_iterator = objects::table::tree_type::iterator;
 
             explicit
             obj<type::TABLE>( objects::table::sptr &obj )
                 :object_(obj)
             {
-                id_ = ibegin( );
+                reset( );
             }
 
             std::string str( ) const override
@@ -163,65 +171,81 @@ namespace mico { namespace objects {
                 return make( object_ );
             }
 
+            /// the loop keeps the storage it walks alive; a write to the
+            /// table after a clone moves the table to a copy
             void reset( ) override
             {
-                id_ = ibegin( );
+                if( object_->is_mutable( ) ) {
+                    object_->mutable_value( );
+                }
+                store_ = object_->storage( );
+                if( store_ ) {
+                    id_ = store_->begin( );
+                } else {
+                    tree_ = object_->tree( );
+                    tid_  = tree_.begin( );
+                }
             }
 
             void next( ) override
             {
                 if( !end( ) ) {
-                    ++id_;
+                    if( store_ ) {
+                        ++id_;
+                    } else {
+                        ++tid_;
+                    }
                 }
             }
 
-            iterator ibegin( )
-            {
-                return object_->value( ).begin( );
-            }
-
-            iterator iend( )
-            {
-                return object_->value( ).end( );
-            }
-
-            const_iterator cbegin( ) const
-            {
-                return object_->value( ).cbegin( );
-            }
-
-            const_iterator cend( ) const
+            iterator cend( ) const
             {
-                return object_->value( ).cend( );
+                return store_->end( );
             }
 
             bool end( ) const override
             {
-                return is_end( id_ );
+                return store_ ? is_end( id_ ) : tid_ == tree_.end( );
             }
 
-            bool is_end( const_iterator id ) const
+            bool is_end( const iterator &id ) const
             {
                 return id == cend( );
             }
 
             bool has_next( ) const override
             {
-                return !end( ) && !is_end( std::next( id_ ) );
+                if( end( ) ) {
+                    return false;
+                } else if( store_ ) {
+                    auto nxt = id_;
+                    return !is_end( ++nxt );
+                }
+                auto nxt = tid_;
+                return ++nxt != tree_.end( );
             }
 
+            /// the loop value is a reference only if the table is mutable
             objects::sptr get_val( ) override
             {
-                if( !end( ) ) {
-                    return id_->second;
+                using ref = objects::reference;
+                if( end( ) ) {
+                    return nullptr;
+                } else if( !store_ ) {
+                    return ref::slot_value( tid_.value( ) );
+                } else if( object_->is_mutable( ) ) {
+                    auto my_env = object_->env( );
+                    return ref::slot_ref( my_env.get( ),
+                                          store_->value( id_ ) );
                 }
-                return nullptr;
+                return ref::slot_value( id_.value( ) );
             }
 
             objects::sptr get_id( ) override
             {
                 if( !end( ) ) {
-                    return id_->first->clone( );
+                    return store_ ? id_.key( )->clone( )
+                                  : tid_.key( )->clone( );
                 }
                 return nullptr;
             }
@@ -229,12 +253,15 @@ namespace mico { namespace objects {
             static
             sptr make( objects::table::sptr obj )
             {
-                return std::make_shared<this_type>( obj );
+                return pool::make_shared<this_type>( obj );
             }
 
         private:
-            table::sptr    object_;
-            iterator       id_;
+            table::sptr                     object_;
+            objects::table::value_sptr      store_;
+            objects::table::tree_type       tree_;
+            iterator                        id_;
+            tree_iterator                   tid_;
         };
 
         using table = obj<type::TABLE>;
@@ -329,13 +356,13 @@ namespace mico { namespace objects {
             static
             sptr make( objects::string::sptr obj, std::int64_t step )
             {
-                return std::make_shared<this_type>( obj, step );
+                return pool::make_shared<this_type>( obj, step );
             }
 
             static
             sptr make( objects::string::sptr obj )
             {
-                return std::make_shared<this_type>( obj, 1 );
+                return pool::make_shared<this_type>( obj, 1 );
             }
 
         };
@@ -365,13 +392,13 @@ namespace mico { namespace objects {
             static
             sptr make( objects::rstring::sptr obj, std::int64_t step )
             {
-                return std::make_shared<this_type>( obj, step );
+                return pool::make_shared<this_type>( obj, step );
             }
 
             static
             sptr make( objects::rstring::sptr obj )
             {
-                return std::make_shared<this_type>( obj, 1 );
+                return pool::make_shared<this_type>( obj, 1 );
             }
 
         };
@@ -462,7 +489,7 @@ namespace mico { namespace objects {
             static
             sptr make( value_type stop, value_type step )
             {
-                return std::make_shared<this_type>( stop, step );
+                return pool::make_shared<this_type>( stop, step );
             }
 
         private:
@@ -548,14 +575,14 @@ namespace mico { namespace objects {
             static
             sptr make( value_type start, value_type stop, value_type step )
             {
-                return std::make_shared<this_type>( start, stop, step );
+                return pool::make_shared<this_type>( start, stop, step );
             }
 
             static
             sptr make( typename objects::intervals::obj<NumT>::sptr &obj,
                        value_type step )
             {
-                return std::make_shared<this_type>( obj->native( ).left( ),
+                return pool::make_shared<this_type>( obj->native( ).left( ),
                                                     obj->native( ).right( ),
                                                     step );
             }
@@ -625,7 +652,7 @@ namespace mico { namespace objects {
             objects::sptr get_val( ) override
             {
                 if( !end( ) ) {
-                    return object_->at( id_ );
+                    return object_->ref_at( id_ );
                 }
                 return nullptr;
             }
@@ -633,13 +660,13 @@ namespace mico { namespace objects {
             static
             sptr make( value_type obj )
             {
-                return std::make_shared<this_type>( obj, 1 );
+                return pool::make_shared<this_type>( obj, 1 );
             }
 
             static
             sptr make( value_type obj, std::int64_t step )
             {
-                return std::make_shared<this_type>( obj, step );
+                return pool::make_shared<this_type>( obj, step );
             }
 
         private:
@@ -0,0 +1,343 @@
+#ifndef MICO_OBJECTS_HAMT_H
+#define MICO_OBJECTS_HAMT_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include "mico/objects/pool.h"
+
+namespace mico { namespace objects {
+
+    /// Persistent hash map: a hash array mapped trie with 32 slots per
+    /// node. Every level takes the next 5 bits of the 64 bit hash; keys
+    /// with the same full hash share a collision node.
+    /// A node is never changed after it is built, so insert returns a new
+    /// map sharing every node but the path to the key: O(log32 n)
+    template <typename KeyT, typename ValueT,
+              typename HashT, typename EqualT>
+    class hamt {
+
+        struct node;
+        using node_sptr = std::shared_ptr<const node>;
+
+        struct entry {
+            std::uint64_t hash;
+            KeyT          key;
+            ValueT        value;
+            node_sptr     child; /// the slot holds a sub node if set
+        };
+
+        using entries = std::vector<entry>;
+
+        struct node {
+
+            node( std::uint32_t bm, entries val, bool coll )
+                :bitmap(bm)
+                ,collision(coll)
+                ,slots(std::move(val))
+            { }
+
+            std::uint32_t bitmap;
+            bool          collision;
+            entries       slots;
+        };
+
+        static const unsigned bits = 5;
+        static const unsigned mask = (1 << bits) - 1;
+
+    public:
+
+        class iterator {
+        public:
+
+            iterator( ) = default;
+
+            bool operator == ( const iterator &o ) const
+            {
+                return stack_ == o.stack_;
+            }
+
+            bool operator != ( const iterator &o ) const
+            {
+                return !(*this == o);
+            }
+
+            const KeyT &key( ) const
+            {
+                return current( ).key;
+            }
+
+            const ValueT &value( ) const
+            {
+                return current( ).value;
+            }
+
+            iterator &operator ++ ( )
+            {
+                ++stack_.back( ).second;
+                settle( );
+                return *this;
+            }
+
+        private:
+
+            friend class hamt;
+
+            using frame = std::pair<const node *, std::size_t>;
+
+            explicit
+            iterator( const node *root )
+            {
+                if( root ) {
+                    stack_.emplace_back( root, 0 );
+                    settle( );
+                }
+            }
+
+            const entry &current( ) const
+            {
+                auto &top( stack_.back( ) );
+                return top.first->slots[top.second];
+            }
+
+            /// moves to the next key-value slot
+            void settle( )
+            {
+                while( !stack_.empty( ) ) {
+                    auto &top( stack_.back( ) );
+                    if( top.second == top.first->slots.size( ) ) {
+                        stack_.pop_back( );
+                        if( !stack_.empty( ) ) {
+                            ++stack_.back( ).second;
+                        }
+                    } else if( auto &child = current( ).child ) {
+                        stack_.emplace_back( child.get( ), 0 );
+                    } else {
+                        return;
+                    }
+                }
+            }
+
+            std::vector<frame> stack_;
+        };
+
+        hamt( ) = default;
+
+        std::size_t size( ) const
+        {
+            return size_;
+        }
+
+        bool empty( ) const
+        {
+            return size_ == 0;
+        }
+
+        iterator begin( ) const
+        {
+            return iterator( root_.get( ) );
+        }
+
+        iterator end( ) const
+        {
+            return iterator( );
+        }
+
+        const ValueT *find( const KeyT &key ) const
+        {
+            auto hash = static_cast<std::uint64_t>(HashT( )( key ));
+            const node *cur = root_.get( );
+            unsigned shift = 0;
+            while( cur ) {
+                if( cur->collision ) {
+                    for( auto &e: cur->slots ) {
+                        if( e.hash == hash && EqualT( )( e.key, key ) ) {
+                            return &e.value;
+                        }
+                    }
+                    return nullptr;
+                }
+                auto bit = bit_of( hash, shift );
+                if( !(cur->bitmap & bit) ) {
+                    return nullptr;
+                }
+                auto &slot( cur->slots[index_of( cur->bitmap, bit )] );
+                if( slot.child ) {
+                    cur = slot.child.get( );
+                    shift += bits;
+                } else if( slot.hash == hash && EqualT( )( slot.key, key ) ) {
+                    return &slot.value;
+                } else {
+                    return nullptr;
+                }
+            }
+            return nullptr;
+        }
+
+        /// a new map with `key` set to `val`
+        hamt insert( KeyT key, ValueT val ) const
+        {
+            auto hash = static_cast<std::uint64_t>(HashT( )( key ));
+            bool added = false;
+            entry next { hash, std::move(key), std::move(val), nullptr };
+            hamt res;
+            res.root_ = root_ ? insert( root_, 0, std::move(next), added )
+                              : make_node( 0, std::move(next) );
+            res.size_ = size_ + ( (!root_ || added) ? 1 : 0 );
+            return res;
+        }
+
+        template <typename CallT>
+        void for_each( CallT call ) const
+        {
+            for_each( root_.get( ), call );
+        }
+
+    private:
+
+        static
+        std::uint32_t bit_of( std::uint64_t hash, unsigned shift )
+        {
+            return std::uint32_t(1) << ((hash >> shift) & mask);
+        }
+
+        static
+        std::size_t index_of( std::uint32_t bitmap, std::uint32_t bit )
+        {
+            return popcount( bitmap & (bit - 1) );
+        }
+
+        static
+        std::size_t popcount( std::uint32_t val )
+        {
+#if defined(__GNUC__)
+            return static_cast<std::size_t>(__builtin_popcount( val ));
+#else
+            val = val - ((val >> 1) & 0x55555555);
+            val = (val & 0x33333333) + ((val >> 2) & 0x33333333);
+            val = (val + (val >> 4)) & 0x0F0F0F0F;
+            return (val * 0x01010101) >> 24;
+#endif
+        }
+
+        static
+        node_sptr make_node( unsigned shift, entry val )
+        {
+            auto bit = bit_of( val.hash, shift );
+            entries slots;
+            slots.emplace_back( std::move(val) );
+            return pool::make_shared<node>( bit, std::move(slots), false );
+        }
+
+        /// a node for two entries that have the same bits before `shift`
+        static
+        node_sptr make_pair( unsigned shift, entry first, entry second )
+        {
+            if( first.hash == second.hash ) {
+                entries slots;
+                slots.emplace_back( std::move(first) );
+                slots.emplace_back( std::move(second) );
+                return pool::make_shared<node>( 0, std::move(slots), true );
+            }
+
+            auto fbit = bit_of( first.hash, shift );
+            auto sbit = bit_of( second.hash, shift );
+            entries slots;
+            if( fbit == sbit ) {
+                auto hash  = first.hash;
+                auto child = make_pair( shift + bits,
+                                        std::move(first), std::move(second) );
+                slots.emplace_back( entry { hash, KeyT( ), ValueT( ),
+                                            std::move(child) } );
+            } else if( fbit < sbit ) {
+                slots.emplace_back( std::move(first) );
+                slots.emplace_back( std::move(second) );
+            } else {
+                slots.emplace_back( std::move(second) );
+                slots.emplace_back( std::move(first) );
+            }
+            return pool::make_shared<node>( fbit | sbit, std::move(slots),
+                                            false );
+        }
+
+        static
+        node_sptr insert( const node_sptr &n, unsigned shift,
+                          entry val, bool &added )
+        {
+            if( n->collision ) {
+                auto hash = n->slots.front( ).hash;
+                if( hash != val.hash ) {
+                    /// goes one level down under a regular node
+                    entries slots;
+                    slots.emplace_back( entry { hash, KeyT( ), ValueT( ), n } );
+                    node_sptr wrap = pool::make_shared<node>(
+                                bit_of( hash, shift ), std::move(slots), false );
+                    return insert( wrap, shift, std::move(val), added );
+                }
+                entries slots( n->slots );
+                for( auto &e: slots ) {
+                    if( EqualT( )( e.key, val.key ) ) {
+                        e.value = std::move(val.value);
+                        return pool::make_shared<node>( 0, std::move(slots),
+                                                        true );
+                    }
+                }
+                added = true;
+                slots.emplace_back( std::move(val) );
+                return pool::make_shared<node>( 0, std::move(slots), true );
+            }
+
+            auto bit = bit_of( val.hash, shift );
+            auto idx = index_of( n->bitmap, bit );
+            entries slots( n->slots );
+
+            if( !(n->bitmap & bit) ) {
+                added = true;
+                slots.insert( slots.begin( ) + idx, std::move(val) );
+                return pool::make_shared<node>( n->bitmap | bit,
+                                                std::move(slots), false );
+            }
+
+            auto &slot( slots[idx] );
+            if( slot.child ) {
+                slot.child = insert( slot.child, shift + bits,
+                                     std::move(val), added );
+            } else if( slot.hash == val.hash &&
+                       EqualT( )( slot.key, val.key ) ) {
+                slot.value = std::move(val.value);
+            } else {
+                added = true;
+                auto hash = slot.hash;
+                auto child = make_pair( shift + bits,
+                                        std::move(slot), std::move(val) );
+                slot = entry { hash, KeyT( ), ValueT( ), std::move(child) };
+            }
+            return pool::make_shared<node>( n->bitmap, std::move(slots),
+                                            false );
+        }
+
+        template <typename CallT>
+        static
+        void for_each( const node *n, CallT &call )
+        {
+            if( !n ) {
+                return;
+            }
+            for( auto &e: n->slots ) {
+                if( e.child ) {
+                    for_each( e.child.get( ), call );
+                } else {
+                    call( e.key, e.value );
+                }
+            }
+        }
+
+        node_sptr   root_;
+        std::size_t size_ = 0;
+    };
+
+}}
+
+#endif // HAMT_H
@@ -0,0 +1,137 @@
+#ifndef MICO_OBJECTS_HASH_H
+#define MICO_OBJECTS_HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace mico { namespace objects {
+
+    /// Bulk hash of a byte buffer in the style of wyhash: 16 bytes per
+    /// 64x64->128 multiply, three independent lanes for the long inputs.
+    /// The result depends on the byte order of the host; it is never
+    /// stored anywhere
+    struct wyhash {
+
+        static
+        std::uint64_t get( const void *data, std::size_t len,
+                           std::uint64_t seed )
+        {
+            auto p = static_cast<const std::uint8_t *>(data);
+            seed ^= mix( seed ^ s0, s1 );
+
+            std::uint64_t a = 0;
+            std::uint64_t b = 0;
+            if( len <= 16 ) {
+                if( len >= 4 ) {
+                    auto mid = (len >> 3) << 2;
+                    a = (read32( p ) << 32) | read32( p + mid );
+                    b = (read32( p + len - 4 ) << 32)
+                      |  read32( p + len - 4 - mid );
+                } else if( len > 0 ) {
+                    a = read3( p, len );
+                }
+            } else {
+                auto rest = len;
+                if( rest > 48 ) {
+                    auto see1 = seed;
+                    auto see2 = seed;
+                    do {
+                        seed = mix( read64( p )      ^ s1,
+                                    read64( p + 8 )  ^ seed );
+                        see1 = mix( read64( p + 16 ) ^ s2,
+                                    read64( p + 24 ) ^ see1 );
+                        see2 = mix( read64( p + 32 ) ^ s3,
+                                    read64( p + 40 ) ^ see2 );
+                        p    += 48;
+                        rest -= 48;
+                    } while( rest > 48 );
+                    seed ^= see1 ^ see2;
+                }
+                while( rest > 16 ) {
+                    seed = mix( read64( p ) ^ s1, read64( p + 8 ) ^ seed );
+                    p    += 16;
+                    rest -= 16;
+                }
+                a = read64( p + rest - 16 );
+                b = read64( p + rest - 8 );
+            }
+            a ^= s1;
+            b ^= seed;
+            mum( a, b );
+            return mix( a ^ s0 ^ len, b ^ s1 );
+        }
+
+        /// one 64 bit value
+        static
+        std::uint64_t get( std::uint64_t val )
+        {
+            return mix( val ^ s0, s1 ^ 0x9e3779b97f4a7c15ULL );
+        }
+
+    private:
+
+        static const std::uint64_t s0 = 0xa0761d6478bd642fULL;
+        static const std::uint64_t s1 = 0xe7037ed1a0b428dbULL;
+        static const std::uint64_t s2 = 0x8ebc6af09c88c6e3ULL;
+        static const std::uint64_t s3 = 0x589965cc75374cc3ULL;
+
+        /// a * b as 128 bits; the low half goes to `a`, the high to `b`
+        static
+        void mum( std::uint64_t &a, std::uint64_t &b )
+        {
+#if defined(__SIZEOF_INT128__)
+            auto r = static_cast<unsigned __int128>(a) * b;
+            a = static_cast<std::uint64_t>(r);
+            b = static_cast<std::uint64_t>(r >> 64);
+#else
+            std::uint64_t ha = a >> 32, la = a & 0xFFFFFFFF;
+            std::uint64_t hb = b >> 32, lb = b & 0xFFFFFFFF;
+            std::uint64_t rh = ha * hb;
+            std::uint64_t rm0 = ha * lb;
+            std::uint64_t rm1 = hb * la;
+            std::uint64_t rl = la * lb;
+            std::uint64_t t  = rl + (rm0 << 32);
+            std::uint64_t c  = t < rl;
+            std::uint64_t lo = t + (rm1 << 32);
+            c += lo < t;
+            a = lo;
+            b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+        }
+
+        static
+        std::uint64_t mix( std::uint64_t a, std::uint64_t b )
+        {
+            mum( a, b );
+            return a ^ b;
+        }
+
+        static
+        std::uint64_t read64( const std::uint8_t *p )
+        {
+            std::uint64_t res;
+            std::memcpy( &res, p, sizeof(res) );
+            return res;
+        }
+
+        static
+        std::uint64_t read32( const std::uint8_t *p )
+        {
+            std::uint32_t res;
+            std::memcpy( &res, p, sizeof(res) );
+            return res;
+        }
+
+        static
+        std::uint64_t read3( const std::uint8_t *p, std::size_t len )
+        {
+            return (std::uint64_t(p[0]) << 16)
+                 | (std::uint64_t(p[len >> 1]) << 8)
+                 |  std::uint64_t(p[len - 1]);
+        }
+    };
+
+}}
+
+#endif // HASH_H
@@ -0,0 +1,387 @@
+#ifndef MICO_OBJECTS_HYBRID_H
+#define MICO_OBJECTS_HYBRID_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include "mico/objects/swiss.h"
+#include "mico/objects/shape.h"
+
+namespace mico { namespace objects {
+
+    /// Hash map with an array part in the style of the Lua tables.
+    /// A key that KeyOps maps to an index below the size of the array part
+    /// keeps only its value there; an empty value is a free slot. Other
+    /// keys go to a swiss_map. When the hash part has to grow, the array
+    /// part becomes the largest power of two that more than a half of the
+    /// indexed keys would fill. Keys are never removed, so the array part
+    /// never shrinks.
+    /// Until the hash part gets its first key, up to `max_fields` keys
+    /// that KeyOps takes as fields are kept as a record instead: a shared
+    /// shape and a vector of values. Any other key moves them to the
+    /// hash part for good.
+    ///
+    /// KeyOps, in addition to the swiss_map ones:
+    ///     static bool index( const KeyT &, std::uint8_t tag,
+    ///                        std::size_t &id );
+    ///     static KeyT key( std::size_t id );
+    ///     static bool field( const KeyT &, std::uint8_t tag );
+    template <typename KeyT, typename ValueT, typename KeyOps>
+    class hybrid_map {
+
+        using sparse_type = swiss_map<KeyT, ValueT, KeyOps>;
+
+        static const unsigned max_bits = 30;
+
+    public:
+
+        using shape_type = shape<KeyT, KeyOps>;
+        using shape_sptr = typename shape_type::sptr;
+
+        static const std::size_t max_fields = 16;
+
+        class iterator {
+        public:
+
+            iterator( ) = default;
+
+            /// array part keys are made by KeyOps::key
+            KeyT key( ) const
+            {
+                if( in_dense( ) ) {
+                    return KeyOps::key( pos_ );
+                } else if( in_fields( ) ) {
+                    return map_->shape_->key( pos_ - map_->dense_.size( ) );
+                }
+                return itr_->first;
+            }
+
+            const ValueT &value( ) const
+            {
+                if( in_dense( ) ) {
+                    return map_->dense_[pos_];
+                } else if( in_fields( ) ) {
+                    return map_->fields_[pos_ - map_->dense_.size( )];
+                }
+                return itr_->second;
+            }
+
+            iterator &operator ++ ( )
+            {
+                if( in_fields( ) ) {
+                    ++pos_;
+                    settle( );
+                } else {
+                    ++itr_;
+                }
+                return *this;
+            }
+
+            bool operator == ( const iterator &o ) const
+            {
+                return pos_ == o.pos_ && itr_ == o.itr_;
+            }
+
+            bool operator != ( const iterator &o ) const
+            {
+                return !(*this == o);
+            }
+
+        private:
+
+            friend class hybrid_map;
+
+            using sparse_iterator = typename sparse_type::const_iterator;
+
+            iterator( const hybrid_map *map, std::size_t pos,
+                      sparse_iterator itr )
+                :map_(map)
+                ,pos_(pos)
+                ,itr_(itr)
+            {
+                settle( );
+            }
+
+            bool in_dense( ) const
+            {
+                return pos_ < map_->dense_.size( );
+            }
+
+            /// the array part or the record
+            bool in_fields( ) const
+            {
+                return pos_ < map_->dense_.size( ) + map_->fields_.size( );
+            }
+
+            void settle( )
+            {
+                while( in_dense( ) && !map_->dense_[pos_] ) {
+                    ++pos_;
+                }
+            }
+
+            const hybrid_map *map_ = nullptr;
+            std::size_t       pos_ = 0;
+            sparse_iterator   itr_;
+        };
+
+        hybrid_map( ) = default;
+
+        std::size_t size( ) const
+        {
+            return dense_size_ + fields_.size( ) + sparse_.size( );
+        }
+
+        bool empty( ) const
+        {
+            return size( ) == 0;
+        }
+
+        /// size of the array part
+        std::size_t dense_capacity( ) const
+        {
+            return dense_.size( );
+        }
+
+        iterator begin( ) const
+        {
+            return iterator( this, 0, sparse_.begin( ) );
+        }
+
+        iterator end( ) const
+        {
+            return iterator( this, dense_.size( ) + fields_.size( ),
+                             sparse_.end( ) );
+        }
+
+        /// the shape of the record; empty if the keys are not kept so
+        const shape_sptr &record_shape( ) const
+        {
+            return shape_;
+        }
+
+        /// `id` is a slot of record_shape( )
+        const ValueT &field( std::size_t id ) const
+        {
+            return fields_[id];
+        }
+
+        ValueT &field( std::size_t id )
+        {
+            return fields_[id];
+        }
+
+        /// the slot of `key` in record_shape( ) or shape_type::npos
+        std::size_t field_slot( const KeyT &key ) const
+        {
+            auto tag = KeyOps::tag( key );
+            if( !shape_ || !KeyOps::field( key, tag ) ) {
+                return shape_type::npos;
+            }
+            return shape_->find( key, tag, KeyOps::hash( key, tag ) );
+        }
+
+        const ValueT *find( const KeyT &key ) const
+        {
+            std::size_t id = 0;
+            auto tag = KeyOps::tag( key );
+            if( KeyOps::index( key, tag, id ) && id < dense_.size( ) ) {
+                return dense_[id] ? &dense_[id] : nullptr;
+            } else if( shape_ ) {
+                auto slot = shape_->find( key, tag, KeyOps::hash( key, tag ) );
+                return slot == shape_type::npos ? nullptr : &fields_[slot];
+            }
+            auto f = sparse_.find( key, tag );
+            return f == sparse_.end( ) ? nullptr : &f->second;
+        }
+
+        ValueT *find( const KeyT &key )
+        {
+            auto res = static_cast<const hybrid_map *>(this)->find( key );
+            return const_cast<ValueT *>(res);
+        }
+
+        /// the value under `itr`, an iterator of this map
+        ValueT &value( const iterator &itr )
+        {
+            return const_cast<ValueT &>(itr.value( ));
+        }
+
+        /// false if the key is here already
+        bool insert( std::pair<KeyT, ValueT> val )
+        {
+            bool added = false;
+            auto &res( emplace( std::move(val.first), added ) );
+            if( added ) {
+                res = std::move(val.second);
+            }
+            return added;
+        }
+
+        ValueT &operator [ ]( KeyT key )
+        {
+            bool added = false;
+            return emplace( std::move(key), added );
+        }
+
+        template <typename CallT>
+        void for_each( CallT call ) const
+        {
+            for( std::size_t i = 0; i < dense_.size( ); ++i ) {
+                if( dense_[i] ) {
+                    call( KeyOps::key( i ), dense_[i] );
+                }
+            }
+            for( std::size_t i = 0; i < fields_.size( ); ++i ) {
+                call( shape_->key( i ), fields_[i] );
+            }
+            for( auto &s: sparse_ ) {
+                call( s.first, s.second );
+            }
+        }
+
+    private:
+
+        ValueT &emplace( KeyT key, bool &added )
+        {
+            std::size_t id = 0;
+            auto tag     = KeyOps::tag( key );
+            bool indexed = KeyOps::index( key, tag, id );
+            bool dense   = indexed && id < dense_.size( );
+
+            /// an index that misses the array part leaves the record
+            /// only if the array part does not grow for it
+            if( !dense && (shape_ ? indexed : sparse_.full( )) ) {
+                auto f = sparse_.find( key, tag );
+                if( f != sparse_.end( ) ) {
+                    return f->second;
+                }
+                rebalance( indexed, id );
+                dense = indexed && id < dense_.size( );
+            }
+
+            if( dense ) {
+                auto &res( dense_[id] );
+                if( !res ) {
+                    added = true;
+                    ++dense_size_;
+                }
+                return res;
+            }
+
+            if( shape_ || sparse_.empty( ) ) {
+                if( KeyOps::field( key, tag ) ) {
+                    auto hash = KeyOps::hash( key, tag );
+                    auto &shp( shape_ ? shape_ : shape_type::root( ) );
+                    auto slot = shp->find( key, tag, hash );
+                    if( slot != shape_type::npos ) {
+                        return fields_[slot];
+                    } else if( shp->size( ) < max_fields ) {
+                        shape_ = shp->add( std::move(key), tag, hash );
+                        if( fields_.empty( ) ) {
+                            fields_.reserve( 4 );
+                        }
+                        fields_.emplace_back( );
+                        added = true;
+                        return fields_.back( );
+                    }
+                }
+                unshape( );
+            }
+
+            auto before = sparse_.size( );
+            auto &res( sparse_[std::move(key)] );
+            added = sparse_.size( ) != before;
+            return res;
+        }
+
+        /// bits in `id`; the keys of bin `b` are in [2^(b-1), 2^b)
+        static
+        unsigned bin( std::size_t id )
+        {
+            unsigned res = 0;
+            while( id ) {
+                id >>= 1;
+                ++res;
+            }
+            return res;
+        }
+
+        /// counts the indexed keys of the hash part and the incoming one
+        /// and moves them to a larger array part if it pays off
+        void rebalance( bool indexed, std::size_t extra )
+        {
+            std::size_t nums[max_bits + 1] = { };
+            auto count = [&nums]( std::size_t id ) {
+                auto b = bin( id );
+                if( b <= max_bits ) {
+                    ++nums[b];
+                }
+            };
+
+            for( auto &s: sparse_ ) {
+                std::size_t id = 0;
+                if( KeyOps::index( s.first, s.tag, id ) ) {
+                    count( id );
+                }
+            }
+            if( indexed ) {
+                count( extra );
+            }
+
+            /// the hash part has no indexed keys below the array part size
+            std::size_t total = dense_size_;
+            std::size_t best  = dense_.size( );
+            for( unsigned b = 0; b <= max_bits; ++b ) {
+                auto next = std::size_t(1) << b;
+                total += nums[b];
+                if( next > dense_.size( ) && total > next / 2 ) {
+                    best = next;
+                }
+            }
+            if( best == dense_.size( ) ) {
+                return;
+            }
+
+            dense_.resize( best );
+            sparse_type rest;
+            for( auto &s: sparse_ ) {
+                std::size_t id = 0;
+                if( KeyOps::index( s.first, s.tag, id ) && id < best ) {
+                    dense_[id] = std::move(s.second);
+                    ++dense_size_;
+                } else {
+                    rest.insert( std::make_pair( std::move(s.first),
+                                                 std::move(s.second) ) );
+                }
+            }
+            sparse_ = std::move(rest);
+        }
+
+        /// moves the record to the hash part
+        void unshape( )
+        {
+            if( shape_ ) {
+                for( std::size_t i = 0; i < fields_.size( ); ++i ) {
+                    sparse_.insert( std::make_pair( shape_->key( i ),
+                                                    std::move(fields_[i]) ) );
+                }
+                shape_.reset( );
+                std::vector<ValueT>( ).swap( fields_ );
+            }
+        }
+
+        std::vector<ValueT> dense_;
+        std::size_t         dense_size_ = 0;
+        shape_sptr          shape_;
+        std::vector<ValueT> fields_;
+        sparse_type         sparse_;
+    };
+
+    template <typename KeyT, typename ValueT, typename KeyOps>
+    const std::size_t hybrid_map<KeyT, ValueT, KeyOps>::max_fields;
+
+}}
+
+#endif // HYBRID_H
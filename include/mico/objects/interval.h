@@ -128,8 +128,8 @@ namespace mico { namespace objects {
             std::size_t hash( ) const override
             {
                 std::size_t seed = 0;
-                hash_combine( seed, ival_.left( ) );
-                hash_combine( seed, ival_.right( ));
+                seed = hash_combine( seed, ival_.left( ) );
+                seed = hash_combine( seed, ival_.right( ));
                 return seed;
             }
 
@@ -0,0 +1,245 @@
+#ifndef MICO_OBJECTS_MATRIX_H
+#define MICO_OBJECTS_MATRIX_H
+
+#include <new>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+#include "mico/objects/base.h"
+#include "mico/objects/numbers.h"
+#include "mico/objects/reference.h"
+#include "mico/expressions/array.h"
+
+namespace mico { namespace objects {
+
+    /// Dense matrix of floats kept row after row in one vector.
+    /// Clones share the vector until one of them is written
+    template <>
+    class impl<type::MATRIX>: public typed_base<type::MATRIX> {
+        using this_type = impl<type::MATRIX>;
+    public:
+
+        static const type type_value = type::MATRIX;
+
+        using sptr       = std::shared_ptr<this_type>;
+        using float_type = floating::value_type;
+        using value_type = std::vector<float_type>;
+        using value_sptr = std::shared_ptr<value_type>;
+
+        /// A reference to a cell of a mutable matrix; only numbers can be
+        /// assigned to it, they are written back to the matrix
+        class cell_ref: public impl<type::REFERENCE> {
+            using parent_type = impl<type::REFERENCE>;
+            using matrix_sptr = std::shared_ptr<impl<type::MATRIX> >;
+        public:
+
+            cell_ref( matrix_sptr mat, std::size_t id )
+                :parent_type(nullptr, floating::make( mat->data( )[id] ),
+                             true)
+                ,mat_(std::move(mat))
+                ,id_(id)
+            { }
+
+            bool accepts( const base *val ) const override
+            {
+                return val->get_type( ) == type::FLOAT
+                    || val->get_type( ) == type::INTEGER;
+            }
+
+            void set_value( const environment *my_env,
+                            objects::sptr val ) override
+            {
+                if( val->get_type( ) == type::FLOAT ) {
+                    mat_->mutable_data( )[id_] =
+                            static_cast<const floating *>(val.get( ))->value( );
+                } else if( val->get_type( ) == type::INTEGER ) {
+                    auto v = static_cast<const integer *>(val.get( ))->value( );
+                    mat_->mutable_data( )[id_] = static_cast<float_type>(v);
+                } else {
+                    return;
+                }
+                parent_type::set_value( my_env, val );
+            }
+
+        private:
+            matrix_sptr mat_;
+            std::size_t id_;
+        };
+
+        /// zeros
+        impl( std::size_t rows, std::size_t cols )
+            :rows_(rows)
+            ,cols_(cols)
+            ,value_(std::make_shared<value_type>( rows * cols ))
+        { }
+
+        /// `val` has rows * cols elements
+        impl( std::size_t rows, std::size_t cols, value_sptr val )
+            :rows_(rows)
+            ,cols_(cols)
+            ,value_(std::move(val))
+        { }
+
+        /// false if rows * cols elements do not fit a vector
+        static
+        bool fits( std::size_t rows, std::size_t cols )
+        {
+            return rows == 0 || cols <= value_type( ).max_size( ) / rows;
+        }
+
+        /// zeros; an empty pointer if the matrix is too big
+        static
+        sptr try_make( std::size_t rows, std::size_t cols )
+        {
+            if( fits( rows, cols ) ) {
+                try {
+                    return make( rows, cols );
+                } catch( const std::bad_alloc & ) {
+                } catch( const std::length_error & ) {
+                }
+            }
+            return nullptr;
+        }
+
+        static
+        sptr make( std::size_t rows, std::size_t cols )
+        {
+            return std::make_shared<this_type>( rows, cols );
+        }
+
+        static
+        sptr make( std::size_t rows, std::size_t cols, value_sptr val )
+        {
+            return std::make_shared<this_type>( rows, cols, std::move(val) );
+        }
+
+        std::string str( ) const override
+        {
+            std::ostringstream oss;
+            oss << "matrix[";
+            for( std::size_t r = 0; r < rows_; ++r ) {
+                oss << (r ? ", [" : "[");
+                for( std::size_t c = 0; c < cols_; ++c ) {
+                    oss << (c ? ", " : "") << at( r, c );
+                }
+                oss << "]";
+            }
+            oss << "]";
+            return oss.str( );
+        }
+
+        /// rows; `m[i]` is a row
+        std::size_t size( ) const override
+        {
+            return rows_;
+        }
+
+        std::size_t rows( ) const
+        {
+            return rows_;
+        }
+
+        std::size_t cols( ) const
+        {
+            return cols_;
+        }
+
+        const float_type *data( ) const
+        {
+            return value_->data( );
+        }
+
+        /// the elements for a write; a shared vector is copied first
+        float_type *mutable_data( )
+        {
+            if( value_.use_count( ) > 1 ) {
+                value_ = std::make_shared<value_type>( *value_ );
+            }
+            return value_->data( );
+        }
+
+        float_type at( std::size_t row, std::size_t col ) const
+        {
+            return (*value_)[row * cols_ + col];
+        }
+
+        /// an index from the end if `id` is negative; npos if it is
+        /// out of [0, count)
+        static
+        std::size_t fix_id( std::int64_t id, std::size_t count )
+        {
+            if( id < 0 ) {
+                id += static_cast<std::int64_t>(count);
+            }
+            auto res = static_cast<std::size_t>(id);
+            if( id < 0 || res >= count ) {
+                return npos;
+            }
+            return res;
+        }
+
+        /// a number or, if `mat` is mutable, a cell_ref
+        static
+        objects::sptr cell( const sptr &mat, std::size_t row, std::size_t col,
+                            bool target )
+        {
+            auto id = row * mat->cols_ + col;
+            if( target && mat->is_mutable( ) ) {
+                return pool::make_shared<cell_ref>( mat, id );
+            }
+            return floating::make( mat->data( )[id] );
+        }
+
+        hash_type hash( ) const override
+        {
+            auto seed = base::hash64( base::hash64( rows_ ) + cols_ );
+            return wyhash::get( value_->data( ),
+                                value_->size( ) * sizeof(float_type), seed );
+        }
+
+        bool equal( const base *other ) const override
+        {
+            if( other->get_type( ) == get_type( ) ) {
+                auto o = static_cast<const this_type *>(other);
+                return rows_ == o->rows_ && cols_ == o->cols_
+                    && (value_ == o->value_ || *value_ == *o->value_);
+            }
+            return false;
+        }
+
+        objects::sptr clone( ) const override
+        {
+            auto res = make( rows_, cols_, value_ );
+            res->set_mutable( is_mutable( ) );
+            return res;
+        }
+
+        /// rows as array literals
+        ast::node::uptr to_ast( tokens::position pos ) const override
+        {
+            using ast_type = ast::expressions::impl<ast::type::ARRAY>;
+            auto res = ast::node::make<ast_type>(pos);
+            for( std::size_t r = 0; r < rows_; ++r ) {
+                auto row = ast::node::make<ast_type>(pos);
+                for( std::size_t c = 0; c < cols_; ++c ) {
+                    auto next = floating::make( at( r, c ) )->to_ast( pos );
+                    row->value( ).emplace_back(
+                                        ast::expression::cast( next ) );
+                }
+                res->value( ).emplace_back( std::move(row) );
+            }
+            return ast::node::uptr( std::move( res ) );
+        }
+
+        static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    private:
+        std::size_t rows_;
+        std::size_t cols_;
+        value_sptr  value_;
+    };
+
+    using matrix = impl<type::MATRIX>;
+}}
+
+#endif // MATRIX_H
@@ -1,6 +1,9 @@
 #ifndef MICO_OBJECTS_MODULE_H
 #define MICO_OBJECTS_MODULE_H
 
+#include <vector>
+#include <algorithm>
+
 #include "mico/objects/base.h"
 #include "mico/objects/reference.h"
 #include "mico/objects/null.h"
@@ -83,7 +86,7 @@ namespace mico { namespace objects {
             return 0;
         }
 
-        objects::sptr get( const std::string &name )
+        objects::sptr get( const symbol &name )
         {
             if( auto e = env( ) ) {
                 return e->get_parents_only(name);
@@ -116,11 +119,23 @@ namespace mico { namespace objects {
             res->set_pos( pos );
 
             if( auto e = env( ) ) {
+
+                /// symbols are ordered by ids; keep the output sorted by names
+                using value_type = environment::data_map::value_type;
+                std::vector<const value_type *> values;
                 for( auto &p: e->data( ) ) {
+                    values.push_back( &p );
+                }
+                std::sort( values.begin( ), values.end( ),
+                           []( const value_type *l, const value_type *r ) {
+                               return l->first.name( ) < r->first.name( );
+                           } );
+
+                for( auto p: values ) {
 
-                    auto name = ident::uptr( new ident(p.first) );
+                    auto name = ident::uptr( new ident(p->first) );
                     auto ls = let::make( std::move(name),
-                                         p.second->to_ast(pos) );
+                                         p->second->to_ast(pos) );
 
                     body->value( ).emplace_back( std::move(ls) );
                 }
@@ -1,11 +1,24 @@
 #ifndef MICO_OBJECTS_NUMBERS_H
 #define MICO_OBJECTS_NUMBERS_H
 
+#include <vector>
 #include <sstream>
+#include <type_traits>
 #include "mico/objects/base.h"
+#include "mico/objects/pool.h"
 #include "mico/objects/boolean.h"
 #include "mico/expressions/value.h"
 
+/// integers in this range are shared objects; build with other values
+/// to change it
+#if !defined(MICO_SMALL_INT_MIN)
+#define MICO_SMALL_INT_MIN -128
+#endif
+
+#if !defined(MICO_SMALL_INT_MAX)
+#define MICO_SMALL_INT_MAX 1023
+#endif
+
 namespace mico { namespace objects {
 
     template <type TName>
@@ -59,7 +72,8 @@ namespace mico { namespace objects {
         static
         sptr make( T val )
         {
-            return std::make_shared<this_type>( static_cast<value_type>(val) );
+            using is_int = std::integral_constant<bool, TN == type::INTEGER>;
+            return make_value( static_cast<value_type>(val), is_int( ) );
         }
 
         static
@@ -69,6 +83,11 @@ namespace mico { namespace objects {
             return h(x);
         }
 
+        base::hash_type hash( ) const override
+        {
+            return hash( value_ );
+        }
+
         bool equal( const base *other ) const override
         {
             if( other->get_type( ) == this->get_type( ) ) {
@@ -91,6 +110,38 @@ namespace mico { namespace objects {
 
     private:
 
+        static
+        sptr make_value( value_type val, std::false_type )
+        {
+            return pool::make_shared<this_type>( val );
+        }
+
+        /// small integers are never changed, so every `make` of
+        /// the same value gets the same object
+        static
+        sptr make_value( value_type val, std::true_type )
+        {
+            if( (val >= MICO_SMALL_INT_MIN) && (val <= MICO_SMALL_INT_MAX) ) {
+                return small( )[static_cast<std::size_t>(val
+                                                    - MICO_SMALL_INT_MIN)];
+            }
+            return pool::make_shared<this_type>( val );
+        }
+
+        static
+        const std::vector<sptr> &small( )
+        {
+            static const std::vector<sptr> values = []( ) {
+                std::vector<sptr> res;
+                for( value_type v = MICO_SMALL_INT_MIN;
+                     v <= MICO_SMALL_INT_MAX; ++v ) {
+                    res.emplace_back( std::make_shared<this_type>( v ) );
+                }
+                return res;
+            }( );
+            return values;
+        }
+
         value_type value_;
     };
 
@@ -0,0 +1,223 @@
+#ifndef MICO_OBJECTS_PACKED_H
+#define MICO_OBJECTS_PACKED_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "mico/objects/base.h"
+#include "mico/objects/numbers.h"
+#include "mico/objects/boolean.h"
+#include "mico/objects/character.h"
+
+namespace mico { namespace objects {
+
+    /// Elements of an array that are all integers, floats, booleans or
+    /// characters, kept as plain values one after another. Only the
+    /// vector of `kind( )` is used. An element object is made on every
+    /// `get`; `set` and `push` take only objects of `kind( )`
+    class packed {
+    public:
+
+        using int_type   = integer::value_type;
+        using float_type = floating::value_type;
+        using bool_type  = std::uint8_t;
+        using char_type  = character::value_type;
+
+        explicit
+        packed( type kind )
+            :kind_(kind)
+        { }
+
+        static
+        bool packable( type kind )
+        {
+            return kind == type::INTEGER
+                || kind == type::FLOAT
+                || kind == type::BOOLEAN
+                || kind == type::CHARACTER
+                 ;
+        }
+
+        type kind( ) const
+        {
+            return kind_;
+        }
+
+        std::size_t size( ) const
+        {
+            switch( kind_ ) {
+            case type::INTEGER:
+                return ints_.size( );
+            case type::FLOAT:
+                return floats_.size( );
+            case type::BOOLEAN:
+                return bools_.size( );
+            default:
+                return chars_.size( );
+            }
+        }
+
+        void reserve( std::size_t count )
+        {
+            switch( kind_ ) {
+            case type::INTEGER:
+                ints_.reserve( count );
+                break;
+            case type::FLOAT:
+                floats_.reserve( count );
+                break;
+            case type::BOOLEAN:
+                bools_.reserve( count );
+                break;
+            default:
+                chars_.reserve( count );
+                break;
+            }
+        }
+
+        objects::sptr get( std::size_t id ) const
+        {
+            switch( kind_ ) {
+            case type::INTEGER:
+                return integer::make( ints_[id] );
+            case type::FLOAT:
+                return floating::make( floats_[id] );
+            case type::BOOLEAN:
+                return boolean::make( bools_[id] != 0 );
+            default:
+                return character::make( chars_[id] );
+            }
+        }
+
+        /// false if `val` is not of kind( )
+        bool set( std::size_t id, const objects::sptr &val )
+        {
+            if( val->get_type( ) != kind_ ) {
+                return false;
+            }
+            switch( kind_ ) {
+            case type::INTEGER:
+                ints_[id] = static_cast<const integer *>(val.get( ))->value( );
+                break;
+            case type::FLOAT:
+                floats_[id] =
+                        static_cast<const floating *>(val.get( ))->value( );
+                break;
+            case type::BOOLEAN:
+                bools_[id] = static_cast<const boolean *>(val.get( ))->value( );
+                break;
+            default:
+                chars_[id] =
+                        static_cast<const character *>(val.get( ))->value( );
+                break;
+            }
+            return true;
+        }
+
+        /// false if `val` is not of kind( )
+        bool push( const objects::sptr &val )
+        {
+            if( val->get_type( ) != kind_ ) {
+                return false;
+            }
+            switch( kind_ ) {
+            case type::INTEGER:
+                ints_.push_back(
+                        static_cast<const integer *>(val.get( ))->value( ) );
+                break;
+            case type::FLOAT:
+                floats_.push_back(
+                        static_cast<const floating *>(val.get( ))->value( ) );
+                break;
+            case type::BOOLEAN:
+                bools_.push_back(
+                        static_cast<const boolean *>(val.get( ))->value( ) );
+                break;
+            default:
+                chars_.push_back(
+                        static_cast<const character *>(val.get( ))->value( ) );
+                break;
+            }
+            return true;
+        }
+
+        /// `other` must be of kind( )
+        void append( const packed &other )
+        {
+            append( ints_, other.ints_ );
+            append( floats_, other.floats_ );
+            append( bools_, other.bools_ );
+            append( chars_, other.chars_ );
+        }
+
+        /// the same elements in the same order; elements of different
+        /// kinds are never equal
+        bool equal( const packed &other ) const
+        {
+            return kind_   == other.kind_
+                && ints_   == other.ints_
+                && floats_ == other.floats_
+                && bools_  == other.bools_
+                && chars_  == other.chars_
+                 ;
+        }
+
+        std::vector<int_type> &ints( )
+        {
+            return ints_;
+        }
+
+        const std::vector<int_type> &ints( ) const
+        {
+            return ints_;
+        }
+
+        std::vector<float_type> &floats( )
+        {
+            return floats_;
+        }
+
+        const std::vector<float_type> &floats( ) const
+        {
+            return floats_;
+        }
+
+        std::vector<bool_type> &bools( )
+        {
+            return bools_;
+        }
+
+        const std::vector<bool_type> &bools( ) const
+        {
+            return bools_;
+        }
+
+        std::vector<char_type> &chars( )
+        {
+            return chars_;
+        }
+
+        const std::vector<char_type> &chars( ) const
+        {
+            return chars_;
+        }
+
+    private:
+
+        template <typename T>
+        static
+        void append( std::vector<T> &to, const std::vector<T> &from )
+        {
+            to.insert( to.end( ), from.begin( ), from.end( ) );
+        }
+
+        type                    kind_;
+        std::vector<int_type>   ints_;
+        std::vector<float_type> floats_;
+        std::vector<bool_type>  bools_;
+        std::vector<char_type>  chars_;
+    };
+
+}}
+
+#endif // PACKED_H
@@ -0,0 +1,266 @@
+#ifndef MICO_OBJECTS_POOL_H
+#define MICO_OBJECTS_POOL_H
+
+#include <new>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <iomanip>
+#include <utility>
+
+namespace mico { namespace objects {
+
+    /// Free lists for small short living objects (numbers, references,
+    /// return values, generators). Blocks are grouped in size classes of
+    /// `granularity` bytes and are cut from chunks that are never given
+    /// back to the system: a block freed goes to the list of its class
+    /// and is the first one to be reused.
+    /// Every thread has its own pool, so there is no locking.
+    /// When a thread ends its pool is put aside and the next new thread
+    /// takes it, so the chunks are reused rather than lost
+    struct pool {
+
+        static const std::size_t granularity = 16;
+        static const std::size_t classes     = 16;
+        static const std::size_t max_size    = granularity * classes;
+        static const std::size_t chunk_size  = 16 * 1024;
+
+        struct stats {
+            std::uint64_t hits    = 0; /// reused a freed block
+            std::uint64_t misses  = 0; /// cut a new block from a chunk
+            std::uint64_t frees   = 0;
+            std::uint64_t chunks  = 0;
+            std::uint64_t bypass  = 0; /// too big for the pool
+
+            stats &operator += ( const stats &o )
+            {
+                hits   += o.hits;
+                misses += o.misses;
+                frees  += o.frees;
+                chunks += o.chunks;
+                bypass += o.bypass;
+                return *this;
+            }
+        };
+
+        /// The pool of the current thread. Pools are never destroyed:
+        /// objects cut from them may live in statics or in other threads
+        /// after the thread is gone
+        static
+        pool &local( )
+        {
+            thread_local static pool *inst = nullptr;
+            if( !inst ) {
+                inst = shelf::get( ).take( );
+                thread_local static owner keep( &inst );
+            }
+            return *inst;
+        }
+
+        static
+        std::size_t class_of( std::size_t size )
+        {
+            return (size + granularity - 1) / granularity - 1;
+        }
+
+        void *get( std::size_t size )
+        {
+            if( size > max_size || size == 0 ) {
+                ++bypass_;
+                return ::operator new( size );
+            }
+            auto &cls( classes_[class_of( size )] );
+            if( cls.head ) {
+                auto res = cls.head;
+                cls.head = res->next;
+                ++cls.st.hits;
+                return res;
+            }
+            ++cls.st.misses;
+            return cut( cls, (class_of( size ) + 1) * granularity );
+        }
+
+        void put( void *ptr, std::size_t size )
+        {
+            if( size > max_size || size == 0 ) {
+                ::operator delete( ptr );
+                return;
+            }
+            auto &cls( classes_[class_of( size )] );
+            auto blk = static_cast<block *>(ptr);
+            blk->next = cls.head;
+            cls.head  = blk;
+            ++cls.st.frees;
+        }
+
+        stats statistics( ) const
+        {
+            stats res;
+            for( auto &c: classes_ ) {
+                res += c.st;
+            }
+            res.bypass = bypass_;
+            return res;
+        }
+
+        static
+        std::ostream &print( std::ostream &o, const stats &s )
+        {
+            o << std::left << std::setw( 16 ) << "pool_hits"
+              << s.hits << "\n"
+              << std::left << std::setw( 16 ) << "pool_misses"
+              << s.misses << "\n"
+              << std::left << std::setw( 16 ) << "pool_frees"
+              << s.frees << "\n"
+              << std::left << std::setw( 16 ) << "pool_chunks"
+              << s.chunks << "\n"
+              << std::left << std::setw( 16 ) << "pool_bypass"
+              << s.bypass << "\n";
+            return o;
+        }
+
+        /// std::make_shared with the object and its counters in the pool
+        template <typename T, typename ...Args>
+        static
+        std::shared_ptr<T> make_shared( Args && ...args )
+        {
+#if defined(DISABLE_OBJECT_POOL) && DISABLE_OBJECT_POOL
+            return std::make_shared<T>( std::forward<Args>(args)... );
+#else
+            return std::allocate_shared<T>( allocator<T>( ),
+                                            std::forward<Args>(args)... );
+#endif
+        }
+
+        template <typename T>
+        struct allocator {
+
+            using value_type = T;
+
+            template <typename U>
+            struct rebind {
+                using other = allocator<U>;
+            };
+
+            allocator( ) = default;
+
+            template <typename U>
+            allocator( const allocator<U> & )
+            { }
+
+            T *allocate( std::size_t n )
+            {
+                return static_cast<T *>(local( ).get( n * sizeof(T) ));
+            }
+
+            void deallocate( T *ptr, std::size_t n )
+            {
+                local( ).put( ptr, n * sizeof(T) );
+            }
+
+            template <typename U>
+            bool operator == ( const allocator<U> & ) const
+            {
+                return true;
+            }
+
+            template <typename U>
+            bool operator != ( const allocator<U> & ) const
+            {
+                return false;
+            }
+        };
+
+    private:
+
+        /// pools of the threads that have ended
+        struct shelf {
+
+            static
+            shelf &get( )
+            {
+                /// threads may end after the statics are destroyed
+                static shelf *inst = new shelf;
+                return *inst;
+            }
+
+            pool *take( )
+            {
+                std::lock_guard<std::mutex> lck(lock_);
+                if( pools_.empty( ) ) {
+                    return new pool;
+                }
+                auto res = pools_.back( );
+                pools_.pop_back( );
+                return res;
+            }
+
+            void give( pool *val )
+            {
+                std::lock_guard<std::mutex> lck(lock_);
+                pools_.push_back( val );
+            }
+
+        private:
+            std::mutex          lock_;
+            std::vector<pool *> pools_;
+        };
+
+        /// gives the pool of the thread back to the shelf when it ends.
+        /// Objects freed later by the same thread take a pool again;
+        /// that one stays with the thread
+        struct owner {
+
+            explicit
+            owner( pool **inst )
+                :inst_(inst)
+            { }
+
+            ~owner( )
+            {
+                if( *inst_ ) {
+                    shelf::get( ).give( *inst_ );
+                    *inst_ = nullptr;
+                }
+            }
+
+            owner( const owner & ) = delete;
+            owner &operator = ( const owner & ) = delete;
+
+        private:
+            pool **inst_;
+        };
+
+        struct block {
+            block *next;
+        };
+
+        struct size_class {
+            block       *head  = nullptr;
+            char        *begin = nullptr;
+            char        *end   = nullptr;
+            stats        st;
+        };
+
+        void *cut( size_class &cls, std::size_t size )
+        {
+            if( static_cast<std::size_t>(cls.end - cls.begin) < size ) {
+                cls.begin = static_cast<char *>(::operator new( chunk_size ));
+                cls.end   = cls.begin + chunk_size;
+                ++cls.st.chunks;
+            }
+            auto res = cls.begin;
+            cls.begin += size;
+            return res;
+        }
+
+        size_class    classes_[classes];
+        std::uint64_t bypass_ = 0;
+    };
+
+}}
+
+#endif // POOL_H
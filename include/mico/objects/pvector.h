@@ -0,0 +1,257 @@
+#ifndef MICO_OBJECTS_PVECTOR_H
+#define MICO_OBJECTS_PVECTOR_H
+
+#include <memory>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include "mico/objects/pool.h"
+
+namespace mico { namespace objects {
+
+    /// Persistent sequence: a height balanced tree with chunks of up to
+    /// `chunk_size` elements in the leaves. A node is never changed after
+    /// it is built, so a new version shares every node it did not touch
+    /// with the old one.
+    /// push_back and concat are O(log n); at is O(log n) too
+    template <typename T>
+    class pvector {
+
+        struct node;
+        using node_sptr = std::shared_ptr<const node>;
+        using items     = std::vector<T>;
+
+        struct node {
+
+            node( items val )
+                :size(val.size( ))
+                ,items_(std::move(val))
+            { }
+
+            node( node_sptr l, node_sptr r )
+                :size(l->size + r->size)
+                ,height(1 + std::max( l->height, r->height ))
+                ,left(std::move(l))
+                ,right(std::move(r))
+            { }
+
+            bool is_leaf( ) const
+            {
+                return height == 0;
+            }
+
+            std::size_t size   = 0;
+            int         height = 0;
+            node_sptr   left;
+            node_sptr   right;
+            items       items_;
+        };
+
+    public:
+
+        static const std::size_t chunk_size = 32;
+
+        pvector( ) = default;
+
+        template <typename ItrT>
+        pvector( ItrT begin, ItrT end )
+        {
+            std::vector<node_sptr> leaves;
+            while( begin != end ) {
+                items next;
+                next.reserve( chunk_size );
+                while( begin != end && next.size( ) < chunk_size ) {
+                    next.emplace_back( *begin++ );
+                }
+                leaves.emplace_back( make_leaf( std::move(next) ) );
+            }
+            root_ = build( leaves, 0, leaves.size( ) );
+        }
+
+        std::size_t size( ) const
+        {
+            return root_ ? root_->size : 0;
+        }
+
+        bool empty( ) const
+        {
+            return size( ) == 0;
+        }
+
+        /// `id` must be less than size( )
+        const T &at( std::size_t id ) const
+        {
+            const node *cur = root_.get( );
+            while( !cur->is_leaf( ) ) {
+                if( id < cur->left->size ) {
+                    cur = cur->left.get( );
+                } else {
+                    id -= cur->left->size;
+                    cur = cur->right.get( );
+                }
+            }
+            return cur->items_[id];
+        }
+
+        pvector push_back( T val ) const
+        {
+            return pvector( push_back( root_, std::move(val) ) );
+        }
+
+        pvector concat( const pvector &other ) const
+        {
+            return pvector( join( root_, other.root_ ) );
+        }
+
+        template <typename CallT>
+        void for_each( CallT call ) const
+        {
+            for_each( root_.get( ), call );
+        }
+
+    private:
+
+        explicit
+        pvector( node_sptr root )
+            :root_(std::move(root))
+        { }
+
+        static
+        node_sptr make_leaf( items val )
+        {
+            return pool::make_shared<node>( std::move(val) );
+        }
+
+        static
+        node_sptr make_node( node_sptr l, node_sptr r )
+        {
+            return pool::make_shared<node>( std::move(l), std::move(r) );
+        }
+
+        static
+        int height( const node_sptr &n )
+        {
+            return n ? n->height : -1;
+        }
+
+        static
+        node_sptr build( const std::vector<node_sptr> &leaves,
+                         std::size_t begin, std::size_t end )
+        {
+            if( begin == end ) {
+                return nullptr;
+            } else if( end - begin == 1 ) {
+                return leaves[begin];
+            }
+            auto mid = begin + (end - begin) / 2;
+            return make_node( build( leaves, begin, mid ),
+                              build( leaves, mid, end ) );
+        }
+
+        /// the heights of `l` and `r` differ by 2 at most
+        static
+        node_sptr balance( node_sptr l, node_sptr r )
+        {
+            auto hl = height( l );
+            auto hr = height( r );
+            if( hl > hr + 1 ) {
+                if( height( l->left ) >= height( l->right ) ) {
+                    return make_node( l->left, make_node( l->right, r ) );
+                }
+                auto &lr( l->right );
+                return make_node( make_node( l->left, lr->left ),
+                                  make_node( lr->right, r ) );
+            } else if( hr > hl + 1 ) {
+                if( height( r->right ) >= height( r->left ) ) {
+                    return make_node( make_node( l, r->left ), r->right );
+                }
+                auto &rl( r->left );
+                return make_node( make_node( l, rl->left ),
+                                  make_node( rl->right, r->right ) );
+            }
+            return make_node( l, r );
+        }
+
+        static
+        node_sptr join( const node_sptr &l, const node_sptr &r )
+        {
+            if( !l || !l->size ) {
+                return r;
+            } else if( !r || !r->size ) {
+                return l;
+            }
+
+            if( r->is_leaf( ) ) {
+                return append( l, r );
+            }
+
+            auto hl = height( l );
+            auto hr = height( r );
+            if( hl > hr + 1 ) {
+                return balance( l->left, join( l->right, r ) );
+            } else if( hr > hl + 1 ) {
+                return balance( join( l, r->left ), r->right );
+            }
+            return make_node( l, r );
+        }
+
+        /// `r` is a leaf; its items go to the rightmost leaf of `n`
+        /// if there is room for them, as push_back does
+        static
+        node_sptr append( const node_sptr &n, const node_sptr &r )
+        {
+            if( n->is_leaf( ) ) {
+                if( n->size + r->size <= chunk_size ) {
+                    items res;
+                    res.reserve( n->size + r->size );
+                    res.assign( n->items_.begin( ), n->items_.end( ) );
+                    res.insert( res.end( ), r->items_.begin( ),
+                                r->items_.end( ) );
+                    return make_leaf( std::move(res) );
+                }
+                return make_node( n, r );
+            }
+            return balance( n->left, append( n->right, r ) );
+        }
+
+        static
+        node_sptr push_back( const node_sptr &n, T val )
+        {
+            if( !n ) {
+                return make_leaf( items { std::move(val) } );
+            } else if( n->is_leaf( ) ) {
+                if( n->size < chunk_size ) {
+                    items res;
+                    res.reserve( n->size + 1 );
+                    res.assign( n->items_.begin( ), n->items_.end( ) );
+                    res.emplace_back( std::move(val) );
+                    return make_leaf( std::move(res) );
+                }
+                return make_node( n, make_leaf( items { std::move(val) } ) );
+            }
+            return balance( n->left, push_back( n->right, std::move(val) ) );
+        }
+
+        template <typename CallT>
+        static
+        void for_each( const node *n, CallT &call )
+        {
+            if( !n ) {
+                return;
+            } else if( n->is_leaf( ) ) {
+                for( auto &v: n->items_ ) {
+                    call( v );
+                }
+            } else {
+                for_each( n->left.get( ), call );
+                for_each( n->right.get( ), call );
+            }
+        }
+
+        node_sptr root_;
+    };
+
+}}
+
+#endif // PVECTOR_H
@@ -47,6 +47,13 @@ namespace mico { namespace objects {
             return value_;
         }
 
+        /// quotes are equal if their trees print the same
+        hash_type hash( ) const override
+        {
+            std::hash<std::string> h;
+            return h( value_->str( ) );
+        }
+
         static
         sptr make( ast::node::uptr val )
         {
@@ -2,6 +2,7 @@
 #define MICO_OBJECT_REFERENCE_H
 
 #include "mico/objects/base.h"
+#include "mico/objects/pool.h"
 #include "mico/environment.h"
 #include "mico/statements.h"
 #include "mico/expressions.h"
@@ -66,6 +67,21 @@ namespace mico { namespace objects {
             return !is_mutable( );
         }
 
+        /// false if `val` cannot be assigned to the reference
+        virtual
+        bool accepts( const base * /*val*/ ) const
+        {
+            return true;
+        }
+
+        /// true if the reference has nothing to write to anymore
+        virtual
+        bool stale( ) const
+        {
+            return false;
+        }
+
+        virtual
         void set_value( const environment * /*my_env*/, value_type val )
         {
             if( value_ != val ) {
@@ -83,13 +99,45 @@ namespace mico { namespace objects {
         static
         sptr make_var( const environment *my_env, value_type val )
         {
-            return std::make_shared<this_type>(my_env, val, true);
+            return pool::make_shared<this_type>(my_env, val, true);
         }
 
         static
         sptr make_const( const environment *my_env, value_type val )
         {
-            return std::make_shared<this_type>(my_env, val, false);
+            return pool::make_shared<this_type>(my_env, val, false);
+        }
+
+        /// A slot of an array or a table keeps its value as it is.
+        /// Only a value that holds an environment is wrapped, so the
+        /// environment stays marked while the container has it
+        static
+        objects::sptr make_slot( const environment *my_env, value_type val )
+        {
+            if( my_env && val->hold( ) ) {
+                return make_var( my_env, std::move(val) );
+            }
+            return val;
+        }
+
+        static
+        const objects::sptr &slot_value( const objects::sptr &slot )
+        {
+            return slot->get_type( ) == type::REFERENCE
+                 ? static_cast<const this_type *>(slot.get( ))->value( )
+                 : slot;
+        }
+
+        /// the reference an assignment or a loop writes the slot through;
+        /// it is made on the first call and stays in the slot
+        static
+        objects::sptr slot_ref( const environment *my_env,
+                                objects::sptr &slot )
+        {
+            if( slot->get_type( ) != type::REFERENCE ) {
+                slot = make_var( my_env, slot );
+            }
+            return slot;
         }
 
         const environment *env( ) const
@@ -119,7 +167,7 @@ namespace mico { namespace objects {
 
         objects::sptr clone( ) const override
         {
-            auto res = std::make_shared<this_type>( my_env_,
+            auto res = pool::make_shared<this_type>( my_env_,
                                                     value_->clone( ),
                                                     is_mutable( ) );
             return res;
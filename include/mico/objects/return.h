@@ -3,6 +3,7 @@
 
 #include <sstream>
 #include "mico/objects/base.h"
+#include "mico/objects/pool.h"
 #include "mico/statements.h"
 
 namespace mico { namespace objects {
@@ -38,15 +39,29 @@ namespace mico { namespace objects {
             return value_;
         }
 
+        hash_type hash( ) const override
+        {
+            return base::hash64( value_->hash( ) + 1 );
+        }
+
+        bool equal( const base *other ) const override
+        {
+            if( other->get_type( ) == get_type( ) ) {
+                auto o = static_cast<const this_type *>(other);
+                return value_->equal( o->value( ).get( ) );
+            }
+            return false;
+        }
+
         static
         sptr make( objects::sptr res )
         {
-            return std::make_shared<this_type>( res );
+            return pool::make_shared<this_type>( res );
         }
 
         objects::sptr clone( ) const override
         {
-            return std::make_shared<this_type>( value_ );
+            return pool::make_shared<this_type>( value_ );
         }
 
         ast::node::uptr to_ast( tokens::position pos ) const override
@@ -37,23 +37,39 @@ namespace mico { namespace objects {
             return oss.str( );
         }
 
+        using value_sptr  = std::shared_ptr<value_type>;
+
         impl( value_type val )
+            :value_(std::make_shared<value_type>( std::move(val) ))
+        { }
+
+        impl( value_sptr val )
             :value_(std::move(val))
         { }
 
         const value_type &value( ) const
         {
-            return value_;
+            return *value_;
         }
-        value_type &value( )
+
+        /// clones share the bytes; see array::mutable_value
+        value_type &mutable_value( )
         {
-            return value_;
+            if( value_.use_count( ) > 1 ) {
+                value_ = std::make_shared<value_type>( *value_ );
+            }
+            hash_ = 0;
+            return *value_;
         }
 
+        /// see string::hash
         hash_type hash( ) const override
         {
-            std::hash<std::string> h;
-            return h(value_);
+            if( !hash_ ) {
+                auto seed = static_cast<std::uint64_t>(get_type( ));
+                hash_ = wyhash::get( value_->data( ), value_->size( ), seed );
+            }
+            return hash_;
         }
 
         std::size_t fix_id( std::int64_t id ) const
@@ -67,19 +83,19 @@ namespace mico { namespace objects {
 
         bool valid_id( std::int64_t id ) const
         {
-            return fix_id(id) < value_.size( );
+            return fix_id(id) < value_->size( );
         }
 
         std::size_t size( ) const override
         {
-            return value_.size( );
+            return value_->size( );
         }
 
         symbol_type at( std::int64_t id )
         {
             auto siz = fix_id( id );
-            if( siz < value_.size( ) ) {
-                return static_cast<std::uint8_t>(value_[siz]);
+            if( siz < value_->size( ) ) {
+                return static_cast<std::uint8_t>((*value_)[siz]);
             } else {
                 return 0;
             }
@@ -90,9 +106,15 @@ namespace mico { namespace objects {
             return objects::integer::make( at(id) );
         }
 
+        /// all empty strings are one object
         static
         sptr make( value_type val )
         {
+            if( val.empty( ) ) {
+                static const sptr empty =
+                        std::make_shared<this_type>( value_type( ) );
+                return empty;
+            }
             return std::make_shared<this_type>( std::move(val) );
         }
 
@@ -100,6 +122,11 @@ namespace mico { namespace objects {
         {
             if( other->get_type( ) == get_type( ) ) {
                 auto o = static_cast<const this_type *>( other );
+                if( o->value_ == value_ ) {
+                    return true;
+                } else if( hash_ && o->hash_ && hash_ != o->hash_ ) {
+                    return false;
+                }
                 return o->value( ) == value( );
             }
             return false;
@@ -107,18 +134,24 @@ namespace mico { namespace objects {
 
         objects::sptr clone( ) const override
         {
-            return std::make_shared<this_type>( value_ );
+            if( value_->empty( ) ) {
+                return make( value_type( ) );
+            }
+            auto res = std::make_shared<this_type>( value_ );
+            res->hash_ = hash_;
+            return res;
         }
 
         ast::node::uptr to_ast( tokens::position pos ) const override
         {
             using ast_type = ast::expressions::impl<ast::type::STRING>;
-            return ast::node::make<ast_type>( pos, value_, true );
+            return ast::node::make<ast_type>( pos, value( ), true );
         }
 
     private:
 
-        value_type value_;
+        value_sptr value_;
+        mutable hash_type hash_ = 0;
 
     };
 
@@ -0,0 +1,125 @@
+#ifndef MICO_OBJECTS_SHAPE_H
+#define MICO_OBJECTS_SHAPE_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+namespace mico { namespace objects {
+
+    /// Hidden class of a record: the keys in the order they were added,
+    /// a key is the index of its value in the slots of the record.
+    /// A shape never changes; adding a key moves the record to the next
+    /// shape, and records that got the same keys in the same order share
+    /// it. The next shapes are kept as weak links, so a shape lives while
+    /// some record or cache holds it.
+    /// Lookups are linear and meant for a few keys.
+    ///
+    /// KeyOps: see swiss_map
+    template <typename KeyT, typename KeyOps>
+    class shape {
+
+        struct field {
+            KeyT          key;
+            std::uint64_t hash;
+            std::uint8_t  tag;
+        };
+
+        struct link {
+            field                       key;
+            std::weak_ptr<const shape>  next;
+        };
+
+    public:
+
+        using sptr = std::shared_ptr<const shape>;
+
+        static const std::size_t npos = static_cast<std::size_t>(-1);
+
+        /// the shape without keys of the current thread; it is never
+        /// destroyed, see pool::local
+        static
+        const sptr &root( )
+        {
+            thread_local static sptr *inst =
+                                    new sptr( std::make_shared<shape>( ) );
+            return *inst;
+        }
+
+        shape( ) = default;
+
+        std::size_t size( ) const
+        {
+            return fields_.size( );
+        }
+
+        const KeyT &key( std::size_t id ) const
+        {
+            return fields_[id].key;
+        }
+
+        /// the slot of `key` or npos
+        std::size_t find( const KeyT &key, std::uint8_t tag,
+                          std::uint64_t hash ) const
+        {
+            for( std::size_t i = 0; i < fields_.size( ); ++i ) {
+                auto &f( fields_[i] );
+                if( f.hash == hash &&
+                    KeyOps::equal( f.key, f.tag, key, tag ) )
+                {
+                    return i;
+                }
+            }
+            return npos;
+        }
+
+        /// the shape with `key` in the next slot; `key` must not be here
+        sptr add( KeyT key, std::uint8_t tag, std::uint64_t hash ) const
+        {
+            for( auto &l: links_ ) {
+                if( l.key.hash == hash &&
+                    KeyOps::equal( l.key.key, l.key.tag, key, tag ) )
+                {
+                    if( auto res = l.next.lock( ) ) {
+                        return res;
+                    }
+                    auto res = make_next( l.key );
+                    l.next = res;
+                    return res;
+                }
+            }
+
+            links_.erase( std::remove_if( links_.begin( ), links_.end( ),
+                                [ ]( const link &l ) {
+                                    return l.next.expired( );
+                                } ), links_.end( ) );
+
+            field next { std::move(key), hash, tag };
+            auto res = make_next( next );
+            links_.push_back( link { std::move(next), res } );
+            return res;
+        }
+
+    private:
+
+        sptr make_next( const field &key ) const
+        {
+            auto res = std::make_shared<shape>( );
+            res->fields_ = fields_;
+            res->fields_.push_back( key );
+            return res;
+        }
+
+        std::vector<field>          fields_;
+        mutable std::vector<link>   links_;
+    };
+
+    template <typename KeyT, typename KeyOps>
+    const std::size_t shape<KeyT, KeyOps>::npos;
+
+}}
+
+#endif // SHAPE_H
@@ -41,9 +41,11 @@ namespace mico { namespace objects {
             return oss.str( );
         }
 
+        /// all slices of one type are equal
         base::hash_type hash( ) const override
         {
-            return 0;
+            auto tid = static_cast<std::uint64_t>(this->get_type( ));
+            return base::hash64( tid );
         }
 
         std::size_t size( ) const override
@@ -87,6 +89,13 @@ namespace mico { namespace objects {
         virtual
         objects::sptr at( std::int64_t id ) const = 0;
 
+        /// `at` for an element that is going to be written
+        virtual
+        objects::sptr ref_at( std::int64_t id ) const
+        {
+            return at( id );
+        }
+
         bool equal( const base *o ) const override
         {
             return (o->get_type( ) == this->get_type( ));
@@ -120,6 +129,12 @@ namespace mico { namespace objects {
             return stop_;
         }
 
+        /// the elements go from end( ) - 1 down to begin( )
+        bool reversed( ) const
+        {
+            return negative_;
+        }
+
     private:
         value_type  obj_;
         std::size_t start_;
@@ -197,9 +212,14 @@ namespace mico { namespace objects {
         objects::sptr at( std::int64_t id ) const override
         {
             auto fixed = fix_id( id );
-            return is_mutable( )
-                 ? value( )->value( )[fixed]
-                 : value( )->value( )[fixed]->value( );
+            return value( )->at( static_cast<std::int64_t>(fixed) );
+        }
+
+        objects::sptr ref_at( std::int64_t id ) const override
+        {
+            auto fixed = fix_id( id );
+            return objects::array::ref_at( value( ),
+                                        static_cast<std::int64_t>(fixed) );
         }
 
         static
@@ -37,26 +37,39 @@ namespace mico { namespace objects {
             return oss.str( );
         }
 
+        using value_sptr  = std::shared_ptr<value_type>;
+
         impl( value_type val )
+            :value_(std::make_shared<value_type>( std::move(val) ))
+        { }
+
+        impl( value_sptr val )
             :value_(std::move(val))
         { }
 
         const value_type &value( ) const
         {
-            return value_;
+            return *value_;
         }
-        value_type &value( )
+
+        /// clones share the characters; see array::mutable_value
+        value_type &mutable_value( )
         {
-            return value_;
+            if( value_.use_count( ) > 1 ) {
+                value_ = std::make_shared<value_type>( *value_ );
+            }
+            hash_ = 0;
+            return *value_;
         }
 
+        /// computed once; only a write through mutable_value drops it
         hash_type hash( ) const override
         {
-            auto seed = static_cast<std::size_t>(get_type( ));
-            for( auto &a: value_ ) {
-                seed = hash_combine( seed, a );
+            if( !hash_ ) {
+                auto seed = static_cast<std::size_t>(get_type( ));
+                hash_ = hash_combine( seed, value( ) );
             }
-            return seed;
+            return hash_;
         }
 
         std::size_t fix_id( std::int64_t id ) const
@@ -70,19 +83,19 @@ namespace mico { namespace objects {
 
         bool valid_id( std::int64_t id ) const
         {
-            return fix_id(id) < value_.size( );
+            return fix_id(id) < value_->size( );
         }
 
         std::size_t size( ) const override
         {
-            return value_.size( );
+            return value_->size( );
         }
 
         symbol_type at( std::int64_t id )
         {
             auto siz = fix_id( id );
-            if( siz < value_.size( ) ) {
-                return value_[siz];
+            if( siz < value_->size( ) ) {
+                return (*value_)[siz];
             } else {
                 return 0;
             }
@@ -93,23 +106,33 @@ namespace mico { namespace objects {
             return objects::character::make( at(id) );
         }
 
+        /// all empty strings are one object
         static
         sptr make( value_type val )
         {
+            if( val.empty( ) ) {
+                static const sptr empty =
+                        std::make_shared<this_type>( value_type( ) );
+                return empty;
+            }
             return std::make_shared<this_type>( std::move(val) );
         }
 
         static
         sptr make( system_type val )
         {
-            auto internal = charset::encoding::from_file( val );
-            return std::make_shared<this_type>( std::move(internal) );
+            return make( charset::encoding::from_file( val ) );
         }
 
         bool equal( const base *other ) const override
         {
             if( other->get_type( ) == get_type( ) ) {
                 auto o = static_cast<const this_type *>( other );
+                if( o->value_ == value_ ) {
+                    return true;
+                } else if( hash_ && o->hash_ && hash_ != o->hash_ ) {
+                    return false;
+                }
                 return o->value( ) == value( );
             }
             return false;
@@ -117,7 +140,12 @@ namespace mico { namespace objects {
 
         objects::sptr clone( ) const override
         {
-            return std::make_shared<this_type>( value_ );
+            if( value_->empty( ) ) {
+                return make( value_type( ) );
+            }
+            auto res = std::make_shared<this_type>( value_ );
+            res->hash_ = hash_;
+            return res;
         }
 
         ast::node::uptr to_ast( tokens::position pos ) const override
@@ -128,7 +156,8 @@ namespace mico { namespace objects {
         }
 
     private:
-        value_type value_;
+        value_sptr value_;
+        mutable hash_type hash_ = 0;
 
     };
 
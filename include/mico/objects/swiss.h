@@ -0,0 +1,380 @@
+#ifndef MICO_OBJECTS_SWISS_H
+#define MICO_OBJECTS_SWISS_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+
+#if (!defined(DISABLE_SIMD) || !DISABLE_SIMD) && defined(__GNUC__) \
+    && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#include <emmintrin.h>
+#define MICO_SWISS_SSE2 1
+#else
+#define MICO_SWISS_SSE2 0
+#endif
+
+namespace mico { namespace objects {
+
+    /// Open addressing hash map in the style of the Swiss tables.
+    /// Slots are grouped by 16; every slot has a control byte with 7 bits
+    /// of the hash (or `free_ctrl`), so one SSE2 compare finds the
+    /// candidates of a whole group. A slot keeps the full hash and a tag
+    /// of the key next to the key; `KeyOps` gets the tag to compare keys
+    /// without going through virtual calls where it can.
+    /// Keys are never removed. Iterators are positions: a growth moves
+    /// the entries but never leaves an iterator pointing to freed memory.
+    ///
+    /// KeyOps:
+    ///     static std::uint8_t  tag( const KeyT & );
+    ///     static std::uint64_t hash( const KeyT &, std::uint8_t tag );
+    ///     static bool equal( const KeyT &, std::uint8_t,
+    ///                        const KeyT &, std::uint8_t );
+    template <typename KeyT, typename ValueT, typename KeyOps>
+    class swiss_map {
+
+        static const std::size_t  group_size = 16;
+        static const std::uint8_t free_ctrl  = 0x80;
+
+    public:
+
+        struct slot {
+            KeyT          first;
+            ValueT        second;
+            std::uint64_t hash = 0;
+            std::uint8_t  tag  = 0;
+        };
+
+        template <typename MapT, typename SlotT>
+        class basic_iterator {
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = SlotT;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = SlotT *;
+            using reference         = SlotT &;
+
+            basic_iterator( ) = default;
+
+            basic_iterator( MapT *map, std::size_t pos )
+                :map_(map)
+                ,pos_(pos)
+            {
+                settle( );
+            }
+
+            /// iterator to const_iterator
+            template <typename M, typename S>
+            basic_iterator( const basic_iterator<M, S> &o )
+                :map_(o.map_)
+                ,pos_(o.pos_)
+            { }
+
+            SlotT &operator * ( ) const
+            {
+                return map_->slots_[pos_];
+            }
+
+            SlotT *operator -> ( ) const
+            {
+                return &map_->slots_[pos_];
+            }
+
+            basic_iterator &operator ++ ( )
+            {
+                ++pos_;
+                settle( );
+                return *this;
+            }
+
+            basic_iterator operator ++ ( int )
+            {
+                auto tmp = *this;
+                ++(*this);
+                return tmp;
+            }
+
+            template <typename M, typename S>
+            bool operator == ( const basic_iterator<M, S> &o ) const
+            {
+                return pos_ == o.pos_;
+            }
+
+            template <typename M, typename S>
+            bool operator != ( const basic_iterator<M, S> &o ) const
+            {
+                return pos_ != o.pos_;
+            }
+
+        private:
+
+            template <typename M, typename S>
+            friend class basic_iterator;
+
+            void settle( )
+            {
+                auto cap = map_->capacity( );
+                while( pos_ < cap && map_->ctrl_[pos_] == free_ctrl ) {
+                    ++pos_;
+                }
+                if( pos_ > cap ) {
+                    pos_ = cap;
+                }
+            }
+
+            MapT        *map_ = nullptr;
+            std::size_t  pos_ = 0;
+        };
+
+        using value_type     = slot;
+        using iterator       = basic_iterator<swiss_map, slot>;
+        using const_iterator = basic_iterator<const swiss_map, const slot>;
+
+        swiss_map( ) = default;
+
+        std::size_t size( ) const
+        {
+            return size_;
+        }
+
+        bool empty( ) const
+        {
+            return size_ == 0;
+        }
+
+        std::size_t capacity( ) const
+        {
+            return ctrl_.size( );
+        }
+
+        /// the next new key makes the map rehash
+        bool full( ) const
+        {
+            return (size_ + 1) * 8 > capacity( ) * 7;
+        }
+
+        iterator begin( )
+        {
+            return iterator( this, 0 );
+        }
+
+        iterator end( )
+        {
+            return iterator( this, capacity( ) );
+        }
+
+        const_iterator begin( ) const
+        {
+            return const_iterator( this, 0 );
+        }
+
+        const_iterator end( ) const
+        {
+            return const_iterator( this, capacity( ) );
+        }
+
+        const_iterator cbegin( ) const
+        {
+            return begin( );
+        }
+
+        const_iterator cend( ) const
+        {
+            return end( );
+        }
+
+        iterator find( const KeyT &key )
+        {
+            return find( key, KeyOps::tag( key ) );
+        }
+
+        iterator find( const KeyT &key, std::uint8_t tag )
+        {
+            return iterator( this, lookup( key, tag,
+                                           KeyOps::hash( key, tag ) ) );
+        }
+
+        const_iterator find( const KeyT &key ) const
+        {
+            return find( key, KeyOps::tag( key ) );
+        }
+
+        /// `tag` is KeyOps::tag( key )
+        const_iterator find( const KeyT &key, std::uint8_t tag ) const
+        {
+            return const_iterator( this, lookup( key, tag,
+                                                 KeyOps::hash( key, tag ) ) );
+        }
+
+        std::pair<iterator, bool> insert( std::pair<KeyT, ValueT> val )
+        {
+            auto tag  = KeyOps::tag( val.first );
+            auto hash = KeyOps::hash( val.first, tag );
+            auto pos  = lookup( val.first, tag, hash );
+            if( pos != capacity( ) ) {
+                return std::make_pair( iterator( this, pos ), false );
+            }
+            pos = place( std::move(val.first), tag, hash );
+            slots_[pos].second = std::move(val.second);
+            return std::make_pair( iterator( this, pos ), true );
+        }
+
+        ValueT &operator [ ]( KeyT key )
+        {
+            auto tag  = KeyOps::tag( key );
+            auto hash = KeyOps::hash( key, tag );
+            auto pos  = lookup( key, tag, hash );
+            if( pos == capacity( ) ) {
+                pos = place( std::move(key), tag, hash );
+            }
+            return slots_[pos].second;
+        }
+
+    private:
+
+        static
+        std::uint64_t mix( std::uint64_t h )
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        static
+        std::uint8_t h2( std::uint64_t mixed )
+        {
+            return static_cast<std::uint8_t>(mixed & 0x7F);
+        }
+
+        /// bit `i` is set if the control byte `i` of the group is `val`
+        std::uint32_t match( std::size_t group, std::uint8_t val ) const
+        {
+            auto ctrl = &ctrl_[group * group_size];
+#if MICO_SWISS_SSE2
+            auto grp = _mm_loadu_si128(
+                            reinterpret_cast<const __m128i *>(ctrl) );
+            auto cmp = _mm_cmpeq_epi8( grp,
+                            _mm_set1_epi8( static_cast<char>(val) ) );
+            return static_cast<std::uint32_t>(_mm_movemask_epi8( cmp ));
+#else
+            std::uint32_t res = 0;
+            for( std::size_t i = 0; i < group_size; ++i ) {
+                res |= std::uint32_t(ctrl[i] == val) << i;
+            }
+            return res;
+#endif
+        }
+
+        static
+        unsigned first_bit( std::uint32_t mask )
+        {
+#if defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_ctz( mask ));
+#else
+            unsigned res = 0;
+            while( !(mask & 1) ) {
+                mask >>= 1;
+                ++res;
+            }
+            return res;
+#endif
+        }
+
+        /// position of the key or capacity( )
+        std::size_t lookup( const KeyT &key, std::uint8_t tag,
+                            std::uint64_t hash ) const
+        {
+            if( size_ == 0 ) {
+                return capacity( );
+            }
+            auto mixed = mix( hash );
+            auto gmask = groups( ) - 1;
+            auto group = static_cast<std::size_t>(mixed >> 7) & gmask;
+            for( std::size_t step = 1; ; ++step ) {
+                auto cand = match( group, h2( mixed ) );
+                while( cand ) {
+                    auto pos = group * group_size + first_bit( cand );
+                    auto &s( slots_[pos] );
+                    if( s.hash == hash &&
+                        KeyOps::equal( s.first, s.tag, key, tag ) )
+                    {
+                        return pos;
+                    }
+                    cand &= cand - 1;
+                }
+                if( match( group, free_ctrl ) ) {
+                    return capacity( );
+                }
+                group = (group + step) & gmask;
+            }
+        }
+
+        /// the key is not in the map
+        std::size_t place( KeyT key, std::uint8_t tag, std::uint64_t hash )
+        {
+            if( full( ) ) {
+                grow( );
+            }
+            auto pos = free_slot( hash );
+            ctrl_[pos] = h2( mix( hash ) );
+            auto &s( slots_[pos] );
+            s.first = std::move(key);
+            s.hash  = hash;
+            s.tag   = tag;
+            ++size_;
+            return pos;
+        }
+
+        std::size_t free_slot( std::uint64_t hash ) const
+        {
+            auto mixed = mix( hash );
+            auto gmask = groups( ) - 1;
+            auto group = static_cast<std::size_t>(mixed >> 7) & gmask;
+            for( std::size_t step = 1; ; ++step ) {
+                if( auto free = match( group, free_ctrl ) ) {
+                    return group * group_size + first_bit( free );
+                }
+                group = (group + step) & gmask;
+            }
+        }
+
+        std::size_t groups( ) const
+        {
+            return capacity( ) / group_size;
+        }
+
+        void grow( )
+        {
+            auto cap = capacity( ) ? capacity( ) * 2 : group_size;
+            std::vector<std::uint8_t> ctrl( cap, free_ctrl );
+            std::vector<slot>         slots( cap );
+            ctrl_.swap( ctrl );
+            slots_.swap( slots );
+            for( std::size_t i = 0; i < ctrl.size( ); ++i ) {
+                if( ctrl[i] != free_ctrl ) {
+                    auto pos = free_slot( slots[i].hash );
+                    ctrl_[pos]  = ctrl[i];
+                    slots_[pos] = std::move(slots[i]);
+                }
+            }
+        }
+
+        std::vector<std::uint8_t> ctrl_;
+        std::vector<slot>         slots_;
+        std::size_t               size_ = 0;
+    };
+
+    template <typename KeyT, typename ValueT, typename KeyOps>
+    const std::size_t swiss_map<KeyT, ValueT, KeyOps>::group_size;
+
+    template <typename KeyT, typename ValueT, typename KeyOps>
+    const std::uint8_t swiss_map<KeyT, ValueT, KeyOps>::free_ctrl;
+
+}}
+
+#undef MICO_SWISS_SSE2
+
+#endif // SWISS_H
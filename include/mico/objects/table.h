@@ -1,11 +1,14 @@
 #ifndef MICO_OBJECTS_TABLE_H
 #define MICO_OBJECTS_TABLE_H
 
-#include <unordered_map>
 #include "mico/objects/base.h"
+#include "mico/objects/numbers.h"
+#include "mico/objects/string.h"
 #include "mico/objects/reference.h"
 #include "mico/objects/null.h"
 #include "mico/objects/collectable.h"
+#include "mico/objects/hamt.h"
+#include "mico/objects/hybrid.h"
 #include "mico/expressions/table.h"
 
 namespace mico { namespace objects {
@@ -27,6 +30,73 @@ namespace mico { namespace objects {
         }
     };
 
+    /// keys of the mutable tables: integers and strings are hashed and
+    /// compared in place, other keys go through their virtual calls.
+    /// Non negative integers go to the array part, strings make records
+    struct key_ops {
+
+        static
+        std::uint8_t tag( const objects::sptr &k )
+        {
+            return static_cast<std::uint8_t>(k->get_type( ));
+        }
+
+        static
+        std::uint64_t hash( const objects::sptr &k, std::uint8_t tag )
+        {
+            if( tag == static_cast<std::uint8_t>(type::INTEGER) ) {
+                return integer::hash(
+                        static_cast<const integer *>(k.get( ))->value( ) );
+            }
+            return k->hash( );
+        }
+
+        static
+        bool equal( const objects::sptr &l, std::uint8_t ltag,
+                    const objects::sptr &r, std::uint8_t rtag )
+        {
+            if( ltag == rtag ) {
+                switch( static_cast<type>(ltag) ) {
+                case type::INTEGER:
+                    return static_cast<const integer *>(l.get( ))->value( )
+                        == static_cast<const integer *>(r.get( ))->value( );
+                case type::STRING:
+                    return static_cast<const string *>(l.get( ))
+                                ->string::equal( r.get( ) );
+                default:
+                    break;
+                }
+            }
+            return l->equal( r.get( ) );
+        }
+
+        static
+        bool index( const objects::sptr &k, std::uint8_t tag,
+                    std::size_t &id )
+        {
+            if( tag == static_cast<std::uint8_t>(type::INTEGER) ) {
+                auto val = static_cast<const integer *>(k.get( ))->value( );
+                if( val >= 0 ) {
+                    id = static_cast<std::size_t>(val);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static
+        objects::sptr key( std::size_t id )
+        {
+            return integer::make( static_cast<std::int64_t>(id) );
+        }
+
+        static
+        bool field( const objects::sptr &, std::uint8_t tag )
+        {
+            return tag == static_cast<std::uint8_t>(type::STRING);
+        }
+    };
+
     template <>
     class impl<type::TABLE>: public collectable<type::TABLE> {
 
@@ -36,13 +106,26 @@ namespace mico { namespace objects {
         static const type type_value = type::TABLE;
         using sptr = std::shared_ptr<this_type>;
         using cont = impl<type::REFERENCE>;
-        using cont_sptr = std::shared_ptr<cont>;
 
-        using value_type = std::unordered_map<objects::sptr, cont_sptr,
-                                              hash_helper, equal_helper>;
+        using value_type = hybrid_map<objects::sptr, objects::sptr, key_ops>;
+        using value_sptr = std::shared_ptr<value_type>;
+        using shape_sptr = value_type::shape_sptr;
+        using tree_type  = hamt<objects::sptr, objects::sptr,
+                                hash_helper, equal_helper>;
 
         impl( environment::sptr e )
             :collectable<type::TABLE>(e)
+            ,value_(std::make_shared<value_type>( ))
+        { }
+
+        impl( environment::sptr e, value_sptr val )
+            :collectable<type::TABLE>(e)
+            ,value_(std::move(val))
+        { }
+
+        impl( environment::sptr e, tree_type val )
+            :collectable<type::TABLE>(e)
+            ,tree_(std::move(val))
         { }
 
         std::string str( ) const override
@@ -50,87 +133,239 @@ namespace mico { namespace objects {
             std::ostringstream oss;
             oss << "{ ";
             bool first = true;
-            for( auto &v: value_ ) {
+            for_each( [&]( const objects::sptr &k, const objects::sptr &v ) {
                 if( !first ) {
                     oss << ", ";
                 } else {
                     first = false;
                 }
-                oss << v.first->str( ) << ":";
-                oss << v.second->value( )->str( );
-            }
+                oss << k->str( ) << ":";
+                oss << v->str( );
+            } );
             oss << " }";
             return oss.str( );
         }
 
         std::size_t size( ) const override
         {
-            return value_.size( );
+            return value_ ? value_->size( ) : tree_.size( );
         }
 
-        const value_type &value( ) const
+        /// flat storage; empty if the entries are in the tree
+        const value_sptr &storage( ) const
         {
             return value_;
         }
 
-        value_type &value( )
+        /// the shape of the entries if they are kept as a record;
+        /// see hybrid_map
+        const shape_sptr &record_shape( ) const
         {
-            return value_;
+            static const shape_sptr none;
+            return value_ ? value_->record_shape( ) : none;
+        }
+
+        /// the slot of `key` in record_shape( ) or npos
+        std::size_t field_slot( const objects::sptr &key ) const
+        {
+            return value_ ? value_->field_slot( key )
+                          : value_type::shape_type::npos;
+        }
+
+        /// the value in the slot `id` of record_shape( ) the way `at`
+        /// gives it; empty if a mutable table has to copy its entries first
+        objects::sptr at_field( std::size_t id )
+        {
+            if( is_mutable( ) && value_.use_count( ) > 1 ) {
+                return nullptr;
+            }
+            return cont::slot_value( value_->field( id ) );
+        }
+
+        /// the slot of `key`; see reference::make_slot
+        const objects::sptr *find( const objects::sptr &key ) const
+        {
+            return value_ ? value_->find( key ) : tree_.find( key );
+        }
+
+        /// calls `call` with the keys and the values
+        template <typename CallT>
+        void for_each( CallT call ) const
+        {
+            for_each_slot( [&call]( const objects::sptr &k,
+                                    const objects::sptr &v ) {
+                call( k, cont::slot_value( v ) );
+            } );
+        }
+
+        /// Clones share the entries until one of them is written;
+        /// see array::mutable_value
+        value_type &mutable_value( )
+        {
+            if( !value_ || value_.use_count( ) > 1 ) {
+                auto copy = std::make_shared<value_type>( );
+                auto my_env = env( );
+                for_each( [&]( const objects::sptr &k,
+                               const objects::sptr &v ) {
+                    auto kc = k->clone( );
+                    auto vc = cont::make_slot( my_env.get( ), v->clone( ) );
+                    copy->insert( std::make_pair(kc, vc) );
+                } );
+                value_ = copy;
+                tree_  = tree_type( );
+            }
+            hash_ = 0;
+            return *value_;
+        }
+
+        /// Immutable tables keep the entries in a persistent trie after
+        /// the first merge; see array::tree
+        const tree_type &tree( )
+        {
+            if( value_ ) {
+                bool own = value_.use_count( ) == 1;
+                auto my_env = env( );
+                tree_type res;
+                value_->for_each( [&]( const objects::sptr &k,
+                                       const objects::sptr &v ) {
+                    res = res.insert( k, own
+                        ? v
+                        : cont::make_slot( my_env.get( ),
+                                           cont::slot_value( v )->clone( ) ) );
+                } );
+                tree_ = res;
+                value_.reset( );
+            }
+            return tree_;
         }
 
         bool set( const environment *env, objects::sptr key, objects::sptr val )
         {
-            value_[key->clone( )] = cont::make_var(env, val);
+            hash_ = 0;
+            if( !value_ ) {
+                tree_ = tree_.insert( key->clone( ),
+                                      cont::make_slot( env, std::move(val) ) );
+            } else {
+                mutable_value( )[key->clone( )] =
+                                      cont::make_slot( env, std::move(val) );
+            }
             return true;
         }
 
         bool insert( const environment *env,
                      objects::sptr key, objects::sptr val )
         {
-            auto f = value_.find( key );
-            if( f == value_.end( ) ) {
+            if( !find( key ) ) {
                 return set( env, key, val );
             }
             return false;
         }
 
+        /// `this + other`: the keys of `other` that are not here yet.
+        /// An immutable result shares the entries of both sides and takes
+        /// O(log32 n) per new key
+        objects::sptr merge( const environment *menv, this_type *other )
+        {
+            if( is_mutable( ) ) {
+                auto res = clone( );
+                auto restab = static_cast<this_type *>(res.get( ));
+                other->for_each( [&]( const objects::sptr &k,
+                                      const objects::sptr &v ) {
+                    restab->insert( menv, k, v );
+                } );
+                return res;
+            }
+
+            auto res = tree( );
+            bool share = !other->is_mutable( );
+            other->for_each_slot( [&]( const objects::sptr &k,
+                                       const objects::sptr &v ) {
+                if( !res.find( k ) ) {
+                    res = share
+                        ? res.insert( k, v )
+                        : res.insert( k->clone( ),
+                                      cont::make_slot( menv,
+                                                cont::slot_value( v ) ) );
+                }
+            } );
+            return std::make_shared<this_type>( env( ), std::move(res) );
+        }
+
+        /// Does not depend on the order of the entries, which differs
+        /// between the storages. Cached the way array::hash is
         hash_type hash( ) const override
         {
-            auto h = static_cast<std::uint64_t>(get_type( ));
-            for( auto &o: value( ) ) {
-                h = base::hash64( h + o.first->hash( ) +
-                                      o.second->hash( ) );
+            if( known_hash( ) ) {
+                return hash_;
+            }
+            std::uint64_t sum = 0;
+            bool stable = !is_mutable( );
+            for_each( [&]( const objects::sptr &k,
+                           const objects::sptr &val ) {
+                sum += base::hash64( k->hash( ) +
+                                     base::hash64( val->hash( ) ) );
+                stable = stable && k->hash_stable( ) && val->hash_stable( );
+            } );
+            auto tid = static_cast<std::uint64_t>(get_type( ));
+            auto h   = base::hash64( sum + tid );
+            if( stable ) {
+                hash_ = h;
             }
             return h;
         }
 
+        bool hash_stable( ) const override
+        {
+            hash( );
+            return known_hash( );
+        }
+
         objects::sptr at( objects::sptr id )
         {
-            objects::sptr ptr = id;
-            auto f = value_.find( ptr );
-            if(f == value_.end( )) {
+            auto f = find( id );
+            if( !f ) {
                 return nullptr;
-            } else {
-                return is_mutable( ) ? f->second : f->second->value( );
+            } else if( is_mutable( ) &&
+                       ( !value_ || value_.use_count( ) > 1 ) )
+            {
+                f = mutable_value( ).find( id );
+            }
+            return cont::slot_value( *f );
+        }
+
+        /// `at` for a value that is going to be written; see array::ref_at
+        objects::sptr ref_at( objects::sptr id )
+        {
+            if( !is_mutable( ) || !find( id ) ) {
+                return at( id );
             }
+            auto my_env = env( );
+            return cont::slot_ref( my_env.get( ),
+                                   *mutable_value( ).find( id ) );
         }
 
         bool equal( const base *other ) const override
         {
             if( other->get_type( ) == get_type( ) ) {
                 auto o = static_cast<const this_type *>( other );
-                if( o->value( ).size( ) == value( ).size( ) ) {
-                    for( auto &next: value( ) ) {
-                        auto f = o->value( ).find( next.first );
-                        if( f == o->value( ).end( ) ) {
-                            return false;
-                        }
-                        auto ch = f->second->value( );
-                        if( !next.second->value( )->equal( ch.get( ) ) ) {
-                            return false;
-                        }
-                    }
+                if( value_ && o->value_ == value_ ) {
                     return true;
+                } else if( known_hash( ) && o->known_hash( ) &&
+                           hash_ != o->hash_ )
+                {
+                    return false;
+                }
+                if( o->size( ) == size( ) ) {
+                    bool res = true;
+                    for_each( [&]( const objects::sptr &k,
+                                   const objects::sptr &v ) {
+                        if( !res ) {
+                            return;
+                        }
+                        auto f = o->find( k );
+                        res = f && v->equal( cont::slot_value( *f ).get( ) );
+                    } );
+                    return res;
                 }
             }
             return false;
@@ -149,15 +384,11 @@ namespace mico { namespace objects {
 
         objects::sptr clone( ) const override
         {
-            using ref = impl<type::REFERENCE>;
-            auto res = make( env( ) );
-            for( auto &v: value( ) ) {
-                auto kc = v.first->clone( );
-                auto vc = ref::make_var( v.second->env( ),
-                                         v.second->value( )->clone( ) );
-                res->value( ).insert( std::make_pair(kc, vc) );
-            }
+            auto res = value_
+                     ? std::make_shared<this_type>( env( ), value_ )
+                     : std::make_shared<this_type>( env( ), tree_ );
             res->set_mutable( is_mutable( ) );
+            res->hash_ = is_mutable( ) ? 0 : hash_;
             return res;
         }
 
@@ -166,12 +397,12 @@ namespace mico { namespace objects {
             using ast_type = ast::expressions::impl<ast::type::TABLE>;
             ast_type::uptr res(new ast_type);
             res->set_pos(pos);
-            for( auto &v: value_ ) {
-                auto fast = v.first->to_ast( pos );
-                auto sast = v.second->value( )->to_ast( pos );
+            for_each( [&]( const objects::sptr &k, const objects::sptr &v ) {
+                auto fast = k->to_ast( pos );
+                auto sast = v->to_ast( pos );
                 res->value( ).emplace_back( ast::expression::cast(fast),
                                             ast::expression::cast(sast) );
-            }
+            } );
             if( is_mutable( ) ) {
                 auto mut = ast::expressions::mod_mut::make(std::move( res ));
                 return ast::node::uptr( std::move( mut ) );
@@ -181,7 +412,25 @@ namespace mico { namespace objects {
         }
 
     private:
-        value_type value_;
+
+        template <typename CallT>
+        void for_each_slot( CallT call ) const
+        {
+            if( value_ ) {
+                value_->for_each( call );
+            } else {
+                tree_.for_each( call );
+            }
+        }
+
+        bool known_hash( ) const
+        {
+            return hash_ && !is_mutable( );
+        }
+
+        value_sptr value_;
+        tree_type  tree_;
+        mutable hash_type hash_ = 0;
     };
 
     using table = impl<type::TABLE>;
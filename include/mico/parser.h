@@ -6,6 +6,9 @@
 #include <memory>
 #include <functional>
 #include <fstream>
+#include <algorithm>
+
+#include "etool/details/result.h"
 
 #include "mico/lexer.h"
 #include "mico/operations.h"
@@ -57,232 +60,269 @@ namespace mico {
         using token_iterator  = lexer::token_list::const_iterator;
         using token_type      = lexer::token_type;
         using token_info      = lexer::token_info;
-        using nuds_call       = std::function<expression_uptr( )>;
-        using leds_call       = std::function<expression_uptr(expression_uptr)>;
-
-        using nuds_map        = std::map<token_type, nuds_call>;
-        using leds_map        = std::map<token_type, leds_call>;
+        using token_source    = std::function<bool(token_info &)>;
+        using nud_call        = expression_uptr (parser::*)( );
+        using led_call        = expression_uptr (parser::*)( expression_uptr );
 
         using errors_list     = std::vector<std::string>;
-        using special_map     = std::map<token_type, special_token>;
 
         using precedence      = operations::precedence;
 
+        /// what the parser does with a token
+        struct rule {
+            nud_call    nud     = nullptr;
+            led_call    led     = nullptr;
+            precedence  prec    = precedence::LOWEST;
+            bool        special = false;
+        };
+
+        static const std::size_t rule_count =
+                static_cast<std::size_t>(token_type::LAST_VISIBLE) + 1;
+
         explicit
         parser( lexer lex )
             :lexer_(std::move(lex))
         {
             reset( );
-            fill_nuds( );
-            fill_leds( );
+            fill_special( );
+        }
+
+        /// tokens are pulled from the source on demand
+        explicit
+        parser( token_source source )
+            :source_(std::move(source))
+        {
+            reset( );
             fill_special( );
         }
 
         void reset( )
         {
-            cur_ = peek_ = lexer_.begin( );
-            if( peek_ != lexer_.end( ) ) {
-                ++peek_;
-            }
+            next_ = lexer_.begin( );
+            pull( cur_ );
+            pull( peek_ );
             errors_.clear( );
         }
 
         void fill_special( )
         {
-            special_[token_type::BREAK].disabled    = true;
-            special_[token_type::CONTINUE].disabled = true;
-            special_[token_type::ELIPSIS].disabled  = true;
-        }
-
-        void fill_nuds( )
-        {
-            nuds_[token_type::IDENT]   = [this]( ) { return parse_ident( );  };
-            nuds_[token_type::INFIN]   = [this]( ) { return parse_inf( );    };
-            nuds_[token_type::STRING]  = [this]( ) { return parse_string( ); };
-            nuds_[token_type::RSTRING] = [this]( ) { return parse_rstring( );};
-            nuds_[token_type::FLOAT]   = [this]( ) { return parse_float( );  };
-            nuds_[token_type::LPAREN]  = [this]( ) { return parse_paren( );  };
-
-            nuds_[token_type::BOOL_TRUE]  = [this]( ) { return parse_bool( ); };
-            nuds_[token_type::BOOL_FALSE] = [this]( ) { return parse_bool( ); };
-            nuds_[token_type::FOR]        = [this]( ) { return parse_for( );  };
-
-            nuds_[token_type::IF] =
-                    [this]( ) {
-                        return parse_if( false );
-                    };
-
-            nuds_[token_type::UNLESS] =
-                    [this]( ) {
-                        return parse_if( true );
-                    };
-
-            nuds_[token_type::MOD_MUT] =
-                    [this]( ) {
-                        return parse_mut( true );
-                    };
-            nuds_[token_type::MOD_CONST] =
-                    [this]( ) {
-                        return parse_mut( false );
-                    };
-
-            nuds_[token_type::CHARACTER]  =
-                    [this]( ) {
-                        return parse_char( );
-                    };
-
-            nuds_[token_type::FUNCTION]   =
-                    [this]( ) {
-                        return parse_function( );
-                    };
-            nuds_[token_type::MODULE]   =
-                    [this]( ) {
-                        return parse_module( nullptr );
-                    };
+            special_[static_cast<std::size_t>(token_type::BREAK)]
+                                                        .disabled = true;
+            special_[static_cast<std::size_t>(token_type::CONTINUE)]
+                                                        .disabled = true;
+            special_[static_cast<std::size_t>(token_type::ELIPSIS)]
+                                                        .disabled = true;
+        }
+
+        /// Handlers and precedences indexed by token type.
+        /// Built once; every parser shares it
+        class rule_table {
+
+        public:
+
+            rule_table( )
+            {
+                using TT = token_type;
+                using OP = precedence;
+                using P  = parser;
+                namespace E = ast::expressions;
+
+                nud( TT::IDENT,      &P::parse_ident );
+                nud( TT::INFIN,      &P::nud<E::infinite::uptr,
+                                             &P::parse_inf> );
+                nud( TT::STRING,     &P::nud<E::string::uptr,
+                                             &P::parse_string> );
+                nud( TT::RSTRING,    &P::nud<E::string::uptr,
+                                             &P::parse_rstring> );
+                nud( TT::FLOAT,      &P::nud<E::floating::uptr,
+                                             &P::parse_float> );
+                nud( TT::LPAREN,     &P::parse_paren );
+
+                nud( TT::BOOL_TRUE,  &P::nud<E::boolean::uptr,
+                                             &P::parse_bool> );
+                nud( TT::BOOL_FALSE, &P::nud<E::boolean::uptr,
+                                             &P::parse_bool> );
+                nud( TT::FOR,        &P::nud<E::forin::uptr,
+                                             &P::parse_for> );
+
+                nud( TT::IF,         &P::nud_if );
+                nud( TT::UNLESS,     &P::nud_unless );
+                nud( TT::MOD_MUT,    &P::nud_mut );
+                nud( TT::MOD_CONST,  &P::nud_const );
+
+                nud( TT::CHARACTER,  &P::nud<E::character::uptr,
+                                             &P::parse_char> );
+                nud( TT::FUNCTION,   &P::nud<E::function::uptr,
+                                             &P::parse_function> );
+                nud( TT::MODULE,     &P::nud_module );
 
 #if !defined(DISABLE_MACRO) || !DISABLE_MACRO
-            nuds_[token_type::MACRO]   =
-                    [this]( ) {
-                        return parse_macro( );
-                    };
-
-            nuds_[token_type::QUOTE]   =
-                    [this]( ) {
-                        return parse_quote( );
-                    };
-
-            nuds_[token_type::UNQUOTE]   =
-                    [this]( ) {
-                        return parse_unquote( );
-                    };
+                nud( TT::MACRO,      &P::nud<E::macro::uptr,
+                                             &P::parse_macro> );
+                nud( TT::QUOTE,      &P::nud<E::quote::uptr,
+                                             &P::parse_quote> );
+                nud( TT::UNQUOTE,    &P::nud<E::unquote::uptr,
+                                             &P::parse_unquote> );
 #endif
 
-            nuds_[token_type::LBRACE]   =
-                    [this]( ) {
-                        return parse_table( );
-                    };
-
-            nuds_[token_type::LBRACKET] =
-                    [this]( ) {
-                        return parse_array( );
-                    };
-            nuds_[token_type::ELIPSIS] =
-                    [this]( ) {
-                        return parse_elipsis( );
-                    };
-
-            nuds_[token_type::MINUS]    =
-            nuds_[token_type::BANG]     =
-            nuds_[token_type::TILDA]    =
-            nuds_[token_type::ASTERISK] =
-                    [this]( ) {
-                        return parse_prefix( );
-                    };
-
-            nuds_[token_type::INT_BIN] =
-            nuds_[token_type::INT_TER] =
-            nuds_[token_type::INT_OCT] =
-            nuds_[token_type::INT_DEC] =
-            nuds_[token_type::INT_HEX] =
-                    [this]( ) {
-                        return parse_int( );
-                    };
-
-            nuds_[token_type::END_OF_FILE] =
-                    [this]( ) {
-                        return unexpected_eof( );
-                    };
-        }
-
-        void fill_leds( )
-        {
-            using EP = expression_uptr;
-            leds_[token_type::DOT]          =
-            leds_[token_type::MINUS]        =
-            leds_[token_type::PLUS]         =
-            leds_[token_type::ASTERISK]     =
-            leds_[token_type::ASSIGN]       =
-            leds_[token_type::SLASH]        =
-            leds_[token_type::PERCENT]      =
-            leds_[token_type::LT]           =
-            leds_[token_type::GT]           =
-            leds_[token_type::LT_EQ]        =
-            leds_[token_type::GT_EQ]        =
-            leds_[token_type::EQ]           =
-            leds_[token_type::NOT_EQ]       =
-            leds_[token_type::LOGIC_OR]     =
-            leds_[token_type::LOGIC_AND]    =
-            leds_[token_type::BIT_OR]       =
-            leds_[token_type::BIT_XOR]      =
-            leds_[token_type::BIT_AND]      =
-            leds_[token_type::SHIFT_LEFT]   =
-            leds_[token_type::SHIFT_RIGHT]  =
-            leds_[token_type::DOTDOT]       =
-            leds_[token_type::OP_IN]        =
-                    [this]( EP e ) {
-                        return parse_infix(std::move(e));
-                    };
-            leds_[token_type::LPAREN]   =
-                    [this]( EP e ) {
-                        return parse_call(std::move(e));
-                    };
-            leds_[token_type::LBRACKET]   =
-                    [this]( EP e ) {
-                        return parse_index(std::move(e));
-                    };
-
-            leds_[token_type::IF] =
-                    [this]( EP e ) {
-                        return parse_if_infix( std::move(e), false );
-                    };
-
-            leds_[token_type::UNLESS] =
-                    [this]( EP e ) {
-                        return parse_if_infix( std::move(e), true );
-                    };
+                nud( TT::LBRACE,     &P::nud<E::table::uptr,
+                                             &P::parse_table> );
+                nud( TT::LBRACKET,   &P::nud<E::array::uptr,
+                                             &P::parse_array> );
+                nud( TT::ELIPSIS,    &P::nud<E::elipsis::uptr,
+                                             &P::parse_elipsis> );
+
+                for( auto tt: { TT::MINUS, TT::BANG, TT::TILDA,
+                                TT::ASTERISK } ) {
+                    nud( tt, &P::nud<E::prefix::uptr, &P::parse_prefix> );
+                }
 
+                for( auto tt: { TT::INT_BIN, TT::INT_TER, TT::INT_OCT,
+                                TT::INT_DEC, TT::INT_HEX } ) {
+                    nud( tt, &P::nud<E::integer::uptr, &P::parse_int> );
+                }
+
+                nud( TT::END_OF_FILE, &P::unexpected_eof );
+
+                for( auto tt: { TT::DOT, TT::MINUS, TT::PLUS, TT::ASTERISK,
+                                TT::ASSIGN, TT::SLASH, TT::PERCENT,
+                                TT::LT, TT::GT, TT::LT_EQ, TT::GT_EQ,
+                                TT::EQ, TT::NOT_EQ,
+                                TT::LOGIC_OR, TT::LOGIC_AND,
+                                TT::BIT_OR, TT::BIT_XOR, TT::BIT_AND,
+                                TT::SHIFT_LEFT, TT::SHIFT_RIGHT,
+                                TT::DOTDOT, TT::OP_IN } ) {
+                    led( tt, &P::led<E::infix::uptr, &P::parse_infix> );
+                }
+                led( TT::LPAREN,   &P::led<E::call::uptr, &P::parse_call> );
+                led( TT::LBRACKET, &P::led<E::index::uptr,
+                                           &P::parse_index> );
+                led( TT::IF,       &P::led_if );
+                led( TT::UNLESS,   &P::led_unless );
+
+                prec( TT::IF,           OP::INFIXIF     );
+                prec( TT::UNLESS,       OP::INFIXIF     );
+                prec( TT::ASSIGN,       OP::ASSIGN      );
+                prec( TT::EQ,           OP::EQUALS      );
+                prec( TT::NOT_EQ,       OP::EQUALS      );
+                prec( TT::LT,           OP::LESSGREATER );
+                prec( TT::GT,           OP::LESSGREATER );
+                prec( TT::LT_EQ,        OP::LESSGREATER );
+                prec( TT::GT_EQ,        OP::LESSGREATER );
+                prec( TT::LOGIC_OR,     OP::LOGIC_OR    );
+                prec( TT::LOGIC_AND,    OP::LOGIC_AND   );
+                prec( TT::BIT_OR,       OP::BIT_OR      );
+                prec( TT::BIT_XOR,      OP::BIT_XOR     );
+                prec( TT::BIT_AND,      OP::BIT_AND     );
+                prec( TT::SHIFT_LEFT,   OP::BIT_SHIFT   );
+                prec( TT::SHIFT_RIGHT,  OP::BIT_SHIFT   );
+                prec( TT::PLUS,         OP::SUM         );
+                prec( TT::MINUS,        OP::SUM         );
+                prec( TT::SLASH,        OP::PRODUCT     );
+                prec( TT::PERCENT,      OP::PRODUCT     );
+                prec( TT::ASTERISK,     OP::PRODUCT     );
+                prec( TT::LPAREN,       OP::CALL        );
+                prec( TT::LBRACKET,     OP::INDEX       );
+                prec( TT::DOT,          OP::DOT         );
+                prec( TT::DOTDOT,       OP::DOTDOT      );
+                prec( TT::OP_IN,        OP::EQUALS      );
+
+                rules_[id( TT::BREAK )].special    = true;
+                rules_[id( TT::CONTINUE )].special = true;
+                rules_[id( TT::ELIPSIS )].special  = true;
+            }
+
+            const rule &get( token_type tt ) const
+            {
+                auto i = id( tt );
+                return (i < rule_count) ? rules_[i] : rules_[0];
+            }
+
+        private:
+
+            static
+            std::size_t id( token_type tt )
+            {
+                return static_cast<std::size_t>(tt);
+            }
+
+            void nud( token_type tt, nud_call call )
+            {
+                rules_[id( tt )].nud = call;
+            }
+
+            void led( token_type tt, led_call call )
+            {
+                rules_[id( tt )].led = call;
+            }
+
+            void prec( token_type tt, precedence p )
+            {
+                rules_[id( tt )].prec = p;
+            }
+
+            rule rules_[rule_count];
+        };
+
+        static
+        const rule &get_rule( token_type tt )
+        {
+            static const rule_table inst;
+            return inst.get( tt );
         }
 
         static
         operations::precedence get_precedence( token_type tt )
         {
-            using TT = token_type;
-            using OP = operations::precedence;
-
-            static const std::map<TT, OP> val = {
-                { TT::IF,           OP::INFIXIF     },
-                { TT::UNLESS,       OP::INFIXIF     },
-                { TT::ASSIGN,       OP::ASSIGN      },
-                { TT::EQ,           OP::EQUALS      },
-                { TT::NOT_EQ,       OP::EQUALS      },
-                { TT::LT,           OP::LESSGREATER },
-                { TT::GT,           OP::LESSGREATER },
-                { TT::LT_EQ,        OP::LESSGREATER },
-                { TT::GT_EQ,        OP::LESSGREATER },
-                { TT::LOGIC_OR,     OP::LOGIC_OR    },
-                { TT::LOGIC_AND,    OP::LOGIC_AND   },
-                { TT::BIT_OR,       OP::BIT_OR      },
-                { TT::BIT_XOR,      OP::BIT_XOR     },
-                { TT::BIT_AND,      OP::BIT_AND     },
-                { TT::SHIFT_LEFT,   OP::BIT_SHIFT   },
-                { TT::SHIFT_RIGHT,  OP::BIT_SHIFT   },
-                { TT::PLUS,         OP::SUM         },
-                { TT::MINUS,        OP::SUM         },
-                { TT::SLASH,        OP::PRODUCT     },
-                { TT::PERCENT,      OP::PRODUCT     },
-                { TT::ASTERISK,     OP::PRODUCT     },
-                { TT::LPAREN,       OP::CALL        },
-                { TT::LBRACKET,     OP::INDEX       },
-                { TT::DOT,          OP::DOT         },
-                { TT::DOTDOT,       OP::DOTDOT      },
-                { TT::OP_IN,        OP::EQUALS      },
-            };
+            return get_rule( tt ).prec;
+        }
 
-            auto f = val.find( tt );
-            if( f !=  val.end( ) ){
-                return f->second;
-            }
-            return OP::LOWEST;
+        /// table adapters for handlers that return a concrete node
+        template <typename R, R (parser::*Call)( )>
+        expression_uptr nud( )
+        {
+            return expression_uptr( (this->*Call)( ) );
+        }
+
+        template <typename R, R (parser::*Call)( expression_uptr )>
+        expression_uptr led( expression_uptr left )
+        {
+            return expression_uptr( (this->*Call)( std::move(left) ) );
+        }
+
+        expression_uptr nud_if( )
+        {
+            return expression_uptr( parse_if( false ) );
+        }
+
+        expression_uptr nud_unless( )
+        {
+            return expression_uptr( parse_if( true ) );
+        }
+
+        expression_uptr nud_mut( )
+        {
+            return parse_mut( true );
+        }
+
+        expression_uptr nud_const( )
+        {
+            return parse_mut( false );
+        }
+
+        expression_uptr nud_module( )
+        {
+            return expression_uptr( parse_module( nullptr ) );
+        }
+
+        expression_uptr led_if( expression_uptr left )
+        {
+            return expression_uptr( parse_if_infix( std::move(left), false ) );
+        }
+
+        expression_uptr led_unless( expression_uptr left )
+        {
+            return expression_uptr( parse_if_infix( std::move(left), true ) );
         }
 
         ////////////// errors ///////
@@ -377,14 +417,27 @@ namespace mico {
             return eof_value;
         }
 
+        void pull( token_info &ti )
+        {
+            if( source_ ) {
+                if( !source_( ti ) ) {
+                    ti = eof_token( );
+                }
+            } else if( next_ != lexer_.end( ) ) {
+                ti = *next_++;
+            } else {
+                ti = eof_token( );
+            }
+        }
+
         const token_info &current( ) const
         {
-            return (cur_ == lexer_.end( )) ? eof_token( ) : *cur_;
+            return cur_;
         }
 
         const token_info &peek( ) const
         {
-            return (peek_ == lexer_.end( )) ? eof_token( ) : *peek_;
+            return peek_;
         }
 
         precedence peek_precedence( ) const
@@ -415,16 +468,13 @@ namespace mico {
 
         void advance( )
         {
-            cur_ = peek_;
-            if( peek_ != lexer_.end( ) ) {
-                ++peek_;
-            }
+            cur_ = std::move(peek_);
+            pull( peek_ );
         }
 
         bool eof( ) const
         {
-            return (cur_ == lexer_.end( ))
-                || (cur_->ident.name == token_type::END_OF_FILE );
+            return cur_.ident.name == token_type::END_OF_FILE;
         }
 
         const errors_list &errors( ) const
@@ -434,9 +484,8 @@ namespace mico {
 
         special_token *get_spec_tok( token_type tt )
         {
-            auto f = special_.find( tt );
-            if( f != special_.end( ) ) {
-                return &f->second;
+            if( get_rule( tt ).special ) {
+                return &special_[static_cast<std::size_t>(tt)];
             }
             return nullptr;
         }
@@ -451,8 +500,7 @@ namespace mico {
         bool is_current_expression(  ) const
         {
             if( !is_current( token_type::END_OF_FILE ) ) {
-                auto nud = nuds_.find( current( ).ident.name );
-                return nud != nuds_.end( );
+                return get_rule( current( ).ident.name ).nud != nullptr;
             }
             return false;
         }
@@ -460,8 +508,7 @@ namespace mico {
         bool is_peek_expression(  ) const
         {
             if( !is_current( token_type::END_OF_FILE ) ) {
-                auto nud = nuds_.find( peek( ).ident.name );
-                return nud != nuds_.end( );
+                return get_rule( peek( ).ident.name ).nud != nullptr;
             }
             return false;
         }
@@ -675,11 +722,27 @@ namespace mico {
             return  res;
         }
 
+        /// `a[i, j]` is `a[[i, j]]`
         ast::expressions::index::uptr parse_index( expression_uptr left )
         {
             using index_type = ast::expressions::index;
+            using array_type = ast::expressions::array;
             advance( );
             auto expr = parse_expression( precedence::LOWEST );
+            if( expr && expect_peek( token_type::COMMA, false ) ) {
+                array_type::uptr pair(new array_type);
+                pair->set_pos( expr->pos( ) );
+                pair->value( ).emplace_back( std::move(expr) );
+                do {
+                    advance( );
+                    auto next = parse_expression( precedence::LOWEST );
+                    if( !next ) {
+                        return nullptr;
+                    }
+                    pair->value( ).emplace_back( std::move(next) );
+                } while( expect_peek( token_type::COMMA, false ) );
+                expr = std::move(pair);
+            }
             if( expr && expect_peek( token_type::RBRACKET ) ) {
                 return index_type::uptr(new index_type(std::move(left),
                                                        std::move(expr) ) );
@@ -849,7 +912,10 @@ namespace mico {
         {
             using ident_type = ast::expressions::ident;
 
-            auto res = ident_type::make(current( ).ident.literal );
+            const auto &cur( current( ).ident );
+            auto res = ident_type::make( (cur.name == token_type::IDENT)
+                                         ? cur.sym
+                                         : symbol( cur.literal ) );
 
             if( (peek( ).ident.name == token_type::LPAREN) ) {
                 advance( );
@@ -977,13 +1043,13 @@ namespace mico {
         {
             ast::expression::uptr left;
 
-            auto nud = nuds_.find( current( ).ident.name );
-            if( nud == nuds_.end( ) ) {
+            auto nud = get_rule( current( ).ident.name ).nud;
+            if( !nud ) {
                 error_no_prefix( );
                 return nullptr;
             }
 
-            left = nud->second( );
+            left = (this->*nud)( );
             if( !left ) {
                 return ast::expression::uptr( );
             }
@@ -993,14 +1059,14 @@ namespace mico {
 
             while( (pt != token_type::SEMICOLON) && (p < pp) ) {
 
-                auto led = leds_.find( pt );
-                if( led == leds_.end( ) ) {
+                auto led = get_rule( pt ).led;
+                if( !led ) {
                     error_no_suffix( );
                     return nullptr;
                 }
 
                 advance( );
-                left = led->second(std::move(left));
+                left = (this->*led)( std::move(left) );
                 if( !left ) {
                     return nullptr;
                 }
@@ -1061,7 +1127,7 @@ namespace mico {
             } else if( expect_peek( token_type::STRING, false ) ) {
                 id = parse_string( );
             } else /*if( !id )*/ {
-                id = ast::expressions::ident::make( "" );
+                id = ast::expressions::ident::make( symbol( ) );
             }
 
             auto parents = ast::expressions::list::make_params( );
@@ -1125,7 +1191,21 @@ namespace mico {
 
             if( expect_peek( token_type::LBRACE, false ) ) {
                 advance( );
-                res->set_body( parse_scope( ) );
+                if( lazy_bodies_ ) {
+                    auto lazy = skip_scope( );
+                    /// quotes are rewritten by the evaluator,
+                    /// so they must be seen right now
+                    if( lazy->macros ) {
+                        parse_lazy( *lazy );
+                        errors_.insert( errors_.end( ), lazy->errors.begin( ),
+                                        lazy->errors.end( ) );
+                        res->set_body( lazy->body->clone( ) );
+                    } else {
+                        res->set_lazy( std::move(lazy) );
+                    }
+                } else {
+                    res->set_body( parse_scope( ) );
+                }
                 return res;
             } else {
                 advance( );
@@ -1135,6 +1215,45 @@ namespace mico {
             //return nullptr;
         }
 
+        /// Pre-parse: only matches the braces and keeps the tokens.
+        /// Stops on the closing brace (or EOF) as `parse_scope` does
+        ast::expressions::lazy_body::sptr skip_scope( )
+        {
+            using lazy_body = ast::expressions::lazy_body;
+
+            auto res = std::make_shared<lazy_body>( );
+            res->parse = &parser::parse_lazy;
+            std::size_t depth = 1;
+
+            while( !eof( ) ) {
+                auto tt = current( ).ident.name;
+                if( tt == token_type::LBRACE ) {
+                    ++depth;
+                } else if( tt == token_type::RBRACE ) {
+                    if( --depth == 0 ) {
+                        res->tokens.emplace_back( current( ) );
+                        break;
+                    }
+                } else if( tt == token_type::IDENT ) {
+                    res->names.emplace_back( current( ).ident.sym );
+#if !defined(DISABLE_MACRO) || !DISABLE_MACRO
+                } else if( tt == token_type::MACRO
+                        || tt == token_type::QUOTE
+                        || tt == token_type::UNQUOTE ) {
+                    res->macros = true;
+#endif
+                }
+                res->tokens.emplace_back( std::move(cur_) );
+                advance( );
+            }
+
+            std::sort( res->names.begin( ), res->names.end( ) );
+            res->names.erase( std::unique( res->names.begin( ),
+                                           res->names.end( ) ),
+                              res->names.end( ) );
+            return res;
+        }
+
 #if !defined(DISABLE_MACRO) || !DISABLE_MACRO
 
         ast::statement::uptr parse_macro_state(  )
@@ -1436,14 +1555,84 @@ namespace mico {
             return pp.parse( );
         }
 
+        /// Parses [begin, end) without building the whole token list.
+        /// Lexer errors win over parser ones as in `parse(std::string)`.
+        /// With `lazy` function bodies are only pre-parsed; their syntax
+        /// errors show up when they are called
+        template <typename ItrT>
+        static
+        ast::program parse( ItrT begin, ItrT end, bool lazy = false )
+        {
+            lexer::stream<ItrT> stm( begin, end );
+
+            parser pp( [&stm]( token_info &ti ) { return stm.next( ti ); } );
+            pp.set_lazy_bodies( lazy );
+            auto prog = pp.parse( );
+
+            token_info rest;
+            while( stm.next( rest ) ) { }
+
+            ast::program::error_list errors;
+            for( auto &e: stm.errors( ) ) {
+                errors.emplace_back( std::string("lexer error: ") + e );
+            }
+
+            if( !errors.empty( ) ) {
+                ast::program res;
+                res.set_errors( std::move(errors) );
+                return res;
+            }
+
+            return prog;
+        }
+
+        /// Parses a pre-parsed function body once.
+        /// false if there are errors; they are in `lazy.errors`
+        static
+        bool parse_lazy( ast::expressions::lazy_body &lazy )
+        {
+            if( !lazy.done ) {
+                auto next = lazy.tokens.cbegin( );
+                auto end  = lazy.tokens.cend( );
+                /// errors at the end point to the last token of the body
+                token_info eof( token_type::END_OF_FILE );
+                if( next != end ) {
+                    eof.where = lazy.tokens.back( ).where;
+                }
+                parser pp( [&next, end, &eof]( token_info &ti ) {
+                    ti = (next == end) ? eof : *next++;
+                    return true;
+                } );
+                pp.set_lazy_bodies( true );
+                lazy.body = pp.parse_scope( );
+                if( !pp.failed( ) && !pp.is_peek( token_type::END_OF_FILE ) ) {
+                    pp.error_unexpect( );
+                }
+                lazy.errors = pp.errors( );
+                lazy.done   = true;
+            }
+            return lazy.errors.empty( );
+        }
+
+        void set_lazy_bodies( bool val )
+        {
+            lazy_bodies_ = val;
+        }
+
+        bool lazy_bodies( ) const
+        {
+            return lazy_bodies_;
+        }
+
     private:
 
         lexer           lexer_;
-        token_iterator  cur_;
-        token_iterator  peek_;
-        nuds_map        nuds_;
-        leds_map        leds_;
-        special_map     special_;
+        token_source    source_;
+        token_iterator  next_;
+        token_info      cur_;
+        token_info      peek_;
+        special_token   special_[rule_count];
+        bool            lazy_bodies_ = false;
 
         errors_list     errors_;
     };
@@ -0,0 +1,238 @@
+#ifndef MICO_PERF_COUNTERS_H
+#define MICO_PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <ostream>
+#include <iomanip>
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define MICO_PERF_EVENTS 1
+#else
+#define MICO_PERF_EVENTS 0
+#endif
+
+namespace mico { namespace perf {
+
+    enum class event {
+        CYCLES        = 0,
+        INSTRUCTIONS  = 1,
+        BRANCH_MISSES = 2,
+        L1D_MISSES    = 3,
+        LLC_MISSES    = 4,
+        LAST          = 5,
+    };
+
+    struct name {
+        static
+        const char *get( event e )
+        {
+            switch( e ) {
+            case event::CYCLES        : return "cycles";
+            case event::INSTRUCTIONS  : return "instructions";
+            case event::BRANCH_MISSES : return "branch_misses";
+            case event::L1D_MISSES    : return "l1d_misses";
+            case event::LLC_MISSES    : return "llc_misses";
+            case event::LAST          : break;
+            }
+            return "<invalid>";
+        }
+    };
+
+    struct sample {
+
+        static const std::size_t count = static_cast<std::size_t>(event::LAST);
+
+        double          wall_ns = 0;
+        bool            valid[count]  = { };
+        std::uint64_t   values[count] = { };
+
+        bool has( event e ) const
+        {
+            return valid[static_cast<std::size_t>(e)];
+        }
+
+        std::uint64_t get( event e ) const
+        {
+            return values[static_cast<std::size_t>(e)];
+        }
+
+        bool has_hw( ) const
+        {
+            for( std::size_t i = 0; i < count; ++i ) {
+                if( valid[i] ) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    /// Hardware counters for the current thread.
+    /// Every event is opened separately; the ones the kernel (or container)
+    /// refuses just stay invalid and the sample falls back to wall time.
+    class counters {
+
+        using clock_type = std::chrono::steady_clock;
+        static const std::size_t count = sample::count;
+
+    public:
+
+        counters( )
+        {
+            for( std::size_t i = 0; i < count; ++i ) {
+                fds_[i] = open_event( static_cast<event>(i) );
+            }
+        }
+
+        ~counters( )
+        {
+#if MICO_PERF_EVENTS
+            for( auto fd: fds_ ) {
+                if( fd >= 0 ) {
+                    ::close( fd );
+                }
+            }
+#endif
+        }
+
+        counters( const counters & ) = delete;
+        counters &operator = ( const counters & ) = delete;
+
+        bool available( ) const
+        {
+            for( auto fd: fds_ ) {
+                if( fd >= 0 ) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void start( )
+        {
+#if MICO_PERF_EVENTS
+            for( auto fd: fds_ ) {
+                if( fd >= 0 ) {
+                    ::ioctl( fd, PERF_EVENT_IOC_RESET, 0 );
+                    ::ioctl( fd, PERF_EVENT_IOC_ENABLE, 0 );
+                }
+            }
+#endif
+            start_ = clock_type::now( );
+        }
+
+        sample stop( )
+        {
+            auto stop = clock_type::now( );
+            sample res;
+#if MICO_PERF_EVENTS
+            for( std::size_t i = 0; i < count; ++i ) {
+                if( fds_[i] >= 0 ) {
+                    ::ioctl( fds_[i], PERF_EVENT_IOC_DISABLE, 0 );
+                    std::uint64_t val = 0;
+                    if( ::read( fds_[i], &val, sizeof(val) ) ==
+                                        static_cast<ssize_t>(sizeof(val)) ) {
+                        res.valid[i]  = true;
+                        res.values[i] = val;
+                    }
+                }
+            }
+#endif
+            std::chrono::duration<double, std::nano> d = stop - start_;
+            res.wall_ns = d.count( );
+            return res;
+        }
+
+        static
+        std::ostream &print( std::ostream &o, const sample &s )
+        {
+            o << std::left << std::setw( 16 ) << "wall_ms"
+              << std::fixed << std::setprecision( 3 )
+              << s.wall_ns / 1e6 << "\n";
+            if( !s.has_hw( ) ) {
+                o << "hardware counters are not available\n";
+                return o;
+            }
+            for( std::size_t i = 0; i < count; ++i ) {
+                auto e = static_cast<event>(i);
+                o << std::left << std::setw( 16 ) << name::get( e );
+                if( s.has( e ) ) {
+                    o << s.get( e ) << "\n";
+                } else {
+                    o << "n/a\n";
+                }
+            }
+            if( s.has( event::CYCLES ) && s.has( event::INSTRUCTIONS ) &&
+                s.get( event::CYCLES ) ) {
+                auto ipc = static_cast<double>(s.get( event::INSTRUCTIONS )) /
+                           static_cast<double>(s.get( event::CYCLES ));
+                o << std::left << std::setw( 16 ) << "ipc"
+                  << std::setprecision( 2 ) << ipc << "\n";
+            }
+            return o;
+        }
+
+    private:
+
+        static
+        int open_event( event e )
+        {
+#if MICO_PERF_EVENTS
+            perf_event_attr attr;
+            std::memset( &attr, 0, sizeof(attr) );
+            attr.size           = sizeof(attr);
+            attr.disabled       = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+
+            static const std::uint64_t read_miss =
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+            switch( e ) {
+            case event::CYCLES:
+                attr.type   = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case event::INSTRUCTIONS:
+                attr.type   = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case event::BRANCH_MISSES:
+                attr.type   = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case event::L1D_MISSES:
+                attr.type   = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | read_miss;
+                break;
+            case event::LLC_MISSES:
+                attr.type   = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_LL | read_miss;
+                break;
+            case event::LAST:
+                return -1;
+            }
+            auto fd = ::syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 );
+            return static_cast<int>(fd);
+#else
+            (void)e;
+            return -1;
+#endif
+        }
+
+        int                     fds_[count];
+        clock_type::time_point  start_;
+    };
+
+}}
+
+#undef MICO_PERF_EVENTS
+
+#endif // COUNTERS_H
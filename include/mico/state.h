@@ -1,6 +1,7 @@
 #ifndef MICO_STATE_H
 #define MICO_STATE_H
 
+#include <map>
 #include <memory>
 #include "mico/objects/base.h"
 #include "mico/environment.h"
@@ -28,6 +29,11 @@ namespace mico {
             return id;
         }
 
+        void del_registry_value( std::uintptr_t id )
+        {
+            registry_.erase( id );
+        }
+
         objects::sptr get_registry_value( std::uintptr_t id )
         {
             auto f = registry_.find( id );
@@ -64,10 +70,17 @@ namespace mico {
             where->run_GC( gc_deep_ );
         }
 
+        /// `[]` and `{}` are immutable; the evaluator keeps one of each here
+        objects::sptr &shared_empty( objects::type t )
+        {
+            return empty_[t];
+        }
+
     private:
         bool              gc_deep_ = true;
         environment::sptr env_;
         registry_type     registry_;
+        std::map<objects::type, objects::sptr> empty_;
 
 #if !defined(DISABLE_MACRO) || !DISABLE_MACRO
         macro_scope       macro_;
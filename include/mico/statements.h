@@ -232,6 +232,11 @@ namespace mico { namespace ast { namespace statements {
             return expr_;
         }
 
+        const expression::uptr &value( ) const
+        {
+            return expr_;
+        }
+
         static
         uptr make( expression::uptr val )
         {
@@ -0,0 +1,135 @@
+#ifndef MICO_SYMBOLS_H
+#define MICO_SYMBOLS_H
+
+#include <cstdint>
+#include <string>
+#include <deque>
+#include <ostream>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+
+namespace mico {
+
+    /// Interned name. Every spelling gets one id and one stored string,
+    /// so comparing two symbols is comparing two integers.
+    /// Ids are never reused; the empty name is always 0.
+    /// The table is one for the process and is shared by all the states,
+    /// so an id means the same name in any of them; it is guarded by
+    /// a mutex. Names are never removed: the table grows with the number
+    /// of different spellings, not with the size of the scripts
+    class symbol {
+
+    public:
+
+        using id_type = std::uint32_t;
+
+        class table {
+
+        public:
+
+            static
+            table &instance( )
+            {
+                static table inst;
+                return inst;
+            }
+
+            id_type get( const std::string &name )
+            {
+                std::lock_guard<std::mutex> lck(lock_);
+                auto f = ids_.find( name );
+                if( f != ids_.end( ) ) {
+                    return f->second;
+                }
+                auto id = static_cast<id_type>(names_.size( ));
+                names_.push_back( name );
+                ids_.emplace( name, id );
+                return id;
+            }
+
+            /// elements of the deque do not move, so the reference
+            /// stays valid after the lock is released
+            const std::string &name( id_type id ) const
+            {
+                std::lock_guard<std::mutex> lck(lock_);
+                return names_[id];
+            }
+
+            std::size_t size( ) const
+            {
+                std::lock_guard<std::mutex> lck(lock_);
+                return names_.size( );
+            }
+
+        private:
+
+            table( )
+            {
+                get( std::string( ) );
+            }
+
+            std::unordered_map<std::string, id_type>    ids_;
+            std::deque<std::string>                     names_;
+            mutable std::mutex                          lock_;
+        };
+
+        symbol( ) = default;
+
+        symbol( const std::string &name )
+            :id_(table::instance( ).get( name ))
+        { }
+
+        symbol( const char *name )
+            :id_(table::instance( ).get( name ))
+        { }
+
+        id_type id( ) const
+        {
+            return id_;
+        }
+
+        const std::string &name( ) const
+        {
+            return table::instance( ).name( id_ );
+        }
+
+        bool empty( ) const
+        {
+            return id_ == 0;
+        }
+
+        bool operator == ( const symbol &other ) const
+        {
+            return id_ == other.id_;
+        }
+
+        bool operator != ( const symbol &other ) const
+        {
+            return id_ != other.id_;
+        }
+
+        bool operator < ( const symbol &other ) const
+        {
+            return id_ < other.id_;
+        }
+
+        struct hash {
+            std::size_t operator ( )( const symbol &s ) const
+            {
+                return std::hash<id_type>( )( s.id_ );
+            }
+        };
+
+    private:
+        id_type id_ = 0;
+    };
+
+    inline
+    std::ostream &operator << ( std::ostream &o, const symbol &s )
+    {
+        return o << s.name( );
+    }
+}
+
+#endif // SYMBOLS_H
@@ -6,6 +6,8 @@
 #include <string>
 #include <ostream>
 
+#include "mico/symbols.h"
+
 namespace mico { namespace tokens {
 
     enum class type {
@@ -226,17 +228,20 @@ namespace mico { namespace tokens {
         type_ident( type_ident &&other )
             :name(other.name)
             ,literal(std::move(other.literal))
+            ,sym(other.sym)
         { }
 
         type_ident& operator = ( type_ident &&other )
         {
             name     = other.name;
             literal = std::move(other.literal);
+            sym      = other.sym;
             return *this;
         }
 
         type        name;
         value_type  literal;
+        symbol      sym;    /// IDENT only
     };
 
     struct position {
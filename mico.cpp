@@ -9,8 +9,12 @@
 #include "mico/eval/tree_walking.h"
 #include "mico/repl.h"
 #include "mico/charset/encoding.h"
+#include "mico/perf/counters.h"
+#include "mico/mapped_file.h"
+#include "mico/ast/cache.h"
 
 #include <stdio.h>
+#include <cstdlib>
 #include <thread>
 
 #include "etool/details/result.h"
@@ -24,26 +28,23 @@ int run_repl( )
 
 using namespace mico;
 
-int run_file( std::string path )
+/// `strict` parses every function body up front, so all syntax errors
+/// are reported before the run; otherwise bodies are parsed on the first call.
+/// `use_cache` reads and writes the expanded program in `path`c
+int run_file( std::string path, bool show_counters = false,
+              bool strict = false, bool use_cache = true )
 {
-    std::ifstream f(path, std::ifstream::binary);
-    if( !f.is_open( ) ) {
+    mico::mapped_file data(path);
+    if( !data.is_open( ) ) {
         std::cerr << "Unable to open file " << path << "\n";
         return 1;
     }
 
-    f.seekg( 0, f.end );
-    auto size = f.tellg( );
-    f.seekg( 0, f.beg );
-
-    if( !size ) {
+    if( !data.size( ) ) {
         std::cerr << "file is empty " << path << "\n";
         return 2;
     }
 
-    mico::file_string data( size, '\0' );
-    f.read( &data[0], size );
-
     eval::tree_walking tv;
     mico::state st;
 
@@ -52,16 +53,39 @@ int run_file( std::string path )
     };
 
     all::init( st, ev );
-    auto prog = parser::parse( data );
 
-    if( prog.errors( ).empty( ) ) {
-        macro::processor::process( &st.macros( ), &prog,
-                                   prog.errors( ), ev );
+    ast::program prog;
+    auto cache_path = ast::cache::path_for( path );
+
+    /// a cache written by a lazy run has bodies nobody checked yet
+    if( strict || !use_cache
+     || !ast::cache::load( cache_path, &prog, data.begin( ), data.end( ) ) ) {
+
+        prog = parser::parse( data.begin( ), data.end( ), !strict );
+
+        if( prog.errors( ).empty( ) ) {
+            macro::processor::process( &st.macros( ), &prog,
+                                       prog.errors( ), ev );
+        }
+
+        if( use_cache && prog.errors( ).empty( ) ) {
+            ast::cache::save( cache_path, prog, data.begin( ), data.end( ) );
+        }
     }
 
     if( prog.errors( ).empty( ) ) {
 
+        std::unique_ptr<perf::counters> cnt;
+        if( show_counters ) {
+            cnt.reset( new perf::counters );
+            cnt->start( );
+        }
         auto obj = tv.eval( &prog, st.env( ) );
+        if( cnt ) {
+            perf::counters::print( std::cerr, cnt->stop( ) );
+            objects::pool::print( std::cerr,
+                                  objects::pool::local( ).statistics( ) );
+        }
 
         if( obj->get_type( ) == objects::type::INTEGER ) {
             auto res = objects::cast_int( obj );
@@ -84,8 +108,25 @@ int main_lex( );
 int main( int argc, char * argv[ ]  )
 {
     try {
-        if( argc > 1 ) {
-            return run_file( argv[1] );
+        bool counters = false;
+        bool strict   = false;
+        bool cache    = !std::getenv( "MICO_NO_CACHE" )
+                      && ast::cache::enabled( );
+        int  id       = 1;
+        for( ; id < argc; ++id ) {
+            std::string opt(argv[id]);
+            if( opt == "--counters" ) {
+                counters = true;
+            } else if( opt == "--strict" ) {
+                strict = true;
+            } else if( opt == "--no-cache" ) {
+                cache = false;
+            } else {
+                break;
+            }
+        }
+        if( id < argc ) {
+            return run_file( argv[id], counters, strict, cache );
         } else {
             mico::charset::encoding::init_console( );
             return run_repl( );
@@ -46,6 +46,7 @@ HEADERS += \
     etool/include/etool/trees/trie/nodes/array.h \
     etool/include/etool/trees/trie/nodes/map.h \
     etool/include/etool/trees/trie/base.h \
+    include/mico/ast/cache.h \
     include/mico/builtin/common.h \
     include/mico/eval/operations/arrays.h \
     include/mico/eval/operations/boolean.h \
@@ -53,6 +54,7 @@ HEADERS += \
     include/mico/eval/operations/float.h \
     include/mico/eval/operations/function.h \
     include/mico/eval/operations/integer.h \
+    include/mico/eval/operations/matrix.h \
     include/mico/eval/operations/module.h \
     include/mico/eval/operations/string.h \
     include/mico/eval/operations/tables.h \
@@ -90,14 +92,23 @@ HEADERS += \
     include/mico/objects/error.h \
     include/mico/objects/functions.h \
     include/mico/objects/generator.h \
+    include/mico/objects/hamt.h \
+    include/mico/objects/hash.h \
+    include/mico/objects/hybrid.h \
     include/mico/objects/interval.h \
+    include/mico/objects/matrix.h \
     include/mico/objects/module.h \
     include/mico/objects/null.h \
     include/mico/objects/numbers.h \
+    include/mico/objects/packed.h \
+    include/mico/objects/pool.h \
+    include/mico/objects/pvector.h \
     include/mico/objects/quote.h \
     include/mico/objects/reference.h \
     include/mico/objects/return.h \
+    include/mico/objects/shape.h \
     include/mico/objects/string.h \
+    include/mico/objects/swiss.h \
     include/mico/objects/table.h \
     include/mico/ast.h \
     include/mico/builtin.h \
@@ -105,6 +116,7 @@ HEADERS += \
     include/mico/expressions.h \
     include/mico/idents.h \
     include/mico/lexer.h \
+    include/mico/mapped_file.h \
     include/mico/numeric.h \
     include/mico/objects.h \
     include/mico/operations.h \
@@ -112,6 +124,7 @@ HEADERS += \
     include/mico/repl.h \
     include/mico/state.h \
     include/mico/statements.h \
+    include/mico/symbols.h \
     include/mico/tokens.h \
     include/mico/expressions/interval.h \
     include/mico/expressions/forin.h \
@@ -119,6 +132,7 @@ HEADERS += \
     include/mico/objects/continue.h \
     include/mico/eval/operations/interval.h \
     include/mico/charset/encoding.h \
+    include/mico/charset/scan.h \
     include/mico/types.h \
     include/mico/expressions/character.h \
     include/mico/objects/character.h \
@@ -133,4 +147,12 @@ HEADERS += \
     include/mico/eval/operations/rstring.h \
     include/mico/eval/operations/character.h \
     include/mico/modules/gc.h \
-    include/mico/objects/type.h
+    include/mico/objects/type.h \
+    include/mico/perf/counters.h \
+    include/mico/builtin/caller.h \
+    include/mico/modules/time.h \
+    include/mico/modules/vec.h \
+    include/mico/modules/vec/kernels.h \
+    include/mico/modules/matrix.h \
+    include/mico/modules/array.h \
+    include/mico/modules/array/sort.h